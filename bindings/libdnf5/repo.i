@@ -34,6 +34,7 @@
     #include "libdnf5/repo/download_callbacks.hpp"
     #include "libdnf5/repo/file_downloader.hpp"
     #include "libdnf5/repo/package_downloader.hpp"
+    #include "libdnf5/repo/package_store.hpp"
     #include "libdnf5/repo/repo.hpp"
     #include "libdnf5/repo/repo_cache.hpp"
     #include "libdnf5/repo/repo_callbacks.hpp"
@@ -60,6 +61,8 @@ wrap_unique_ptr(DownloadCallbacksUniquePtr, libdnf5::repo::DownloadCallbacks);
 %ignore RepoCacheError;
 %include "libdnf5/repo/repo_cache.hpp"
 
+%include "libdnf5/repo/package_store.hpp"
+
 %include "libdnf5/repo/repo.hpp"
 
 %include "libdnf5/repo/repo_weak.hpp"
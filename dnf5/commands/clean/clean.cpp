@@ -21,6 +21,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "clean.hpp"
 
 #include <libdnf5-cli/argument_parser.hpp>
+#include <libdnf5/repo/package_store.hpp>
 #include <libdnf5/repo/repo_cache.hpp>
 #include <libdnf5/utils/bgettext/bgettext-lib.h>
 #include <libdnf5/utils/bgettext/bgettext-mark-domain.h>
@@ -167,6 +168,12 @@ void CleanCommand::run() {
         throw std::runtime_error(fmt::format("Cannot iterate the cache directory: \"{}\"", cachedir.string()));
     }
 
+    // the shared package store is not a part of the repositories cache
+    libdnf5::repo::PackageStore package_store(ctx.base);
+    if (package_store.is_enabled() && (required_actions & (CLEAN_ALL | CLEAN_PACKAGES))) {
+        statistics += package_store.remove_packages();
+    }
+
     std::cout << fmt::format(
                      "Removed {} files, {} directories. {} errors occurred.",
                      statistics.files_removed,
@@ -42,6 +42,18 @@ public:
 };
 
 
+class HistoryContainsPkgsOption : public libdnf5::cli::session::AppendStringListOption {
+public:
+    explicit HistoryContainsPkgsOption(libdnf5::cli::session::Command & command)
+        : AppendStringListOption(
+              command,
+              "contains-pkgs",
+              '\0',
+              _("Show only transactions containing packages with specified names. List option."),
+              "PACKAGE_NAME,...") {}
+};
+
+
 }  // namespace dnf5
 
 
@@ -34,6 +34,7 @@ void HistoryInfoCommand::set_argument_parser() {
 
     transaction_specs = std::make_unique<TransactionSpecArguments>(*this);
     reverse = std::make_unique<ReverseOption>(*this);
+    contains_pkgs = std::make_unique<HistoryContainsPkgsOption>(*this);
 }
 
 void HistoryInfoCommand::run() {
@@ -41,10 +42,12 @@ void HistoryInfoCommand::run() {
     auto & history = *get_context().base.get_transaction_history();
     std::vector<libdnf5::transaction::Transaction> transactions;
 
-    if (ts_specs.empty()) {
+    auto package_names = contains_pkgs->get_value();
+
+    if (ts_specs.empty() && package_names.empty()) {
         transactions = list_transactions_from_specs(history, {"last"});
     } else {
-        transactions = list_transactions_from_specs(history, ts_specs);
+        transactions = list_transactions_from_specs(history, ts_specs, package_names);
     }
 
     if (reverse->get_value()) {
@@ -35,6 +35,7 @@ void HistoryListCommand::set_argument_parser() {
 
     transaction_specs = std::make_unique<TransactionSpecArguments>(*this);
     reverse = std::make_unique<ReverseOption>(*this);
+    contains_pkgs = std::make_unique<HistoryContainsPkgsOption>(*this);
 }
 
 void HistoryListCommand::run() {
@@ -43,15 +44,19 @@ void HistoryListCommand::run() {
     std::vector<libdnf5::transaction::Transaction> transactions;
 
     if (ts_specs.empty()) {
-        transactions = history.list_all_transactions();
+        // filtering and ordering are done by the history database
+        libdnf5::transaction::TransactionListFilter filter;
+        filter.set_package_names(contains_pkgs->get_value());
+        filter.set_descending(reverse->get_value());
+        transactions = history.list_transactions(filter);
     } else {
-        transactions = list_transactions_from_specs(history, transaction_specs->get_value());
-    }
+        transactions = list_transactions_from_specs(history, ts_specs, contains_pkgs->get_value());
 
-    if (reverse->get_value()) {
-        std::sort(transactions.begin(), transactions.end(), std::greater{});
-    } else {
-        std::sort(transactions.begin(), transactions.end());
+        if (reverse->get_value()) {
+            std::sort(transactions.begin(), transactions.end(), std::greater{});
+        } else {
+            std::sort(transactions.begin(), transactions.end());
+        }
     }
 
     libdnf5::cli::output::print_transaction_list(transactions);
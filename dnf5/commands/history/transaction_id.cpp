@@ -23,6 +23,9 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <libdnf5/utils/bgettext/bgettext-mark-domain.h>
 
+#include <algorithm>
+#include <unordered_set>
+
 
 namespace dnf5 {
 
@@ -136,4 +139,35 @@ std::vector<libdnf5::transaction::Transaction> list_transactions_from_specs(
     return result;
 }
 
+
+std::vector<libdnf5::transaction::Transaction> list_transactions_from_specs(
+    libdnf5::transaction::TransactionHistory & ts_history,
+    const std::vector<std::string> & specs,
+    const std::vector<std::string> & package_names) {
+    if (package_names.empty()) {
+        return list_transactions_from_specs(ts_history, specs);
+    }
+
+    // the transactions containing the packages are selected by the history database
+    libdnf5::transaction::TransactionListFilter filter;
+    filter.set_package_names(package_names);
+    auto result = ts_history.list_transactions(filter);
+    if (specs.empty()) {
+        return result;
+    }
+
+    std::unordered_set<int64_t> spec_ids;
+    for (const auto & trans : list_transactions_from_specs(ts_history, specs)) {
+        spec_ids.insert(trans.get_id());
+    }
+    result.erase(
+        std::remove_if(
+            result.begin(),
+            result.end(),
+            [&spec_ids](const auto & trans) { return !spec_ids.contains(trans.get_id()); }),
+        result.end());
+
+    return result;
+}
+
 }  // namespace dnf5
@@ -27,6 +27,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 
 namespace dnf5 {
@@ -45,6 +46,14 @@ std::vector<libdnf5::transaction::Transaction> list_transactions_from_specs(
     libdnf5::transaction::TransactionHistory & ts_history, const std::vector<std::string> & specs);
 
 
+/// Lists transactions matching the `specs` and containing a package with one of the `package_names`.
+/// Empty `specs` match all transactions, empty `package_names` do not filter the transactions.
+std::vector<libdnf5::transaction::Transaction> list_transactions_from_specs(
+    libdnf5::transaction::TransactionHistory & ts_history,
+    const std::vector<std::string> & specs,
+    const std::vector<std::string> & package_names);
+
+
 }  // namespace dnf5
 
 
@@ -214,6 +214,22 @@ public:
     const OptionBool & get_protect_running_kernel_option() const;
     OptionBool & get_build_cache_option();
     const OptionBool & get_build_cache_option() const;
+    OptionNumber<std::uint32_t> & get_max_parallel_metadata_downloads_option();
+    const OptionNumber<std::uint32_t> & get_max_parallel_metadata_downloads_option() const;
+    OptionBool & get_lazy_filelists_option();
+    const OptionBool & get_lazy_filelists_option() const;
+    OptionBool & get_mirror_scoreboard_option();
+    const OptionBool & get_mirror_scoreboard_option() const;
+    OptionNumber<std::uint32_t> & get_max_downloads_per_mirror_option();
+    const OptionNumber<std::uint32_t> & get_max_downloads_per_mirror_option() const;
+    OptionPath & get_package_store_dir_option();
+    const OptionPath & get_package_store_dir_option() const;
+    OptionNumber<std::uint64_t> & get_package_store_max_size_option();
+    const OptionNumber<std::uint64_t> & get_package_store_max_size_option() const;
+    OptionBool & get_rpm_test_transaction_option();
+    const OptionBool & get_rpm_test_transaction_option() const;
+    OptionPath & get_transaction_timeline_file_option();
+    const OptionPath & get_transaction_timeline_file_option() const;
 
     // Repo main config
     OptionNumber<std::uint32_t> & get_retries_option();
@@ -23,9 +23,18 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "libdnf5/conf/config_main.hpp"
 #include "libdnf5/rpm/package.hpp"
 
+#include <functional>
 #include <memory>
 #include <optional>
 
+
+namespace libdnf5::base {
+
+class Transaction;
+
+}
+
+
 namespace libdnf5::repo {
 
 class PackageDownloadError : public Error {
@@ -75,6 +84,12 @@ public:
     void force_keep_packages(bool value);
 
 private:
+    friend class libdnf5::base::Transaction;
+
+    /// Sets a function called for each package as soon as it is downloaded and its checksum verified,
+    /// or found already present, while the other packages are still being downloaded.
+    void set_package_downloaded_callback(std::function<void(const libdnf5::rpm::Package &)> && callback);
+
     class Impl;
     std::unique_ptr<Impl> p_impl;
 };
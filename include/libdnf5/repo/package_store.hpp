@@ -0,0 +1,83 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBDNF5_REPO_PACKAGE_STORE_HPP
+#define LIBDNF5_REPO_PACKAGE_STORE_HPP
+
+#include "repo_cache.hpp"
+
+#include "libdnf5/base/base_weak.hpp"
+#include "libdnf5/rpm/package.hpp"
+
+#include <filesystem>
+#include <memory>
+
+
+namespace libdnf5::repo {
+
+/// Content-addressed store of downloaded packages shared by all repositories and installroots.
+/// The packages are stored in the `package_store_dir` directory under their checksums and linked into
+/// the package directories of the repository caches, using a hardlink, a reflink or a copy, whatever
+/// the filesystems allow. The stored packages are verified using their checksums. The total size of the store
+/// is limited by the `package_store_max_size` option, the least recently used packages are evicted first.
+/// Evicting a package does not remove the package from the repository caches.
+class PackageStore {
+public:
+    explicit PackageStore(const libdnf5::BaseWeakPtr & base);
+    explicit PackageStore(libdnf5::Base & base);
+    ~PackageStore();
+
+    /// @return True if the `package_store_dir` option is set.
+    bool is_enabled() const;
+
+    /// @return True if the store contains the `package` and its checksum matches.
+    bool contains(const libdnf5::rpm::Package & package) const;
+
+    /// Links the stored `package` to the `destination` path and marks it as recently used.
+    /// An existing `destination` that shares its data with other files and is not the stored package
+    /// is removed, so that rewriting it does not modify the other files.
+    ///
+    /// @return True if the `destination` is linked to the stored package, false if the package is not
+    ///         in the store, the existing `destination` was kept or linking failed.
+    bool link_to(const libdnf5::rpm::Package & package, const std::filesystem::path & destination) const;
+
+    /// Adds the `package` file at `path` to the store if its checksum matches. Nothing is done if the store
+    /// already contains the package.
+    ///
+    /// @return True if the package was added to the store.
+    bool add(const libdnf5::rpm::Package & package, const std::filesystem::path & path) const;
+
+    /// Evicts the least recently used packages until the size of the store fits `package_store_max_size`.
+    ///
+    /// @return Number of deleted files and directories. Number of errors.
+    RepoCacheRemoveStatistics evict() const;
+
+    /// Removes all packages from the store.
+    ///
+    /// @return Number of deleted files and directories. Number of errors.
+    RepoCacheRemoveStatistics remove_packages() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> p_impl;
+};
+
+}  // namespace libdnf5::repo
+
+#endif  // LIBDNF5_REPO_PACKAGE_STORE_HPP
@@ -367,9 +367,18 @@ private:
 
     void make_solv_repo();
 
+    /// Adds the RPM packages at `paths` to the repository, see `add_rpm_package()`. The checksums of the files
+    /// are computed in parallel, the packages are added to the pool in the order of `paths`.
+    /// @throws RepoRpmError for the first path in the order that can't be read, the packages before it are added.
+    /// @return Packages added for the paths in the order of `paths`.
+    std::vector<libdnf5::rpm::Package> add_rpm_packages(const std::vector<std::string> & paths, bool with_hdrid);
+
     void load_available_repo();
     void load_system_repo();
 
+    /// Loads the filelists metadata if their loading was deferred because of the `lazy_filelists` option.
+    void load_filelists();
+
     void internalize();
 
     /// If the repository is not already marked as expired, it checks for the presence of the repository cache
@@ -387,6 +396,7 @@ private:
     std::string repo_file_path;
     SyncStrategy sync_strategy{SyncStrategy::TRY_CACHE};
     bool expired{false};
+    bool filelists_load_deferred{false};
 
     std::unique_ptr<RepoDownloader> downloader;
     std::unique_ptr<SolvRepo> solv_repo;
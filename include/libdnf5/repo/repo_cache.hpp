@@ -56,6 +56,12 @@ public:
     /// The name of the attribute used to mark the cache as expired.
     static constexpr const char * ATTRIBUTE_EXPIRED = "expired";
 
+    /// The name of the attribute with the ETag of the cached repomd.xml, used for its conditional revalidation.
+    static constexpr const char * ATTRIBUTE_REPOMD_ETAG = "repomd_etag";
+
+    /// The name of the attribute with the Last-Modified time of the cached repomd.xml.
+    static constexpr const char * ATTRIBUTE_REPOMD_LAST_MODIFIED = "repomd_last_modified";
+
     /// Construct a new repository cache management instance.
     ///
     /// @param base            WeakPtr on the Base instance.
@@ -68,7 +74,7 @@ public:
     /// @param repo_cache_dir  Path to repository cache directory.
     RepoCache(libdnf5::Base & base, const std::string & repo_cache_dir);
 
-    /// Removes metadata from the cache.
+    /// Removes metadata from the cache, including the attributes describing the cached repomd.xml.
     ///
     /// @return Number of deleted files and directories. Number of errors.
     RemoveStatistics remove_metadata();
@@ -122,7 +122,8 @@ public:
     /// potentially downloads fresh metadata (by calling the
     /// `download_metadata()` method) and then queues them for loading. This
     /// speeds up the process by loading repos into memory while others are being
-    /// downloaded.
+    /// downloaded. Metadata of up to "max_parallel_metadata_downloads" repositories
+    /// are downloaded at the same time.
     ///
     /// @param repos The repositories to update and load
     /// @param import_keys If true, attempts to download and import keys for repositories that failed key validation
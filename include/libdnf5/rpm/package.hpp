@@ -357,7 +357,8 @@ public:
     // ===== CHANGELOGS (other.xml) =====
 
     /// @return List of package changelog entries. If `other` repository metadata are
-    //          not loaded, empty list is returned.
+    //          not loaded, empty list is returned. Changelogs of installed packages
+    //          are read from the rpm database on demand.
     /// @since 5.0
     //
     // @replaces dnf:dnf/package.py:attribute:Package.changelogs
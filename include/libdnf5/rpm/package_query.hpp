@@ -72,6 +72,35 @@ public:
     PackageQuery & operator=(const PackageQuery & src);
     PackageQuery & operator=(PackageQuery && src) noexcept;
 
+    /// Enable or disable deferring of filters. The deferred filters are not run immediately, they are recorded
+    /// and run on the first access to the content of the query (iteration, `size()`, `empty()`, `contains()`,
+    /// set operations, copying or assigning the query to a `PackageSet` or a filter that cannot be deferred).
+    /// The recorded filters are run ordered by their cost: the filters comparing names, architectures
+    /// or repositories first, the filters on dependencies, files and texts that use the dataiterator last,
+    /// so the expensive filters test fewer packages.
+    /// The result is the same as if the filters were run immediately. The arguments of a deferred filter
+    /// (e.g. the comparison type) are checked when the filter is recorded. Running the filters can still fail
+    /// (e.g. loading the filelists), the exception is thrown by the access and the filters stay recorded.
+    /// The noexcept methods of `PackageSet` do not run the filters, access the query before it is read
+    /// through a `PackageSet` reference or moved to a `PackageSet`.
+    /// Filters that depend on the other packages in the query (e.g. `filter_latest_evr()`) are never deferred.
+    /// Deferring is disabled by default, copies of the query inherit the setting.
+    ///
+    /// @param defer  `true` to record the filters, `false` to run new filters immediately.
+    void set_defer_filters(bool defer);
+
+    /// @return `true` if the filters of the query are deferred.
+    bool get_defer_filters() const noexcept;
+
+    /// Same as `PackageSet::empty()`, the deferred filters are run first.
+    bool empty() const;
+
+    /// Same as `PackageSet::size()`, the deferred filters are run first.
+    std::size_t size() const;
+
+    /// Same as `PackageSet::contains()`, the deferred filters are run first.
+    bool contains(const Package & pkg) const;
+
     /// Filter packages by their `name`.
     ///
     /// @param patterns         A vector of strings the filter is matched against.
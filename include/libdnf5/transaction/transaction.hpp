@@ -269,6 +269,10 @@ private:
     // @replaces libdnf:transaction/private/Transaction.hpp:method:Transaction.finish(libdnf::TransactionState state)
     void finish(TransactionState state);
 
+    /// Remove the started transaction from the database.
+    /// Used when the rpm transaction was rejected before any package was processed.
+    void discard();
+
     int64_t id{0};
 
     int64_t dt_begin = 0;
@@ -23,14 +23,73 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "transaction.hpp"
 
 #include "libdnf5/base/base_weak.hpp"
+#include "libdnf5/common/impl_ptr.hpp"
 #include "libdnf5/common/weak_ptr.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 
 namespace libdnf5::transaction {
 
 class TransactionHistory;
 using TransactionHistoryWeakPtr = libdnf5::WeakPtr<TransactionHistory, false>;
 
+
+/// Filters and pagination of the transactions listed by `TransactionHistory::list_transactions()`.
+/// The filters are evaluated by the transaction history database, an empty (or zero) value does not filter.
+/// The listed transactions are ordered by their ids.
+class TransactionListFilter {
+public:
+    TransactionListFilter();
+    ~TransactionListFilter();
+
+    TransactionListFilter(const TransactionListFilter & src);
+    TransactionListFilter(TransactionListFilter && src) noexcept;
+    TransactionListFilter & operator=(const TransactionListFilter & src);
+    TransactionListFilter & operator=(TransactionListFilter && src) noexcept;
+
+    /// List only transactions containing an rpm package with one of the names.
+    void set_package_names(const std::vector<std::string> & package_names);
+    const std::vector<std::string> & get_package_names() const noexcept;
+
+    /// List only transactions started at or after the time (unix timestamp).
+    void set_dt_begin_from(int64_t dt_begin_from) noexcept;
+    int64_t get_dt_begin_from() const noexcept;
+
+    /// List only transactions started at or before the time (unix timestamp).
+    void set_dt_begin_to(int64_t dt_begin_to) noexcept;
+    int64_t get_dt_begin_to() const noexcept;
+
+    /// List only transactions run by one of the users (UIDs).
+    void set_user_ids(const std::vector<uint32_t> & user_ids);
+    const std::vector<uint32_t> & get_user_ids() const noexcept;
+
+    /// List only transactions in one of the states.
+    void set_states(const std::vector<TransactionState> & states);
+    const std::vector<TransactionState> & get_states() const noexcept;
+
+    /// List only transactions following the transaction with the id in the listing order. To get the next
+    /// page of transactions, set it to the id of the last transaction of the previous page.
+    void set_after_id(int64_t after_id) noexcept;
+    int64_t get_after_id() const noexcept;
+
+    /// List the transactions in the descending order of their ids.
+    void set_descending(bool descending) noexcept;
+    bool get_descending() const noexcept;
+
+    /// The maximum number of listed transactions, 0 means unlimited.
+    void set_limit(std::size_t limit) noexcept;
+    std::size_t get_limit() const noexcept;
+
+private:
+    class Impl;
+    ImplPtr<Impl> p_impl;
+};
+
+
 /// A class for working with transactions recorded in the transaction history database.
 class TransactionHistory {
 public:
@@ -64,6 +123,14 @@ public:
     /// @return The listed transactions.
     std::vector<Transaction> list_all_transactions();
 
+    /// Lists transactions from the transaction history matching the `filter`. The filters and the paging
+    /// are applied by the database, only the matching transactions are loaded. Their items are loaded
+    /// lazily on first access.
+    ///
+    /// @param filter The filters and the page of the listed transactions.
+    /// @return The listed transactions ordered by their ids.
+    std::vector<Transaction> list_transactions(const TransactionListFilter & filter);
+
     /// @return The `Base` object to which this object belongs.
     /// @since 5.0
     libdnf5::BaseWeakPtr get_base() const;
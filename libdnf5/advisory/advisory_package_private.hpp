@@ -111,7 +111,8 @@ public:
     /// Check whether this AdvisoryPackage is resolved (meaning there is a counterpart
     /// package with lower or equal EVR and matching name and arch) in pkgs PackageSet.
     ///
-    /// @param pkgs             libdnf5::rpm::PackageSet of packages to check
+    /// @param pkgs             libdnf5::rpm::PackageSet of packages to check, it has to be dense
+    ///                         (e.g. a PackageQuery prepared for filtering)
     ///
     /// @return true or false whether this AdvisoryPackage is resolved in pkgs
     bool is_resolved_in(const libdnf5::rpm::PackageSet & pkgs) const;
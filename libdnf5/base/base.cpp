@@ -52,7 +52,10 @@ Base::Base(std::vector<std::unique_ptr<Logger>> && loggers)
 
 Base::~Base() = default;
 
-Base::Impl::Impl(const libdnf5::BaseWeakPtr & base) : rpm_advisory_sack(base), plugins(*base) {}
+Base::Impl::Impl(const libdnf5::BaseWeakPtr & base)
+    : rpm_advisory_sack(base),
+      plugins(*base),
+      mirror_scoreboard(base) {}
 
 void Base::lock() {
     locked_base_mutex.lock();
@@ -22,6 +22,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "../advisory/advisory_sack.hpp"
+#include "../repo/mirror_scoreboard.hpp"
 #include "plugin/plugins.hpp"
 #include "system/state.hpp"
 
@@ -56,6 +57,8 @@ public:
 
     plugin::Plugins & get_plugins() { return plugins; }
 
+    repo::MirrorScoreboard & get_mirror_scoreboard() { return mirror_scoreboard; }
+
 private:
     friend class Base;
     Impl(const libdnf5::BaseWeakPtr & base);
@@ -77,6 +80,8 @@ private:
     libdnf5::advisory::AdvisorySack rpm_advisory_sack;
 
     plugin::Plugins plugins;
+
+    repo::MirrorScoreboard mirror_scoreboard;
 };
 
 
@@ -86,6 +91,9 @@ public:
     static solv::CompsPool & get_comps_pool(const libdnf5::BaseWeakPtr & base) {
         return base->p_impl->get_comps_pool();
     }
+    static repo::MirrorScoreboard & get_mirror_scoreboard(const libdnf5::BaseWeakPtr & base) {
+        return base->p_impl->get_mirror_scoreboard();
+    }
 };
 
 }  // namespace libdnf5
@@ -394,7 +394,8 @@ void Goal::Impl::add_rpm_ids(GoalAction action, const rpm::PackageSet & package_
     libdnf_assert_same_base(base, package_set.get_base());
 
     libdnf5::solv::IdQueue ids;
-    for (auto package_id : *package_set.p_impl) {
+    rpm::PackageSet::Impl::DenseMapView packages(*package_set.p_impl);
+    for (auto package_id : *packages) {
         ids.push_back(package_id);
     }
     rpm_ids.push_back(std::make_tuple(action, std::move(ids), settings));
@@ -743,6 +744,8 @@ std::pair<GoalProblem, libdnf5::solv::IdQueue> Goal::Impl::add_install_to_goal(
 
         rpm::PackageSet selected(base);
         rpm::PackageSet selected_noarch(base);
+        selected.p_impl->make_dense();
+        selected_noarch.p_impl->make_dense();
         for (auto & name_iter : na_map) {
             if (name_iter.second.size() == 1) {
                 selected.clear();
@@ -846,6 +849,7 @@ std::pair<GoalProblem, libdnf5::solv::IdQueue> Goal::Impl::add_install_to_goal(
             }
             Id current_name = 0;
             rpm::PackageSet selected(base);
+            selected.p_impl->make_dense();
             std::sort(tmp_solvables.begin(), tmp_solvables.end(), nevra_solvable_cmp_key);
             {
                 auto * first = tmp_solvables[0];
@@ -2053,6 +2057,7 @@ void Goal::Impl::autodetect_unsatisfied_installed_weak_dependencies() {
         }
     }
     if (!exclude_supplements.empty()) {
+        exclude_supplements.p_impl->make_dense();
         rpm_goal.add_exclude_from_weak(*exclude_supplements.p_impl);
     }
 }
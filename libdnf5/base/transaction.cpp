@@ -25,11 +25,15 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "module/module_sack_impl.hpp"
 #include "repo/temp_files_memory.hpp"
 #include "rpm/package_set_impl.hpp"
+#include "rpm/rpm_signature_private.hpp"
 #include "solv/pool.hpp"
 #include "solver_problems_internal.hpp"
 #include "transaction_impl.hpp"
+#include "transaction_timeline.hpp"
 #include "utils/locker.hpp"
+#include "utils/on_scope_exit.hpp"
 #include "utils/string.hpp"
+#include "utils/thread_pool.hpp"
 
 #include "libdnf5/base/base.hpp"
 #include "libdnf5/common/exception.hpp"
@@ -44,8 +48,11 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <unistd.h>
 
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <map>
 #include <ranges>
+#include <set>
 #include <string_view>
 #include <thread>
 
@@ -118,7 +125,8 @@ Transaction::Impl::Impl(Transaction & transaction, const Impl & src)
       module_db(src.module_db),
       resolve_logs(src.resolve_logs),
       transaction_problems(src.transaction_problems),
-      signature_problems(src.signature_problems) {}
+      signature_problems(src.signature_problems),
+      signature_verified_packages(src.signature_verified_packages) {}
 
 Transaction::Impl & Transaction::Impl::operator=(const Impl & other) {
     base = other.base;
@@ -133,6 +141,7 @@ Transaction::Impl & Transaction::Impl::operator=(const Impl & other) {
     resolve_logs = other.resolve_logs;
     transaction_problems = other.transaction_problems;
     signature_problems = other.signature_problems;
+    signature_verified_packages = other.signature_verified_packages;
     return *this;
 }
 
@@ -301,13 +310,49 @@ std::string Transaction::transaction_result_to_string(const TransactionRunResult
 
 void Transaction::download() {
     libdnf5::repo::PackageDownloader downloader(p_impl->base);
+    bool signature_checks_required{false};
     for (auto & tspkg : this->get_transaction_packages()) {
         if (transaction_item_action_is_inbound(tspkg.get_action()) &&
             tspkg.get_package().get_repo()->get_type() != libdnf5::repo::Repo::Type::COMMANDLINE) {
             downloader.add(tspkg.get_package());
+            signature_checks_required |=
+                libdnf5::rpm::is_package_signature_check_required(p_impl->base, tspkg.get_package());
         }
     }
+
+    p_impl->signature_verified_packages.clear();
+    if (!signature_checks_required) {
+        downloader.download();
+        return;
+    }
+
+    // Check signatures of the downloaded packages from repositories with gpgcheck enabled by a worker thread
+    // while the remaining packages are still being downloaded. The package paths are resolved in this thread,
+    // the worker does not touch the sack. The checks hold the rpm log guard, so more workers would only wait.
+    std::vector<std::pair<rpm::PackageId, std::future<libdnf5::rpm::RpmSignature::CheckResult>>> signature_checks;
+    libdnf5::utils::ThreadPool signature_checkers(1);
+    downloader.set_package_downloaded_callback([this, &signature_checks, &signature_checkers](
+                                                   const libdnf5::rpm::Package & package) {
+        if (libdnf5::rpm::is_package_signature_check_required(p_impl->base, package)) {
+            signature_checks.emplace_back(
+                package.get_id(),
+                signature_checkers.submit([base = p_impl->base, path = package.get_package_path()]() {
+                    return libdnf5::rpm::check_package_file_signature(base, path);
+                }));
+        }
+    });
     downloader.download();
+
+    // only the passed checks are remembered, failed ones are repeated by check_gpg_signatures() with key import
+    for (auto & [package_id, check] : signature_checks) {
+        try {
+            if (check.get() == libdnf5::rpm::RpmSignature::CheckResult::OK) {
+                p_impl->signature_verified_packages.emplace(package_id);
+            }
+        } catch (const std::exception &) {
+            // the error is reported by the repeated check
+        }
+    }
 }
 
 Transaction::TransactionRunResult Transaction::test() {
@@ -483,7 +528,7 @@ TransactionPackage Transaction::Impl::make_transaction_package(
 }
 
 // Reads the output of scriptlets from the file descriptor and processes them.
-static void process_scriptlets_output(int fd, Logger * logger) {
+static void process_scriptlets_output(int fd, Logger * logger, TransactionTimeline * timeline) {
     try {
         char buf[512];
         do {
@@ -494,6 +539,13 @@ static void process_scriptlets_output(int fd, Logger * logger) {
                 do {
                     auto end = str.find('\n', start);
                     logger->info("[scriptlet] {}", str.substr(start, end - start));
+                    if (timeline) {
+                        timeline->add_instant_event(
+                            "scriptlet output",
+                            "scriptlet",
+                            TransactionTimeline::Track::SCRIPTLET_OUTPUT,
+                            {{"line", std::string(str.substr(start, end - start))}});
+                    }
                     if (end == std::string_view::npos) {
                         break;
                     }
@@ -513,6 +565,22 @@ static void process_scriptlets_output(int fd, Logger * logger) {
     close(fd);
 }
 
+// Removes the temporarily stored packages from the system.
+static void remove_temp_files(const std::string & cachedir, Logger * logger) {
+    libdnf5::repo::TempFilesMemory temp_files_memory(cachedir);
+    auto temp_files = temp_files_memory.get_files();
+    for (auto & file : temp_files) {
+        try {
+            if (!std::filesystem::remove(file)) {
+                logger->debug("Temporary file \"{}\" doesn't exist.", file);
+            }
+        } catch (const std::filesystem::filesystem_error & ex) {
+            logger->debug("An error occurred when trying to remove a temporary file \"{}\": {}", file, ex.what());
+        }
+    }
+    temp_files_memory.clear();
+}
+
 Transaction::TransactionRunResult Transaction::Impl::test() {
     return this->_run(std::make_unique<libdnf5::rpm::TransactionCallbacks>(), "", std::nullopt, "", true);
 }
@@ -541,11 +609,31 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
         return TransactionRunResult::ERROR_RESOLVE;
     }
 
-    if (!check_gpg_signatures()) {
-        return TransactionRunResult::ERROR_GPG_CHECK;
+    auto & config = base->get_config();
+
+    // record the timeline of the run if requested, it is written also if the run fails
+    std::unique_ptr<TransactionTimeline> timeline;
+    if (!test_only && !config.get_transaction_timeline_file_option().empty()) {
+        timeline = std::make_unique<TransactionTimeline>();
     }
+    utils::OnScopeExit write_timeline([&]() noexcept {
+        if (!timeline) {
+            return;
+        }
+        const auto & path = config.get_transaction_timeline_file_option().get_value();
+        try {
+            timeline->write(path);
+        } catch (const std::exception & ex) {
+            base->get_logger()->warning("Cannot write transaction timeline \"{}\": {}", path, ex.what());
+        }
+    });
 
-    auto & config = base->get_config();
+    {
+        TransactionTimeline::Span span(timeline.get(), "check signatures", "transaction");
+        if (!check_gpg_signatures()) {
+            return TransactionRunResult::ERROR_GPG_CHECK;
+        }
+    }
 
     // acquire the lock
     std::filesystem::path lock_file_path = config.get_installroot_option().get_value();
@@ -559,12 +647,18 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
 
     // fill and check the rpm transaction
     libdnf5::rpm::Transaction rpm_transaction(base);
-    rpm_transaction.fill(*transaction);
-    if (!rpm_transaction.check()) {
-        for (auto it : rpm_transaction.get_problems()) {
-            transaction_problems.emplace_back(it.to_string());
+    {
+        TransactionTimeline::Span span(timeline.get(), "fill rpm transaction", "transaction");
+        rpm_transaction.fill(*transaction);
+    }
+    {
+        TransactionTimeline::Span span(timeline.get(), "check rpm transaction", "transaction");
+        if (!rpm_transaction.check()) {
+            for (auto it : rpm_transaction.get_problems()) {
+                transaction_problems.emplace_back(it.to_string());
+            }
+            return TransactionRunResult::ERROR_CHECK;
         }
-        return TransactionRunResult::ERROR_CHECK;
     }
 
     rpmtransFlags rpm_transaction_flags{RPMTRANS_FLAG_NONE};
@@ -589,24 +683,37 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
     }
 
     // Run rpm transaction test
-    rpm_transaction.set_flags(rpm_transaction_flags | RPMTRANS_FLAG_TEST);
-    //TODO(jrohel): Do we want callbacks for transaction test?
-    //rpm_transaction.set_callbacks(std::move(callbacks));
-    auto ret = rpm_transaction.run();
-    if (ret != 0) {
-        for (auto it : rpm_transaction.get_problems()) {
-            transaction_problems.emplace_back(it.to_string());
+    // The test can be skipped for the real run, rpm does the same checks again before processing the packages.
+    const bool test_only_run = test_only || rpm_transaction_flags & RPMTRANS_FLAG_TEST;
+    const bool rpm_test_run = test_only_run || config.get_rpm_test_transaction_option().get_value();
+    int ret = 0;
+    if (rpm_test_run) {
+        TransactionTimeline::Span span(timeline.get(), "rpm test transaction", "rpm");
+        rpm_transaction.set_flags(rpm_transaction_flags | RPMTRANS_FLAG_TEST);
+        //TODO(jrohel): Do we want callbacks for transaction test?
+        //rpm_transaction.set_callbacks(std::move(callbacks));
+        ret = rpm_transaction.run();
+        if (ret != 0) {
+            for (auto it : rpm_transaction.get_problems()) {
+                transaction_problems.emplace_back(it.to_string());
+            }
+            return TransactionRunResult::ERROR_RPM_RUN;
         }
-        return TransactionRunResult::ERROR_RPM_RUN;
     }
 
     // With RPMTRANS_FLAG_TEST return just before anything is stored permanently
-    if (test_only || rpm_transaction_flags & RPMTRANS_FLAG_TEST) {
+    if (test_only_run) {
         return TransactionRunResult::SUCCESS;
     }
 
     auto & plugins = base->p_impl->get_plugins();
-    plugins.pre_transaction(*transaction);
+    {
+        TransactionTimeline::Span span(timeline.get(), "pre_transaction plugin hooks", "plugins");
+        plugins.pre_transaction(*transaction);
+    }
+
+    std::optional<TransactionTimeline::Span> history_start_span;
+    history_start_span.emplace(timeline.get(), "start history transaction", "history");
 
     // start history db transaction
     auto db_transaction = libdnf5::transaction::Transaction(base);
@@ -648,13 +755,23 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
         db_transaction.fill_transaction_environments(environments, installed_group_ids);
     }
 
+    // The installed packages are needed for the group members and to update the system state after the rpm
+    // transaction. The pool is not changed by the rpm transaction, so they are collected in advance by a single
+    // pass over the installed set.
+    std::map<std::pair<std::string, std::string>, std::set<std::string>> installed_na_nevras;
+    {
+        rpm::PackageQuery installed_query(base, rpm::PackageQuery::ExcludeFlags::IGNORE_EXCLUDES);
+        installed_query.filter_installed();
+        for (const auto & pkg : installed_query) {
+            installed_na_nevras[{pkg.get_name(), pkg.get_arch()}].emplace(pkg.get_nevra());
+        }
+    }
+
     if (!groups.empty()) {
         // consider currently installed packages + inbound packages as installed for group members
-        rpm::PackageQuery installed_query(base);
-        installed_query.filter_installed();
         std::set<std::string> installed_names{};
-        for (const auto & pkg : installed_query) {
-            installed_names.emplace(pkg.get_name());
+        for (const auto & [na, nevras] : installed_na_nevras) {
+            installed_names.emplace(na.first);
         }
         for (const auto & tspkg : packages) {
             if (transaction_item_action_is_inbound(tspkg.get_action())) {
@@ -667,11 +784,15 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
     auto time = std::chrono::system_clock::now().time_since_epoch();
     db_transaction.set_dt_start(std::chrono::duration_cast<std::chrono::seconds>(time).count());
     db_transaction.start();
+    history_start_span.reset();
 
 
     auto logger = base->get_logger().get();
 
-    if (!modules.empty()) {
+    // Without the rpm test transaction, the file conflicts and the disk space are checked only by the real run.
+    // The module state is saved together with the system state after the run succeeded then.
+    if (!modules.empty() && rpm_test_run) {
+        TransactionTimeline::Span span(timeline.get(), "save module state", "state");
         module_db->save();
         try {
             base->p_impl->get_system_state().save();
@@ -687,7 +808,8 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
     }
 
     // This thread processes the output of RPM scriptlets.
-    std::thread thread_processes_scriptlets_output(process_scriptlets_output, pipe_out_from_scriptlets[0], logger);
+    std::thread thread_processes_scriptlets_output(
+        process_scriptlets_output, pipe_out_from_scriptlets[0], logger, timeline.get());
 
     // Set file descriptor for output of scriptlets in transaction.
     rpm_transaction.set_script_out_fd(pipe_out_from_scriptlets[1]);
@@ -697,8 +819,12 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
     rpm_transaction.set_callbacks(std::move(callbacks));
     rpm_transaction.set_flags(rpm_transaction_flags);
 
-    // execute rpm transaction
-    ret = rpm_transaction.run();
+    // execute rpm transaction, only the packages and scriptlets of the real run are recorded to the timeline
+    rpm_transaction.set_timeline(timeline.get());
+    {
+        TransactionTimeline::Span span(timeline.get(), "rpm transaction", "rpm");
+        ret = rpm_transaction.run();
+    }
 
     // Reset/close file descriptor for output of RPM scriptlets. Required to end thread_processes_scriptlets_output.
     rpm_transaction.set_script_out_fd(-1);
@@ -708,11 +834,11 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
     // TODO(mblaha): Handle ret == -1 and ret > 0, fill problems list
 
     if (ret == 0) {
+        TransactionTimeline::Span span(timeline.get(), "save system state", "state");
+
         // set the new system state
         auto & system_state = base->p_impl->get_system_state();
 
-        rpm::PackageQuery installed_query(base, rpm::PackageQuery::ExcludeFlags::IGNORE_EXCLUDES);
-        installed_query.filter_installed();
         std::set<std::string> inbound_packages_reason_group{};
 
         // Iterate in reverse, inbound actions are first in the vector, we want to process outbound first
@@ -746,13 +872,10 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
                 // (we're keeping the reason) or it's an obsolete (we're removing the reason)
 
                 // We need to filter out packages that are being removed in the transaction
-                // (the installed query still contains the packages before this transaction)
-                installed_query.filter_nevra({pkg.get_nevra()}, libdnf5::sack::QueryCmp::NEQ);
-
-                rpm::PackageQuery query(installed_query);
-                query.filter_name({pkg.get_name()});
-                query.filter_arch({pkg.get_arch()});
-                if (query.empty()) {
+                // (the installed packages are the packages before this transaction)
+                auto & na_nevras = installed_na_nevras[{pkg.get_name(), pkg.get_arch()}];
+                na_nevras.erase(pkg.get_nevra());
+                if (na_nevras.empty()) {
                     system_state.remove_package_na_state(pkg.get_na());
                 }
 
@@ -770,6 +893,14 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
             }
         }
 
+        // names of the packages that remain installed from before this transaction
+        std::set<std::string> installed_names;
+        for (const auto & [na, nevras] : installed_na_nevras) {
+            if (!nevras.empty()) {
+                installed_names.emplace(na.first);
+            }
+        }
+
         // Set correct system state for groups in the transaction
         auto comps_xml_dir = system_state.get_group_xml_dir();
         std::filesystem::create_directories(comps_xml_dir);
@@ -789,9 +920,7 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
                     } else {
                         // also group packages that were installed before this transaction
                         // system state consideres as installed by group
-                        rpm::PackageQuery query(installed_query);
-                        query.filter_name({pkg_name});
-                        if (!query.empty()) {
+                        if (installed_names.contains(pkg_name)) {
                             state.packages.emplace_back(pkg_name);
                         }
                     }
@@ -842,40 +971,49 @@ Transaction::TransactionRunResult Transaction::Impl::_run(
 
         system_state.set_rpmdb_cookie(rpm_transaction.get_db_cookie());
 
+        if (!modules.empty() && !rpm_test_run) {
+            module_db->save();
+        }
+
         system_state.save();
     }
 
-    // finish history db transaction
-    time = std::chrono::system_clock::now().time_since_epoch();
-    db_transaction.set_dt_end(std::chrono::duration_cast<std::chrono::seconds>(time).count());
-    // TODO(jrohel): Also save the rpm db cookie to system state.
-    //               Possibility to detect rpm database change without the need for a history database.
-    db_transaction.set_rpmdb_version_end(rpm_transaction.get_db_cookie());
-    db_transaction.finish(
-        ret == 0 ? libdnf5::transaction::TransactionState::OK : libdnf5::transaction::TransactionState::ERROR);
+    // The rpm problems are reported before any package is processed. Without the rpm test transaction, the run
+    // rejected by them is not recorded to the history, the same as a failed test transaction.
+    std::vector<std::string> rpm_problems;
+    if (ret != 0) {
+        for (auto it : rpm_transaction.get_problems()) {
+            rpm_problems.emplace_back(it.to_string());
+        }
+    }
 
-    plugins.post_transaction(*transaction);
+    if (!rpm_test_run && !rpm_problems.empty()) {
+        TransactionTimeline::Span span(timeline.get(), "discard history transaction", "history");
+        db_transaction.discard();
+    } else {
+        // finish history db transaction
+        TransactionTimeline::Span span(timeline.get(), "finish history transaction", "history");
+        time = std::chrono::system_clock::now().time_since_epoch();
+        db_transaction.set_dt_end(std::chrono::duration_cast<std::chrono::seconds>(time).count());
+        // TODO(jrohel): Also save the rpm db cookie to system state.
+        //               Possibility to detect rpm database change without the need for a history database.
+        db_transaction.set_rpmdb_version_end(rpm_transaction.get_db_cookie());
+        db_transaction.finish(
+            ret == 0 ? libdnf5::transaction::TransactionState::OK : libdnf5::transaction::TransactionState::ERROR);
+    }
+
+    {
+        TransactionTimeline::Span span(timeline.get(), "post_transaction plugin hooks", "plugins");
+        plugins.post_transaction(*transaction);
+    }
 
     if (ret == 0) {
         // removes any temporarily stored packages from the system
-        libdnf5::repo::TempFilesMemory temp_files_memory(config.get_cachedir_option().get_value());
-        auto temp_files = temp_files_memory.get_files();
-        for (auto & file : temp_files) {
-            try {
-                if (!std::filesystem::remove(file)) {
-                    logger->debug("Temporary file \"{}\" doesn't exist.", file);
-                }
-            } catch (const std::filesystem::filesystem_error & ex) {
-                logger->debug("An error occurred when trying to remove a temporary file \"{}\": {}", file, ex.what());
-            }
-        }
-        temp_files_memory.clear();
+        remove_temp_files(config.get_cachedir_option().get_value(), logger);
 
         return TransactionRunResult::SUCCESS;
     } else {
-        for (auto it : rpm_transaction.get_problems()) {
-            transaction_problems.emplace_back(it.to_string());
-        }
+        transaction_problems.insert(transaction_problems.end(), rpm_problems.begin(), rpm_problems.end());
         return TransactionRunResult::ERROR_RPM_RUN;
     }
 }
@@ -962,6 +1100,9 @@ bool Transaction::Impl::check_gpg_signatures() {
     for (const auto & trans_pkg : packages) {
         if (transaction_item_action_is_inbound(trans_pkg.get_action())) {
             auto const & pkg = trans_pkg.get_package();
+            if (signature_verified_packages.contains(pkg.get_id())) {
+                continue;
+            }
             auto repo = pkg.get_repo();
             auto err_msg = utils::sformat(
                 _("PGP check for package \"{}\" ({}) from repo \"{}\" has failed: "),
@@ -34,6 +34,8 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <solv/transaction.h>
 
+#include <set>
+
 
 namespace libdnf5::base {
 
@@ -104,6 +106,9 @@ private:
     std::vector<std::string> transaction_problems{};
     std::vector<std::string> signature_problems{};
 
+    // packages whose signatures passed the check run while the transaction packages were being downloaded
+    std::set<rpm::PackageId> signature_verified_packages{};
+
     // history db transaction id
     int64_t history_db_id = 0;
 
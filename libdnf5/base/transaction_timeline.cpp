@@ -0,0 +1,174 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "transaction_timeline.hpp"
+
+#include "utils/fs/temp.hpp"
+
+#include <json.h>
+
+#include <memory>
+
+
+namespace libdnf5::base {
+
+namespace {
+
+// all events are exported as events of one process, the tracks are its threads
+constexpr int TRACE_PID = 1;
+
+const char * track_to_string(TransactionTimeline::Track track) {
+    switch (track) {
+        case TransactionTimeline::Track::TRANSACTION:
+            return "transaction";
+        case TransactionTimeline::Track::PACKAGES:
+            return "packages";
+        case TransactionTimeline::Track::SCRIPTLETS:
+            return "scriptlets";
+        case TransactionTimeline::Track::SCRIPTLET_OUTPUT:
+            return "scriptlet output";
+    }
+    return "unknown";
+}
+
+json_object * new_event(const char * phase, const std::string & name, TransactionTimeline::Track track) {
+    auto * event = json_object_new_object();
+    json_object_object_add(event, "name", json_object_new_string(name.c_str()));
+    json_object_object_add(event, "ph", json_object_new_string(phase));
+    json_object_object_add(event, "pid", json_object_new_int(TRACE_PID));
+    json_object_object_add(event, "tid", json_object_new_int(static_cast<int>(track)));
+    return event;
+}
+
+std::int64_t to_microseconds(TransactionTimeline::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+}  // namespace
+
+
+TransactionTimeline::Span::Span(TransactionTimeline * timeline, std::string name, std::string category, Track track)
+    : timeline(timeline),
+      name(std::move(name)),
+      category(std::move(category)),
+      track(track),
+      start(timeline ? Clock::now() : Clock::time_point{}) {}
+
+
+TransactionTimeline::Span::~Span() {
+    if (timeline) {
+        timeline->add_event(std::move(name), std::move(category), track, start);
+    }
+}
+
+
+TransactionTimeline::TransactionTimeline() : origin(Clock::now()) {}
+
+
+void TransactionTimeline::add_event(
+    std::string name, std::string category, Track track, Clock::time_point start, Args args) {
+    auto now = Clock::now();
+    std::lock_guard lock(mutex);
+    events.push_back(
+        {std::move(name), std::move(category), track, false, start - origin, now - start, std::move(args)});
+}
+
+
+void TransactionTimeline::add_instant_event(std::string name, std::string category, Track track, Args args) {
+    auto now = Clock::now();
+    std::lock_guard lock(mutex);
+    events.push_back({std::move(name), std::move(category), track, true, now - origin, {}, std::move(args)});
+}
+
+
+void TransactionTimeline::begin(const std::string & key) {
+    auto now = Clock::now();
+    std::lock_guard lock(mutex);
+    open_events.insert_or_assign(key, now);
+}
+
+
+void TransactionTimeline::end(const std::string & key, std::string name, std::string category, Track track, Args args) {
+    Clock::time_point start;
+    {
+        std::lock_guard lock(mutex);
+        auto it = open_events.find(key);
+        if (it == open_events.end()) {
+            return;
+        }
+        start = it->second;
+        open_events.erase(it);
+    }
+    add_event(std::move(name), std::move(category), track, start, std::move(args));
+}
+
+
+void TransactionTimeline::write(const std::filesystem::path & path) const {
+    std::unique_ptr<json_object, decltype(&json_object_put)> root(json_object_new_object(), &json_object_put);
+    auto * trace_events = json_object_new_array();
+    json_object_object_add(root.get(), "traceEvents", trace_events);
+    json_object_object_add(root.get(), "displayTimeUnit", json_object_new_string("ms"));
+
+    // name the process and the tracks
+    auto * process_name = new_event("M", "process_name", Track::TRANSACTION);
+    auto * process_args = json_object_new_object();
+    json_object_object_add(process_args, "name", json_object_new_string("libdnf5 transaction"));
+    json_object_object_add(process_name, "args", process_args);
+    json_object_array_add(trace_events, process_name);
+    for (auto track : {Track::TRANSACTION, Track::PACKAGES, Track::SCRIPTLETS, Track::SCRIPTLET_OUTPUT}) {
+        auto * thread_name = new_event("M", "thread_name", track);
+        auto * thread_args = json_object_new_object();
+        json_object_object_add(thread_args, "name", json_object_new_string(track_to_string(track)));
+        json_object_object_add(thread_name, "args", thread_args);
+        json_object_array_add(trace_events, thread_name);
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        for (const auto & event : events) {
+            auto * trace_event = new_event(event.instant ? "i" : "X", event.name, event.track);
+            json_object_object_add(trace_event, "cat", json_object_new_string(event.category.c_str()));
+            json_object_object_add(trace_event, "ts", json_object_new_int64(to_microseconds(event.start)));
+            if (event.instant) {
+                // the scope of the instant event is its thread
+                json_object_object_add(trace_event, "s", json_object_new_string("t"));
+            } else {
+                json_object_object_add(trace_event, "dur", json_object_new_int64(to_microseconds(event.duration)));
+            }
+            if (!event.args.empty()) {
+                auto * args = json_object_new_object();
+                for (const auto & [key, value] : event.args) {
+                    json_object_object_add(args, key.c_str(), json_object_new_string(value.c_str()));
+                }
+                json_object_object_add(trace_event, "args", args);
+            }
+            json_object_array_add(trace_events, trace_event);
+        }
+    }
+
+    std::filesystem::create_directories(path.parent_path());
+    utils::fs::TempFile temp_file(path.parent_path(), path.filename());
+    temp_file.open_as_file("w").write(
+        json_object_to_json_string_ext(root.get(), JSON_C_TO_STRING_PLAIN | JSON_C_TO_STRING_NOSLASHESCAPE));
+    temp_file.close();
+    std::filesystem::rename(temp_file.get_path(), path);
+    temp_file.release();
+}
+
+}  // namespace libdnf5::base
@@ -0,0 +1,99 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBDNF5_BASE_TRANSACTION_TIMELINE_HPP
+#define LIBDNF5_BASE_TRANSACTION_TIMELINE_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace libdnf5::base {
+
+/// Records the timeline of a transaction run and exports it in the Chrome trace event JSON format,
+/// which can be viewed e.g. in chrome://tracing or https://ui.perfetto.dev.
+/// The events can be added from multiple threads.
+class TransactionTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Args = std::map<std::string, std::string>;
+
+    /// Tracks the events are displayed on, each one is exported as a separate thread.
+    enum class Track { TRANSACTION = 1, PACKAGES, SCRIPTLETS, SCRIPTLET_OUTPUT };
+
+    /// Records a span in the timeline while it exists. The span does nothing if the timeline is nullptr.
+    class Span {
+    public:
+        Span(TransactionTimeline * timeline, std::string name, std::string category, Track track = Track::TRANSACTION);
+        ~Span();
+
+        Span(const Span &) = delete;
+        Span & operator=(const Span &) = delete;
+
+    private:
+        TransactionTimeline * timeline;
+        std::string name;
+        std::string category;
+        Track track;
+        Clock::time_point start;
+    };
+
+    TransactionTimeline();
+
+    /// Adds an event spanning from `start` to now.
+    void add_event(std::string name, std::string category, Track track, Clock::time_point start, Args args = {});
+
+    /// Adds an event without duration.
+    void add_instant_event(std::string name, std::string category, Track track, Args args = {});
+
+    /// Marks the start of an event which is added by a later call of `end()` with the same `key`.
+    /// It is used when the start and the end of an event are reported by separate callbacks.
+    void begin(const std::string & key);
+
+    /// Adds the event started by `begin()` with the same `key`, the call is ignored if there is no such event.
+    void end(const std::string & key, std::string name, std::string category, Track track, Args args = {});
+
+    /// Writes the recorded events to the file in the Chrome trace event JSON format.
+    /// @param path  Path to the output file, it is replaced atomically.
+    void write(const std::filesystem::path & path) const;
+
+private:
+    struct Event {
+        std::string name;
+        std::string category;
+        Track track;
+        bool instant;
+        Clock::duration start;
+        Clock::duration duration;
+        Args args;
+    };
+
+    Clock::time_point origin;
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::map<std::string, Clock::time_point> open_events;
+};
+
+}  // namespace libdnf5::base
+
+#endif  // LIBDNF5_BASE_TRANSACTION_TIMELINE_HPP
@@ -47,8 +47,8 @@ namespace libdnf5 {
 /// 1k = 1024 bytes is used.
 ///
 /// @param str Bandwidth as user friendly string
-/// @return int Number of bytes
-static int str_to_bytes(const std::string & str) {
+/// @return double Number of bytes
+static double str_to_bytes_double(const std::string & str) {
     if (str.empty()) {
         throw OptionInvalidValueError(M_("Input is empty. Must contain a value."));
     }
@@ -81,7 +81,11 @@ static int str_to_bytes(const std::string & str) {
         }
     }
 
-    return static_cast<int>(res);
+    return res;
+}
+
+static int str_to_bytes(const std::string & str) {
+    return static_cast<int>(str_to_bytes_double(str));
 }
 
 static void add_from_file(std::ostream & out, const std::string & file_path) {
@@ -279,6 +283,15 @@ class ConfigMain::Impl {
     OptionBool countme{false};
     OptionBool protect_running_kernel{true};
     OptionBool build_cache{true};
+    OptionNumber<std::uint32_t> max_parallel_metadata_downloads{3, 1};
+    OptionBool lazy_filelists{false};
+    OptionBool mirror_scoreboard{false};
+    OptionNumber<std::uint32_t> max_downloads_per_mirror{3, 1};
+    OptionPath package_store_dir{nullptr};
+    OptionNumber<std::uint64_t> package_store_max_size{
+        0, [](const std::string & value) { return static_cast<std::uint64_t>(str_to_bytes_double(value)); }};
+    OptionBool rpm_test_transaction{true};
+    OptionPath transaction_timeline_file{nullptr, false, true};
 
     // Repo main config
 
@@ -469,6 +482,14 @@ ConfigMain::Impl::Impl(Config & owner) : owner(owner) {
     owner.opt_binds().add("countme", countme);
     owner.opt_binds().add("protect_running_kernel", protect_running_kernel);
     owner.opt_binds().add("build_cache", build_cache);
+    owner.opt_binds().add("max_parallel_metadata_downloads", max_parallel_metadata_downloads);
+    owner.opt_binds().add("lazy_filelists", lazy_filelists);
+    owner.opt_binds().add("mirror_scoreboard", mirror_scoreboard);
+    owner.opt_binds().add("max_downloads_per_mirror", max_downloads_per_mirror);
+    owner.opt_binds().add("package_store_dir", package_store_dir);
+    owner.opt_binds().add("package_store_max_size", package_store_max_size);
+    owner.opt_binds().add("rpm_test_transaction", rpm_test_transaction);
+    owner.opt_binds().add("transaction_timeline_file", transaction_timeline_file);
 
     // Repo main config
 
@@ -1154,6 +1175,62 @@ const OptionBool & ConfigMain::get_build_cache_option() const {
     return p_impl->build_cache;
 }
 
+OptionNumber<std::uint32_t> & ConfigMain::get_max_parallel_metadata_downloads_option() {
+    return p_impl->max_parallel_metadata_downloads;
+}
+const OptionNumber<std::uint32_t> & ConfigMain::get_max_parallel_metadata_downloads_option() const {
+    return p_impl->max_parallel_metadata_downloads;
+}
+
+OptionBool & ConfigMain::get_lazy_filelists_option() {
+    return p_impl->lazy_filelists;
+}
+const OptionBool & ConfigMain::get_lazy_filelists_option() const {
+    return p_impl->lazy_filelists;
+}
+
+OptionBool & ConfigMain::get_mirror_scoreboard_option() {
+    return p_impl->mirror_scoreboard;
+}
+const OptionBool & ConfigMain::get_mirror_scoreboard_option() const {
+    return p_impl->mirror_scoreboard;
+}
+
+OptionNumber<std::uint32_t> & ConfigMain::get_max_downloads_per_mirror_option() {
+    return p_impl->max_downloads_per_mirror;
+}
+const OptionNumber<std::uint32_t> & ConfigMain::get_max_downloads_per_mirror_option() const {
+    return p_impl->max_downloads_per_mirror;
+}
+
+OptionPath & ConfigMain::get_package_store_dir_option() {
+    return p_impl->package_store_dir;
+}
+const OptionPath & ConfigMain::get_package_store_dir_option() const {
+    return p_impl->package_store_dir;
+}
+
+OptionNumber<std::uint64_t> & ConfigMain::get_package_store_max_size_option() {
+    return p_impl->package_store_max_size;
+}
+const OptionNumber<std::uint64_t> & ConfigMain::get_package_store_max_size_option() const {
+    return p_impl->package_store_max_size;
+}
+
+OptionBool & ConfigMain::get_rpm_test_transaction_option() {
+    return p_impl->rpm_test_transaction;
+}
+const OptionBool & ConfigMain::get_rpm_test_transaction_option() const {
+    return p_impl->rpm_test_transaction;
+}
+
+OptionPath & ConfigMain::get_transaction_timeline_file_option() {
+    return p_impl->transaction_timeline_file;
+}
+const OptionPath & ConfigMain::get_transaction_timeline_file_option() const {
+    return p_impl->transaction_timeline_file;
+}
+
 // Repo main config
 OptionNumber<std::uint32_t> & ConfigMain::get_retries_option() {
     return p_impl->retries;
@@ -22,21 +22,24 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "libdnf5/repo/repo_errors.hpp"
 #include "libdnf5/utils/bgettext/bgettext-mark-domain.h"
 
+#include <string>
+
 namespace libdnf5::repo {
 
-// Map string from config option proxy_auth_method to librepo LrAuth value
+// Map string from config option proxy_auth_method to librepo LrAuth and curl auth values
 static constexpr struct {
     const char * name;
     LrAuth code;
+    unsigned long curl_code;
 } PROXYAUTHMETHODS[] = {
-    {"none", LR_AUTH_NONE},
-    {"basic", LR_AUTH_BASIC},
-    {"digest", LR_AUTH_DIGEST},
-    {"negotiate", LR_AUTH_NEGOTIATE},
-    {"ntlm", LR_AUTH_NTLM},
-    {"digest_ie", LR_AUTH_DIGEST_IE},
-    {"ntlm_wb", LR_AUTH_NTLM_WB},
-    {"any", LR_AUTH_ANY}};
+    {"none", LR_AUTH_NONE, CURLAUTH_NONE},
+    {"basic", LR_AUTH_BASIC, CURLAUTH_BASIC},
+    {"digest", LR_AUTH_DIGEST, CURLAUTH_DIGEST},
+    {"negotiate", LR_AUTH_NEGOTIATE, CURLAUTH_NEGOTIATE},
+    {"ntlm", LR_AUTH_NTLM, CURLAUTH_NTLM},
+    {"digest_ie", LR_AUTH_DIGEST_IE, CURLAUTH_DIGEST_IE},
+    {"ntlm_wb", LR_AUTH_NTLM_WB, CURLAUTH_NTLM_WB},
+    {"any", LR_AUTH_ANY, CURLAUTH_ANY}};
 
 /// Converts the given input string to a URL encoded string
 /// All input characters that are not a-z, A-Z, 0-9, '-', '.', '_' or '~' are converted
@@ -108,9 +111,35 @@ LibrepoHandle & LibrepoHandle::operator=(LibrepoHandle && other) noexcept {
     return *this;
 }
 
+namespace {
+
+// Remote transfer options read from the main or repo configuration, applied to librepo handles
+// and to curl handles used outside of librepo.
+struct RemoteOptions {
+    std::string user_agent;
+    int64_t minrate{0};
+    int64_t maxspeed{0};
+    long timeout{0};
+    std::string ip_resolve;
+    std::string userpwd;
+    std::string sslcacert;
+    std::string sslclientcert;
+    std::string sslclientkey;
+    long sslverify{0};
+    std::string proxy;
+    long proxy_auth_methods{0};
+    unsigned long proxy_auth_methods_curl{0};
+    std::string proxy_userpwd;
+    std::string proxy_sslcacert;
+    std::string proxy_sslclientcert;
+    std::string proxy_sslclientkey;
+    long proxy_sslverify{0};
+};
+
 template <typename C>
-static void init_remote(LibrepoHandle & handle, const C & config) {
-    handle.set_opt(LRO_USERAGENT, config.get_user_agent_option().get_value().c_str());
+RemoteOptions get_remote_options(const C & config) {
+    RemoteOptions options;
+    options.user_agent = config.get_user_agent_option().get_value();
 
     auto minrate = config.get_minrate_option().get_value();
     auto maxspeed = config.get_throttle_option().get_value();
@@ -123,82 +152,174 @@ static void init_remote(LibrepoHandle & handle, const C & config) {
             M_("Maximum download speed is lower than minimum, "
                "please change configuration of minrate or throttle"));
     }
-    handle.set_opt(LRO_LOWSPEEDLIMIT, static_cast<int64_t>(minrate));
-    handle.set_opt(LRO_MAXSPEED, static_cast<int64_t>(maxspeed));
+    options.minrate = static_cast<int64_t>(minrate);
+    options.maxspeed = static_cast<int64_t>(maxspeed);
 
-    long timeout = config.get_timeout_option().get_value();
-    if (timeout > 0) {
-        handle.set_opt(LRO_CONNECTTIMEOUT, timeout);
-        handle.set_opt(LRO_LOWSPEEDTIME, timeout);
-    }
-
-    auto & ip_resolve = config.get_ip_resolve_option().get_value();
-    if (ip_resolve == "ipv4") {
-        handle.set_opt(LRO_IPRESOLVE, LR_IPRESOLVE_V4);
-    } else if (ip_resolve == "ipv6") {
-        handle.set_opt(LRO_IPRESOLVE, LR_IPRESOLVE_V6);
-    }
+    options.timeout = config.get_timeout_option().get_value();
+    options.ip_resolve = config.get_ip_resolve_option().get_value();
 
     auto userpwd = config.get_username_option().get_value();
     if (!userpwd.empty()) {
         // TODO Use URL encoded form, needs support in librepo
-        userpwd = format_user_pass_string(userpwd, config.get_password_option().get_value(), false);
-        handle.set_opt(LRO_USERPWD, userpwd.c_str());
+        options.userpwd = format_user_pass_string(userpwd, config.get_password_option().get_value(), false);
     }
 
-    if (!config.get_sslcacert_option().get_value().empty()) {
-        handle.set_opt(LRO_SSLCACERT, config.get_sslcacert_option().get_value().c_str());
-    }
-    if (!config.get_sslclientcert_option().get_value().empty()) {
-        handle.set_opt(LRO_SSLCLIENTCERT, config.get_sslclientcert_option().get_value().c_str());
-    }
-    if (!config.get_sslclientkey_option().get_value().empty()) {
-        handle.set_opt(LRO_SSLCLIENTKEY, config.get_sslclientkey_option().get_value().c_str());
-    }
-    long sslverify = config.get_sslverify_option().get_value() ? 1L : 0L;
-    handle.set_opt(LRO_SSLVERIFYHOST, sslverify);
-    handle.set_opt(LRO_SSLVERIFYPEER, sslverify);
+    options.sslcacert = config.get_sslcacert_option().get_value();
+    options.sslclientcert = config.get_sslclientcert_option().get_value();
+    options.sslclientkey = config.get_sslclientkey_option().get_value();
+    options.sslverify = config.get_sslverify_option().get_value() ? 1L : 0L;
 
     // === proxy setup ===
-    if (!config.get_proxy_option().empty() && !config.get_proxy_option().get_value().empty()) {
-        handle.set_opt(LRO_PROXY, config.get_proxy_option().get_value().c_str());
+    if (!config.get_proxy_option().empty()) {
+        options.proxy = config.get_proxy_option().get_value();
     }
 
-    long proxy_auth_methods = 0;
     if (config.get_proxy_auth_method_option().empty()) {
-        proxy_auth_methods = LR_AUTH_ANY;
+        options.proxy_auth_methods = LR_AUTH_ANY;
+        options.proxy_auth_methods_curl = CURLAUTH_ANY;
     } else {
         for (const auto & proxy_auth_method_str : config.get_proxy_auth_method_option().get_value()) {
             for (auto & auth : PROXYAUTHMETHODS) {
                 if (proxy_auth_method_str == auth.name) {
-                    proxy_auth_methods |= auth.code;
+                    options.proxy_auth_methods |= auth.code;
+                    options.proxy_auth_methods_curl |= auth.curl_code;
                     break;
                 }
             }
         }
     }
-    handle.set_opt(LRO_PROXYAUTHMETHODS, proxy_auth_methods);
 
     if (!config.get_proxy_username_option().empty()) {
         auto userpwd = config.get_proxy_username_option().get_value();
         if (!userpwd.empty()) {
-            userpwd = format_user_pass_string(userpwd, config.get_proxy_password_option().get_value(), true);
-            handle.set_opt(LRO_PROXYUSERPWD, userpwd.c_str());
+            options.proxy_userpwd =
+                format_user_pass_string(userpwd, config.get_proxy_password_option().get_value(), true);
         }
     }
 
-    if (!config.get_proxy_sslcacert_option().get_value().empty()) {
-        handle.set_opt(LRO_PROXY_SSLCACERT, config.get_proxy_sslcacert_option().get_value().c_str());
+    options.proxy_sslcacert = config.get_proxy_sslcacert_option().get_value();
+    options.proxy_sslclientcert = config.get_proxy_sslclientcert_option().get_value();
+    options.proxy_sslclientkey = config.get_proxy_sslclientkey_option().get_value();
+    options.proxy_sslverify = config.get_proxy_sslverify_option().get_value() ? 1L : 0L;
+
+    return options;
+}
+
+}  // namespace
+
+template <typename C>
+static void init_remote(LibrepoHandle & handle, const C & config) {
+    auto options = get_remote_options(config);
+
+    handle.set_opt(LRO_USERAGENT, options.user_agent.c_str());
+
+    handle.set_opt(LRO_LOWSPEEDLIMIT, options.minrate);
+    handle.set_opt(LRO_MAXSPEED, options.maxspeed);
+
+    if (options.timeout > 0) {
+        handle.set_opt(LRO_CONNECTTIMEOUT, options.timeout);
+        handle.set_opt(LRO_LOWSPEEDTIME, options.timeout);
+    }
+
+    if (options.ip_resolve == "ipv4") {
+        handle.set_opt(LRO_IPRESOLVE, LR_IPRESOLVE_V4);
+    } else if (options.ip_resolve == "ipv6") {
+        handle.set_opt(LRO_IPRESOLVE, LR_IPRESOLVE_V6);
+    }
+
+    if (!options.userpwd.empty()) {
+        handle.set_opt(LRO_USERPWD, options.userpwd.c_str());
+    }
+
+    if (!options.sslcacert.empty()) {
+        handle.set_opt(LRO_SSLCACERT, options.sslcacert.c_str());
+    }
+    if (!options.sslclientcert.empty()) {
+        handle.set_opt(LRO_SSLCLIENTCERT, options.sslclientcert.c_str());
+    }
+    if (!options.sslclientkey.empty()) {
+        handle.set_opt(LRO_SSLCLIENTKEY, options.sslclientkey.c_str());
+    }
+    handle.set_opt(LRO_SSLVERIFYHOST, options.sslverify);
+    handle.set_opt(LRO_SSLVERIFYPEER, options.sslverify);
+
+    // === proxy setup ===
+    if (!options.proxy.empty()) {
+        handle.set_opt(LRO_PROXY, options.proxy.c_str());
+    }
+    handle.set_opt(LRO_PROXYAUTHMETHODS, options.proxy_auth_methods);
+    if (!options.proxy_userpwd.empty()) {
+        handle.set_opt(LRO_PROXYUSERPWD, options.proxy_userpwd.c_str());
+    }
+    if (!options.proxy_sslcacert.empty()) {
+        handle.set_opt(LRO_PROXY_SSLCACERT, options.proxy_sslcacert.c_str());
+    }
+    if (!options.proxy_sslclientcert.empty()) {
+        handle.set_opt(LRO_PROXY_SSLCLIENTCERT, options.proxy_sslclientcert.c_str());
+    }
+    if (!options.proxy_sslclientkey.empty()) {
+        handle.set_opt(LRO_PROXY_SSLCLIENTKEY, options.proxy_sslclientkey.c_str());
+    }
+    handle.set_opt(LRO_PROXY_SSLVERIFYHOST, options.proxy_sslverify);
+    handle.set_opt(LRO_PROXY_SSLVERIFYPEER, options.proxy_sslverify);
+}
+
+
+void init_curl_handle(CURL * handle, const libdnf5::repo::ConfigRepo & config) {
+    auto options = get_remote_options(config);
+
+    // curl copies the string options, the options do not need to outlive the handle
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, options.user_agent.c_str());
+
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, static_cast<long>(options.minrate));
+    curl_easy_setopt(handle, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(options.maxspeed));
+
+    if (options.timeout > 0) {
+        curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, options.timeout);
+        curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, options.timeout);
+    }
+
+    if (options.ip_resolve == "ipv4") {
+        curl_easy_setopt(handle, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
+    } else if (options.ip_resolve == "ipv6") {
+        curl_easy_setopt(handle, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V6);
+    }
+
+    if (!options.userpwd.empty()) {
+        curl_easy_setopt(handle, CURLOPT_USERPWD, options.userpwd.c_str());
+    }
+
+    if (!options.sslcacert.empty()) {
+        curl_easy_setopt(handle, CURLOPT_CAINFO, options.sslcacert.c_str());
+    }
+    if (!options.sslclientcert.empty()) {
+        curl_easy_setopt(handle, CURLOPT_SSLCERT, options.sslclientcert.c_str());
+    }
+    if (!options.sslclientkey.empty()) {
+        curl_easy_setopt(handle, CURLOPT_SSLKEY, options.sslclientkey.c_str());
+    }
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, options.sslverify ? 2L : 0L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, options.sslverify);
+
+    // === proxy setup ===
+    if (!options.proxy.empty()) {
+        curl_easy_setopt(handle, CURLOPT_PROXY, options.proxy.c_str());
+    }
+    curl_easy_setopt(handle, CURLOPT_PROXYAUTH, options.proxy_auth_methods_curl);
+    if (!options.proxy_userpwd.empty()) {
+        curl_easy_setopt(handle, CURLOPT_PROXYUSERPWD, options.proxy_userpwd.c_str());
+    }
+    if (!options.proxy_sslcacert.empty()) {
+        curl_easy_setopt(handle, CURLOPT_PROXY_CAINFO, options.proxy_sslcacert.c_str());
     }
-    if (!config.get_proxy_sslclientcert_option().get_value().empty()) {
-        handle.set_opt(LRO_PROXY_SSLCLIENTCERT, config.get_proxy_sslclientcert_option().get_value().c_str());
+    if (!options.proxy_sslclientcert.empty()) {
+        curl_easy_setopt(handle, CURLOPT_PROXY_SSLCERT, options.proxy_sslclientcert.c_str());
     }
-    if (!config.get_proxy_sslclientkey_option().get_value().empty()) {
-        handle.set_opt(LRO_PROXY_SSLCLIENTKEY, config.get_proxy_sslclientkey_option().get_value().c_str());
+    if (!options.proxy_sslclientkey.empty()) {
+        curl_easy_setopt(handle, CURLOPT_PROXY_SSLKEY, options.proxy_sslclientkey.c_str());
     }
-    long proxy_sslverify = config.get_proxy_sslverify_option().get_value() ? 1L : 0L;
-    handle.set_opt(LRO_PROXY_SSLVERIFYHOST, proxy_sslverify);
-    handle.set_opt(LRO_PROXY_SSLVERIFYPEER, proxy_sslverify);
+    curl_easy_setopt(handle, CURLOPT_PROXY_SSL_VERIFYHOST, options.proxy_sslverify ? 2L : 0L);
+    curl_easy_setopt(handle, CURLOPT_PROXY_SSL_VERIFYPEER, options.proxy_sslverify);
 }
 
 
@@ -23,6 +23,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "libdnf5/common/exception.hpp"
 #include "libdnf5/repo/config_repo.hpp"
 
+#include <curl/curl.h>
 #include <librepo/librepo.h>
 
 #include <memory>
@@ -114,6 +115,11 @@ private:
     LrHandle * handle;
 };
 
+
+/// Sets up a curl handle used for a request outside of librepo with the same remote options
+/// (user agent, speed limits, timeouts, authentication, SSL and proxy) as `LibrepoHandle::init_remote()`.
+void init_curl_handle(CURL * handle, const libdnf5::repo::ConfigRepo & config);
+
 }  // namespace libdnf5::repo
 
 #endif  // LIBDNF5_REPO_LIBREPO_PRIVATE_HPP
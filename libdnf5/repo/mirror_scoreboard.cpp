@@ -0,0 +1,328 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "mirror_scoreboard.hpp"
+
+#include "utils/fs/file.hpp"
+#include "utils/fs/temp.hpp"
+#include "utils/locker.hpp"
+#include "utils/string.hpp"
+
+#include "libdnf5/base/base.hpp"
+
+#include <toml.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+
+namespace toml {
+
+template <>
+struct from<libdnf5::repo::MirrorScoreboard::MirrorStats> {
+    static libdnf5::repo::MirrorScoreboard::MirrorStats from_toml(const value & v) {
+        libdnf5::repo::MirrorScoreboard::MirrorStats stats;
+
+        stats.successes = toml::find<double>(v, "successes");
+        stats.failures = toml::find<double>(v, "failures");
+        stats.latency = toml::find<double>(v, "latency");
+        stats.throughput = toml::find<double>(v, "throughput");
+        stats.updated = toml::find<std::int64_t>(v, "updated");
+
+        return stats;
+    }
+};
+
+
+template <>
+struct into<libdnf5::repo::MirrorScoreboard::MirrorStats> {
+    static toml::value into_toml(const libdnf5::repo::MirrorScoreboard::MirrorStats & stats) {
+        toml::value res;
+
+        res["successes"] = stats.successes;
+        res["failures"] = stats.failures;
+        res["latency"] = stats.latency;
+        res["throughput"] = stats.throughput;
+        res["updated"] = stats.updated;
+
+        return res;
+    }
+};
+
+}  // namespace toml
+
+
+namespace libdnf5::repo {
+
+namespace {
+
+constexpr const char * SCOREBOARD_FILENAME = "mirror-scoreboard.toml";
+constexpr const char * SCOREBOARD_VERSION = "1.0";
+
+// half-life of the recorded transfers in seconds
+constexpr double DECAY_HALF_LIFE = 7 * 24 * 3600;
+
+// weight of a new measurement in the moving averages of latency and throughput
+constexpr double MEASUREMENT_WEIGHT = 0.3;
+
+// statistics of mirrors with less transfers (after decay) are dropped
+constexpr double MIN_TRANSFERS = 0.01;
+
+// amount of data used to compare mirrors with different latency and throughput
+constexpr double REFERENCE_SIZE = 1024 * 1024;
+
+// the scoreboard lock is held only for a merge and a write, it is retried for up to a second
+constexpr int LOCK_ATTEMPTS = 100;
+constexpr auto LOCK_RETRY_DELAY = std::chrono::milliseconds(10);
+
+std::int64_t now_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// the mirrors are identified by their URL without the trailing slashes
+std::string normalize(std::string mirror) {
+    while (!mirror.empty() && mirror.back() == '/') {
+        mirror.pop_back();
+    }
+    return mirror;
+}
+
+void update_average(double & average, double value, bool first) {
+    average = first ? value : (1 - MEASUREMENT_WEIGHT) * average + MEASUREMENT_WEIGHT * value;
+}
+
+}  // namespace
+
+
+MirrorScoreboard::MirrorScoreboard(const BaseWeakPtr & base) : base(base) {}
+
+
+bool MirrorScoreboard::is_enabled() const {
+    return base->get_config().get_mirror_scoreboard_option().get_value();
+}
+
+
+std::filesystem::path MirrorScoreboard::get_path() const {
+    return std::filesystem::path(base->get_config().get_cachedir_option().get_value()) / SCOREBOARD_FILENAME;
+}
+
+
+void MirrorScoreboard::load() {
+    loaded = true;
+    stats.clear();
+
+    const auto path = get_path();
+    if (!std::filesystem::exists(path)) {
+        return;
+    }
+
+    try {
+        auto toml_value = toml::parse(path);
+        if (toml::find<std::string>(toml_value, "version") != SCOREBOARD_VERSION) {
+            base->get_logger()->debug("Unsupported version of mirror scoreboard \"{}\", ignoring it", path.native());
+            return;
+        }
+        stats = toml::find<std::map<std::string, MirrorStats>>(toml_value, "mirrors");
+    } catch (const std::exception & ex) {
+        base->get_logger()->warning("Cannot read mirror scoreboard \"{}\", ignoring it: {}", path.native(), ex.what());
+        stats.clear();
+    }
+}
+
+
+void MirrorScoreboard::decay(MirrorStats & stats, std::int64_t now) {
+    if (now > stats.updated) {
+        auto factor = std::exp2(-static_cast<double>(now - stats.updated) / DECAY_HALF_LIFE);
+        stats.successes *= factor;
+        stats.failures *= factor;
+    }
+    stats.updated = now;
+}
+
+
+void MirrorScoreboard::add_records(MirrorStats & stats, const MirrorRecords & records, std::int64_t now) {
+    decay(stats, now);
+    stats.successes += records.successes;
+    stats.failures += records.failures;
+    for (auto latency : records.latencies) {
+        update_average(stats.latency, latency, stats.latency == 0);
+    }
+    for (auto throughput : records.throughputs) {
+        update_average(stats.throughput, throughput, stats.throughput == 0);
+    }
+}
+
+
+double MirrorScoreboard::get_cost(const MirrorStats & stats) {
+    // the mirrors without measurements are assumed to be average
+    double latency = stats.latency > 0 ? stats.latency : 0.1;
+    double throughput = stats.throughput > 0 ? stats.throughput : 1024 * 1024;
+    // a failed transfer has to be repeated from another mirror, estimate of the success probability
+    double success_rate = (stats.successes + 1) / (stats.successes + stats.failures + 2);
+    return (latency + REFERENCE_SIZE / throughput) / success_rate;
+}
+
+
+void MirrorScoreboard::record_success(
+    const std::string & mirror, std::optional<double> latency, std::optional<double> throughput) {
+    if (mirror.empty() || !is_enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) {
+        load();
+    }
+
+    MirrorRecords transfer;
+    transfer.successes = 1;
+    if (latency && *latency >= 0) {
+        transfer.latencies.push_back(*latency);
+    }
+    if (throughput && *throughput > 0) {
+        transfer.throughputs.push_back(*throughput);
+    }
+
+    auto name = normalize(mirror);
+    add_records(stats[name], transfer, now_seconds());
+    auto & mirror_records = records[name];
+    mirror_records.successes += transfer.successes;
+    mirror_records.latencies.insert(
+        mirror_records.latencies.end(), transfer.latencies.begin(), transfer.latencies.end());
+    mirror_records.throughputs.insert(
+        mirror_records.throughputs.end(), transfer.throughputs.begin(), transfer.throughputs.end());
+}
+
+
+void MirrorScoreboard::record_failure(const std::string & mirror) {
+    if (mirror.empty() || !is_enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) {
+        load();
+    }
+
+    auto name = normalize(mirror);
+    auto & mirror_stats = stats[name];
+    decay(mirror_stats, now_seconds());
+    mirror_stats.failures += 1;
+    records[name].failures += 1;
+}
+
+
+void MirrorScoreboard::sort_mirrors(std::vector<std::string> & mirrors) {
+    if (mirrors.size() < 2 || !is_enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) {
+        load();
+    }
+
+    const auto now = now_seconds();
+    std::vector<std::size_t> known_positions;
+    std::vector<std::pair<double, std::string>> known_mirrors;
+    for (std::size_t idx = 0; idx < mirrors.size(); ++idx) {
+        auto it = stats.find(normalize(mirrors[idx]));
+        if (it != stats.end()) {
+            auto mirror_stats = it->second;
+            decay(mirror_stats, now);
+            known_positions.push_back(idx);
+            known_mirrors.emplace_back(get_cost(mirror_stats), mirrors[idx]);
+        }
+    }
+
+    std::stable_sort(known_mirrors.begin(), known_mirrors.end(), [](const auto & lhs, const auto & rhs) {
+        return lhs.first < rhs.first;
+    });
+    for (std::size_t idx = 0; idx < known_positions.size(); ++idx) {
+        mirrors[known_positions[idx]] = std::move(known_mirrors[idx].second);
+    }
+}
+
+
+void MirrorScoreboard::save() {
+    if (!is_enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (records.empty()) {
+        return;
+    }
+
+    const auto path = get_path();
+    try {
+        std::filesystem::create_directories(path.parent_path());
+
+        // other processes may have saved their transfers since the statistics were loaded
+        utils::Locker locker(path.native() + ".lock");
+        int attempts = 0;
+        while (!locker.write_lock()) {
+            if (++attempts == LOCK_ATTEMPTS) {
+                base->get_logger()->debug(
+                    "Mirror scoreboard \"{}\" is locked, the transfers are saved later", path.native());
+                return;
+            }
+            std::this_thread::sleep_for(LOCK_RETRY_DELAY);
+        }
+        load();
+
+        const auto now = now_seconds();
+        for (const auto & [mirror, mirror_records] : records) {
+            add_records(stats[mirror], mirror_records, now);
+        }
+        for (auto it = stats.begin(); it != stats.end();) {
+            auto decayed = it->second;
+            decay(decayed, now);
+            if (decayed.successes + decayed.failures < MIN_TRANSFERS) {
+                it = stats.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        utils::fs::TempFile temp_file(path.parent_path(), path.filename());
+        temp_file.open_as_file("w").write(toml::format<toml::discard_comments, std::map, std::vector>(
+            toml::value({{"mirrors", stats}, {"version", SCOREBOARD_VERSION}})));
+        temp_file.close();
+        std::filesystem::rename(temp_file.get_path(), path);
+        temp_file.release();
+
+        records.clear();
+    } catch (const std::exception & ex) {
+        base->get_logger()->warning("Cannot write mirror scoreboard \"{}\": {}", path.native(), ex.what());
+    }
+}
+
+
+std::string MirrorScoreboard::get_mirror(const std::string & url, const std::string & path) {
+    if (path.empty() || !utils::string::ends_with(url, path)) {
+        return {};
+    }
+    return normalize(url.substr(0, url.size() - path.size()));
+}
+
+}  // namespace libdnf5::repo
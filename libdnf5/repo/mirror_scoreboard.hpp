@@ -0,0 +1,108 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBDNF5_REPO_MIRROR_SCOREBOARD_HPP
+#define LIBDNF5_REPO_MIRROR_SCOREBOARD_HPP
+
+#include "libdnf5/base/base_weak.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace libdnf5::repo {
+
+/// Persistent statistics of the mirrors used for downloading metadata and packages. For each mirror it keeps
+/// the numbers of successful and failed transfers, the latency (time to the first byte) and the throughput.
+/// The numbers decay with a half-life of a week, so the statistics follow the current state of the mirrors.
+/// The statistics are used to order the mirrors of repositories, they are used only if the `mirror_scoreboard`
+/// option is enabled. The methods can be called from several threads.
+class MirrorScoreboard {
+public:
+    explicit MirrorScoreboard(const BaseWeakPtr & base);
+
+    /// @return True if the `mirror_scoreboard` option is enabled.
+    bool is_enabled() const;
+
+    /// Records a successful transfer from the `mirror`.
+    /// @param mirror      Base URL of the mirror.
+    /// @param latency     Time to the first byte in seconds, if measured.
+    /// @param throughput  Transfer speed in bytes per second, if measured.
+    void record_success(const std::string & mirror, std::optional<double> latency, std::optional<double> throughput);
+
+    /// Records a failed transfer from the `mirror`.
+    void record_failure(const std::string & mirror);
+
+    /// Orders the known mirrors by their expected download time, the best first. The mirrors without
+    /// statistics keep their positions, so the order of a mirrorlist is still respected for them.
+    void sort_mirrors(std::vector<std::string> & mirrors);
+
+    /// Merges the transfers recorded since the last save into the statistics in the cache. The file is
+    /// locked and re-read, so the transfers recorded by other processes in the meantime are kept.
+    void save();
+
+    /// @return The base URL of the mirror from the `url` of a file at the `path` relative to the mirror,
+    ///         an empty string if the `url` does not end with the `path`.
+    static std::string get_mirror(const std::string & url, const std::string & path);
+
+    /// Statistics of one mirror
+    struct MirrorStats {
+        double successes{0};
+        double failures{0};
+        double latency{0};
+        double throughput{0};
+        std::int64_t updated{0};
+    };
+
+private:
+    /// Transfers from one mirror recorded since the last save
+    struct MirrorRecords {
+        double successes{0};
+        double failures{0};
+        std::vector<double> latencies;
+        std::vector<double> throughputs;
+    };
+
+    std::filesystem::path get_path() const;
+    void load();
+
+    /// Applies the decay for the time from the last update of the `stats` to `now`.
+    static void decay(MirrorStats & stats, std::int64_t now);
+
+    /// Adds the recorded transfers to the `stats` decayed to `now`.
+    static void add_records(MirrorStats & stats, const MirrorRecords & records, std::int64_t now);
+
+    /// @return The expected time of downloading a reference amount of data from a mirror with the `stats`.
+    static double get_cost(const MirrorStats & stats);
+
+    BaseWeakPtr base;
+    std::mutex mutex;
+    bool loaded{false};
+    std::map<std::string, MirrorStats> stats;
+    std::map<std::string, MirrorRecords> records;
+};
+
+}  // namespace libdnf5::repo
+
+#endif  // LIBDNF5_REPO_MIRROR_SCOREBOARD_HPP
@@ -19,12 +19,15 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "libdnf5/repo/package_downloader.hpp"
 
+#include "base/base_impl.hpp"
+#include "mirror_scoreboard.hpp"
 #include "repo_downloader.hpp"
 #include "temp_files_memory.hpp"
 
 #include "libdnf5/base/base.hpp"
 #include "libdnf5/common/exception.hpp"
 #include "libdnf5/repo/download_callbacks.hpp"
+#include "libdnf5/repo/package_store.hpp"
 #include "libdnf5/repo/repo.hpp"
 #include "libdnf5/repo/repo_errors.hpp"
 #include "libdnf5/utils/bgettext/bgettext-mark-domain.h"
@@ -32,7 +35,10 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <librepo/librepo.h>
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <functional>
+#include <numeric>
 
 
 namespace std {
@@ -58,12 +64,24 @@ public:
     std::string destination;
     void * user_data;
     void * user_cb_data{nullptr};
+    const std::function<void(const libdnf5::rpm::Package &)> * package_downloaded_callback{nullptr};
+
+    // transfer timing for the mirror scoreboard
+    std::optional<std::chrono::steady_clock::time_point> transfer_start;
+    std::optional<std::chrono::steady_clock::time_point> first_byte;
+    std::chrono::steady_clock::time_point transfer_end;
+    double downloaded{0};
 };
 
 static int end_callback(void * data, LrTransferStatus status, const char * msg) {
     libdnf_assert(data != nullptr, "data in callback must be set");
 
     auto * package_target = static_cast<PackageTarget *>(data);
+    package_target->transfer_end = std::chrono::steady_clock::now();
+    if (package_target->package_downloaded_callback &&
+        (status == LR_TRANSFER_SUCCESSFUL || status == LR_TRANSFER_ALREADYEXISTS)) {
+        (*package_target->package_downloaded_callback)(package_target->package);
+    }
     auto cb_status = static_cast<DownloadCallbacks::TransferStatus>(status);
     if (auto * download_callbacks = package_target->package.get_base()->get_download_callbacks()) {
         return download_callbacks->end(package_target->user_cb_data, cb_status, msg);
@@ -75,6 +93,14 @@ static int progress_callback(void * data, double total_to_download, double downl
     libdnf_assert(data != nullptr, "data in callback must be set");
 
     auto * package_target = static_cast<PackageTarget *>(data);
+    auto now = std::chrono::steady_clock::now();
+    if (!package_target->transfer_start) {
+        package_target->transfer_start = now;
+    }
+    if (downloaded > 0 && !package_target->first_byte) {
+        package_target->first_byte = now;
+    }
+    package_target->downloaded = downloaded;
     if (auto * download_callbacks = package_target->package.get_base()->get_download_callbacks()) {
         return download_callbacks->progress(package_target->user_cb_data, total_to_download, downloaded);
     }
@@ -85,6 +111,10 @@ static int mirror_failure_callback(void * data, const char * msg, const char * u
     libdnf_assert(data != nullptr, "data in callback must be set");
 
     auto * package_target = static_cast<PackageTarget *>(data);
+    if (url) {
+        InternalBaseUser::get_mirror_scoreboard(package_target->package.get_base())
+            .record_failure(MirrorScoreboard::get_mirror(url, package_target->package.get_location()));
+    }
     if (auto * download_callbacks = package_target->package.get_base()->get_download_callbacks()) {
         return download_callbacks->mirror_failure(package_target->user_cb_data, msg, url, nullptr);
     }
@@ -105,6 +135,7 @@ private:
     std::optional<bool> keep_packages;
     bool fail_fast;
     bool resume;
+    std::function<void(const libdnf5::rpm::Package &)> package_downloaded_callback;
 };
 
 
@@ -139,6 +170,8 @@ void PackageDownloader::download() try {
 
     GError * err{nullptr};
 
+    PackageStore package_store(p_impl->base);
+
     std::vector<std::unique_ptr<LrPackageTarget>> lr_targets;
     lr_targets.reserve(p_impl->targets.size());
     for (auto & pkg_target : p_impl->targets) {
@@ -150,6 +183,19 @@ void PackageDownloader::download() try {
 
         std::filesystem::create_directory(pkg_target.destination);
 
+        // librepo finds the package linked from the package store already present after verifying its checksum,
+        // a hardlink of another package that librepo would rewrite in place is replaced
+        if (package_store.is_enabled()) {
+            package_store.link_to(
+                pkg_target.package,
+                std::filesystem::path(pkg_target.destination) /
+                    std::filesystem::path(pkg_target.package.get_location()).filename());
+        }
+
+        if (p_impl->package_downloaded_callback) {
+            pkg_target.package_downloaded_callback = &p_impl->package_downloaded_callback;
+        }
+
         if (auto * download_callbacks = pkg_target.package.get_base()->get_download_callbacks()) {
             pkg_target.user_cb_data = download_callbacks->add_new_download(
                 pkg_target.user_data,
@@ -181,10 +227,20 @@ void PackageDownloader::download() try {
         lr_targets.emplace_back(lr_target);
     }
 
+    // Librepo starts the downloads in the order of the list. Starting the largest packages first keeps a large
+    // package queued at the end from prolonging the whole download. Librepo assigns a mirror to a queued target
+    // only when it is started, respecting the per-mirror limit, so the remaining smaller targets are spread
+    // over the mirrors that are free at that time.
+    std::vector<std::size_t> download_order(lr_targets.size());
+    std::iota(download_order.begin(), download_order.end(), 0);
+    std::stable_sort(download_order.begin(), download_order.end(), [this](std::size_t lhs, std::size_t rhs) {
+        return p_impl->targets[lhs].package.get_download_size() > p_impl->targets[rhs].package.get_download_size();
+    });
+
     // Adding items to the end of GSList is slow. We go from the back and add items to the beginning.
     GSList * list{nullptr};
-    for (auto it = lr_targets.rbegin(); it != lr_targets.rend(); ++it) {
-        list = g_slist_prepend(list, it->get());
+    for (auto it = download_order.rbegin(); it != download_order.rend(); ++it) {
+        list = g_slist_prepend(list, lr_targets[*it].get());
     }
     std::unique_ptr<GSList, decltype(&g_slist_free)> list_holder(list, &g_slist_free);
 
@@ -213,7 +269,50 @@ void PackageDownloader::download() try {
         temp_files_memory.add_files(package_paths);
     }
 
-    if (!lr_download_packages(list, flags, &err)) {
+    auto downloaded = lr_download_packages(list, flags, &err);
+
+    // records the successful transfers, the failures were recorded by the mirror failure callback
+    auto & scoreboard = InternalBaseUser::get_mirror_scoreboard(p_impl->base);
+    if (scoreboard.is_enabled()) {
+        for (std::size_t idx = 0; idx < lr_targets.size(); ++idx) {
+            const auto * lr_target = lr_targets[idx].get();
+            const auto & pkg_target = p_impl->targets[idx];
+            if (lr_target->err || !lr_target->usedmirror || !pkg_target.transfer_start || !pkg_target.first_byte) {
+                continue;
+            }
+            std::chrono::duration<double> latency = *pkg_target.first_byte - *pkg_target.transfer_start;
+            std::chrono::duration<double> transfer = pkg_target.transfer_end - *pkg_target.first_byte;
+            scoreboard.record_success(
+                lr_target->usedmirror,
+                latency.count(),
+                transfer.count() > 0 ? std::optional<double>(pkg_target.downloaded / transfer.count())
+                                     : std::nullopt);
+        }
+        scoreboard.save();
+    }
+
+    if (package_store.is_enabled()) {
+        try {
+            bool package_store_grown{false};
+            for (std::size_t idx = 0; idx < lr_targets.size(); ++idx) {
+                if (!lr_targets[idx]->err) {
+                    const auto & pkg_target = p_impl->targets[idx];
+                    package_store_grown |= package_store.add(
+                        pkg_target.package,
+                        std::filesystem::path(pkg_target.destination) /
+                            std::filesystem::path(pkg_target.package.get_location()).filename());
+                }
+            }
+            // the store is scanned once for the whole batch and only if it has grown
+            if (package_store_grown) {
+                package_store.evict();
+            }
+        } catch (const std::filesystem::filesystem_error & ex) {
+            p_impl->base->get_logger()->warning("Cannot update the package store: {}", ex.what());
+        }
+    }
+
+    if (!downloaded) {
         throw LibrepoError(std::unique_ptr<GError>(err));
     }
 } catch (const RepoCacheonlyError & e) {
@@ -234,4 +333,9 @@ void PackageDownloader::force_keep_packages(bool value) {
     p_impl->keep_packages = value;
 }
 
+void PackageDownloader::set_package_downloaded_callback(
+    std::function<void(const libdnf5::rpm::Package &)> && callback) {
+    p_impl->package_downloaded_callback = std::move(callback);
+}
+
 }  // namespace libdnf5::repo
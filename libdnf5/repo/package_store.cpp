@@ -0,0 +1,331 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "libdnf5/repo/package_store.hpp"
+
+#include "utils/on_scope_exit.hpp"
+
+#include "libdnf5/base/base.hpp"
+#include "libdnf5/logger/logger.hpp"
+
+#include <fcntl.h>
+#include <librepo/checksum.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+
+namespace libdnf5::repo {
+
+namespace {
+
+// suffix of the files being added to the store
+constexpr const char * TEMP_FILE_SUFFIX = ".tmp";
+
+
+// Creates `destination` sharing the data of `source`. Tries a hardlink, a reflink (the filesystems
+// with copy-on-write support) and finally a copy. Returns false if the destination could not be created.
+bool link_or_copy(const std::filesystem::path & source, const std::filesystem::path & destination) {
+    std::error_code ec;
+    std::filesystem::create_hard_link(source, destination, ec);
+    if (!ec) {
+        return true;
+    }
+
+    auto src_fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd == -1) {
+        return false;
+    }
+    utils::OnScopeExit close_src_fd([src_fd]() noexcept { ::close(src_fd); });
+
+    auto dst_fd = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (dst_fd == -1) {
+        return false;
+    }
+    auto cloned = ::ioctl(dst_fd, FICLONE, src_fd) == 0;
+    ::close(dst_fd);
+    if (cloned) {
+        return true;
+    }
+
+    std::filesystem::remove(destination, ec);
+    return std::filesystem::copy_file(source, destination, ec);
+}
+
+
+// Marks the stored package as recently used, the eviction uses the access time. The modification time
+// is kept, librepo uses it to validate the checksum cached in the extended attributes of the file.
+void touch(const std::filesystem::path & path) {
+    const struct timespec times[2] = {{0, UTIME_NOW}, {0, UTIME_OMIT}};
+    ::utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+
+// Verifies the size and the checksum of the `package` file at `path`. The verified checksum is cached
+// in the extended attributes of the file, the next verification of the unmodified file does not read it.
+bool verify_package_file(const libdnf5::rpm::Package & package, const std::filesystem::path & path) {
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    utils::OnScopeExit close_fd([fd]() noexcept { ::close(fd); });
+
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0 ||
+        static_cast<unsigned long long>(file_stat.st_size) != package.get_download_size()) {
+        return false;
+    }
+    auto checksum = package.get_checksum();
+    gboolean matches{FALSE};
+    lr_checksum_fd_cmp(
+        static_cast<LrChecksumType>(checksum.get_type()), fd, checksum.get_checksum().c_str(), TRUE, &matches, NULL);
+    return matches;
+}
+
+}  // namespace
+
+
+class PackageStore::Impl {
+public:
+    Impl(const BaseWeakPtr & base) : base(base) {}
+
+private:
+    friend PackageStore;
+
+    std::filesystem::path get_package_path(const libdnf5::rpm::Package & package) const;
+
+    BaseWeakPtr base;
+};
+
+
+PackageStore::PackageStore(const libdnf5::BaseWeakPtr & base) : p_impl(std::make_unique<Impl>(base)) {}
+
+PackageStore::PackageStore(libdnf5::Base & base) : PackageStore(base.get_weak_ptr()) {}
+
+PackageStore::~PackageStore() = default;
+
+
+bool PackageStore::is_enabled() const {
+    return !p_impl->base->get_config().get_package_store_dir_option().empty();
+}
+
+
+std::filesystem::path PackageStore::Impl::get_package_path(const libdnf5::rpm::Package & package) const {
+    if (base->get_config().get_package_store_dir_option().empty()) {
+        return {};
+    }
+    auto checksum = package.get_checksum();
+    const auto & hex = checksum.get_checksum();
+    if (checksum.get_type() == libdnf5::rpm::Checksum::Type::UNKNOWN || hex.size() < 3) {
+        return {};
+    }
+    // the files are spread over subdirectories to keep the directories reasonably small
+    return std::filesystem::path(base->get_config().get_package_store_dir_option().get_value()) /
+           checksum.get_type_str() / hex.substr(0, 2) / hex;
+}
+
+
+bool PackageStore::contains(const libdnf5::rpm::Package & package) const {
+    auto path = p_impl->get_package_path(package);
+    return !path.empty() && verify_package_file(package, path);
+}
+
+
+bool PackageStore::link_to(const libdnf5::rpm::Package & package, const std::filesystem::path & destination) const {
+    auto & base = p_impl->base;
+    auto stored = contains(package);
+    auto path = p_impl->get_package_path(package);
+
+    struct stat dst_stat;
+    if (::stat(destination.c_str(), &dst_stat) == 0) {
+        // librepo verifies the existing file and rewrites it in place if it does not match
+        if (dst_stat.st_nlink == 1) {
+            return false;
+        }
+        struct stat src_stat;
+        if (stored && ::stat(path.c_str(), &src_stat) == 0 && src_stat.st_dev == dst_stat.st_dev &&
+            src_stat.st_ino == dst_stat.st_ino) {
+            touch(path);
+            return true;
+        }
+        // the data shared with other files, possibly with another stored package, must not be rewritten
+        std::error_code ec;
+        std::filesystem::remove(destination, ec);
+    }
+
+    if (!stored) {
+        return false;
+    }
+    if (!link_or_copy(path, destination)) {
+        base->get_logger()->debug(
+            "Cannot link package \"{}\" from the package store to \"{}\"", path.native(), destination.native());
+        return false;
+    }
+    touch(path);
+    base->get_logger()->debug("Package \"{}\" linked from the package store", package.get_full_nevra());
+    return true;
+}
+
+
+bool PackageStore::add(const libdnf5::rpm::Package & package, const std::filesystem::path & path) const {
+    auto stored_path = p_impl->get_package_path(package);
+    if (stored_path.empty()) {
+        return false;
+    }
+    if (contains(package)) {
+        touch(stored_path);
+        return false;
+    }
+
+    // the package appears in the store atomically, other processes may use the store at the same time
+    std::error_code ec;
+    std::filesystem::create_directories(stored_path.parent_path(), ec);
+    if (ec) {
+        p_impl->base->get_logger()->debug(
+            "Cannot create package store directory \"{}\": {}", stored_path.parent_path().native(), ec.message());
+        return false;
+    }
+    auto temp_path = stored_path;
+    temp_path += "." + std::to_string(::getpid()) + TEMP_FILE_SUFFIX;
+    std::filesystem::remove(temp_path, ec);
+    if (!link_or_copy(path, temp_path)) {
+        p_impl->base->get_logger()->debug("Cannot add package \"{}\" to the package store", path.native());
+        return false;
+    }
+    // the verification also caches the checksum of the stored file for the next lookups
+    if (!verify_package_file(package, temp_path)) {
+        std::filesystem::remove(temp_path, ec);
+        p_impl->base->get_logger()->debug("Package \"{}\" does not match its checksum, not stored", path.native());
+        return false;
+    }
+    std::filesystem::rename(temp_path, stored_path, ec);
+    if (ec) {
+        p_impl->base->get_logger()->debug(
+            "Cannot add package \"{}\" to the package store: {}", path.native(), ec.message());
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    touch(stored_path);
+    return true;
+}
+
+
+RepoCacheRemoveStatistics PackageStore::evict() const {
+    auto & base = p_impl->base;
+    RepoCacheRemoveStatistics status{};
+    auto max_size = base->get_config().get_package_store_max_size_option().get_value();
+    if (!is_enabled() || max_size == 0) {
+        return status;
+    }
+
+    struct StoredFile {
+        std::filesystem::path path;
+        std::uintmax_t size;
+        struct timespec last_used;
+    };
+    std::vector<StoredFile> stored_files;
+    std::uintmax_t total_size{0};
+    std::error_code ec;
+    std::filesystem::path store_dir = base->get_config().get_package_store_dir_option().get_value();
+    for (const auto & dir_entry : std::filesystem::recursive_directory_iterator(store_dir, ec)) {
+        if (!dir_entry.is_regular_file(ec) || dir_entry.path().native().ends_with(TEMP_FILE_SUFFIX)) {
+            continue;
+        }
+        struct stat file_stat;
+        if (::stat(dir_entry.path().c_str(), &file_stat) != 0) {
+            continue;
+        }
+        auto size = static_cast<std::uintmax_t>(file_stat.st_size);
+        stored_files.push_back({dir_entry.path(), size, file_stat.st_atim});
+        total_size += size;
+    }
+    if (total_size <= max_size) {
+        return status;
+    }
+
+    std::sort(stored_files.begin(), stored_files.end(), [](const StoredFile & lhs, const StoredFile & rhs) {
+        return std::tie(lhs.last_used.tv_sec, lhs.last_used.tv_nsec) <
+               std::tie(rhs.last_used.tv_sec, rhs.last_used.tv_nsec);
+    });
+    auto & logger = *base->get_logger();
+    for (const auto & stored_file : stored_files) {
+        if (total_size <= max_size) {
+            break;
+        }
+        if (std::filesystem::remove(stored_file.path, ec)) {
+            ++status.files_removed;
+            total_size -= stored_file.size;
+        } else if (ec) {
+            ++status.errors;
+            logger.warning("Cannot remove \"{}\" from the package store: {}", stored_file.path.native(), ec.message());
+        }
+    }
+    logger.debug(
+        "Package store eviction complete. Removed {} files, {} errors. Store size is {} bytes",
+        status.files_removed,
+        status.errors,
+        total_size);
+    return status;
+}
+
+
+RepoCacheRemoveStatistics PackageStore::remove_packages() const {
+    auto & base = p_impl->base;
+    RepoCacheRemoveStatistics status{};
+    if (!is_enabled()) {
+        return status;
+    }
+
+    // the subdirectories are removed after their content, the store directory itself is kept
+    std::filesystem::path store_dir = base->get_config().get_package_store_dir_option().get_value();
+    std::vector<std::filesystem::path> dirs;
+    std::error_code ec;
+    for (const auto & dir_entry : std::filesystem::recursive_directory_iterator(store_dir, ec)) {
+        if (dir_entry.is_directory(ec)) {
+            dirs.push_back(dir_entry.path());
+        } else if (std::filesystem::remove(dir_entry.path(), ec)) {
+            ++status.files_removed;
+        } else if (ec) {
+            ++status.errors;
+        }
+    }
+    for (auto it = dirs.rbegin(); it != dirs.rend(); ++it) {
+        if (std::filesystem::remove(*it, ec)) {
+            ++status.dirs_removed;
+        } else if (ec) {
+            ++status.errors;
+        }
+    }
+    base->get_logger()->debug(
+        "Packages removal from package store in path \"{}\" complete. Removed {} files, {} directories. {} errors",
+        store_dir.native(),
+        status.files_removed,
+        status.dirs_removed,
+        status.errors);
+    return status;
+}
+
+}  // namespace libdnf5::repo
@@ -25,6 +25,7 @@ constexpr const char * REPOID_CHARS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmno
 #include "solv_repo.hpp"
 #include "utils/fs/file.hpp"
 #include "utils/string.hpp"
+#include "utils/thread_pool.hpp"
 
 #include "libdnf5/common/exception.hpp"
 #include "libdnf5/conf/const.hpp"
@@ -58,6 +59,7 @@ extern "C" {
 #include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <list>
@@ -65,6 +67,7 @@ extern "C" {
 #include <set>
 #include <sstream>
 #include <system_error>
+#include <thread>
 #include <type_traits>
 
 
@@ -224,6 +227,18 @@ void Repo::load() {
     base->get_rpm_package_sack()->p_impl->invalidate_provides();
 }
 
+void Repo::load_filelists() {
+    if (!filelists_load_deferred) {
+        return;
+    }
+    filelists_load_deferred = false;
+
+    solv_repo->load_repo_ext(RepodataType::FILELISTS, *downloader.get());
+
+    solv_repo->set_needs_internalizing();
+    base->get_rpm_package_sack()->p_impl->invalidate_provides();
+}
+
 void Repo::load_extra_system_repo(const std::string & rootdir) {
     libdnf_user_assert(type == Type::SYSTEM, "repo type must be SYSTEM to load an extra system repo");
     libdnf_user_assert(solv_repo, "repo must be loaded to load an extra system repo");
@@ -433,6 +448,10 @@ void Repo::load_available_repo() {
         solv_repo->load_repo_ext(RepodataType::COMPS, *downloader.get());
     }
 
+    // filelists not requested by optional_metadata_types are loaded by load_filelists() when needed
+    filelists_load_deferred = config.get_main_config().get_lazy_filelists_option().get_value() &&
+                              !optional_metadata.contains(libdnf5::METADATA_TYPE_FILELISTS);
+
     // Load module metadata
 #ifdef MODULEMD
     auto & logger = *base->get_logger();
@@ -505,6 +524,68 @@ rpm::Package Repo::add_rpm_package(const std::string & path, bool with_hdrid) {
 }
 
 
+// Computes the SHA256 checksum of the whole RPM file, the same one libsolv computes with RPM_ADD_WITH_SHA256SUM.
+// Unlike adding the RPM to the pool, it can run in parallel with other threads.
+static std::vector<unsigned char> compute_rpm_checksum(const std::string & path) {
+    is_readable_rpm(path);
+
+    std::unique_ptr<Chksum, void (*)(Chksum *)> chksum(
+        solv_chksum_create(REPOKEY_TYPE_SHA256), [](Chksum * ptr) { solv_chksum_free(ptr, nullptr); });
+    utils::fs::File file(path, "r");
+    std::array<char, 65536> buffer;
+    while (auto len = file.read(buffer.data(), buffer.size())) {
+        solv_chksum_add(chksum.get(), buffer.data(), static_cast<int>(len));
+    }
+
+    int len{0};
+    auto * digest = solv_chksum_get(chksum.get(), &len);
+    return std::vector<unsigned char>(digest, digest + len);
+}
+
+
+std::vector<rpm::Package> Repo::add_rpm_packages(const std::vector<std::string> & paths, bool with_hdrid) {
+    std::vector<rpm::Package> packages;
+    // only computing the checksums of the whole files is worth running in parallel
+    if (!with_hdrid || paths.size() < 2) {
+        for (const auto & path : paths) {
+            packages.push_back(add_rpm_package(path, with_hdrid));
+        }
+        return packages;
+    }
+
+    // The checksums are computed by the workers. The packages are added to the pool in this thread, into a single
+    // repodata like by add_rpm_package(), and the checksums are set on them as the results arrive.
+    utils::ThreadPool checksum_calculators(std::min<std::size_t>(std::thread::hardware_concurrency(), paths.size()));
+    std::vector<std::future<std::vector<unsigned char>>> checksums;
+    checksums.reserve(paths.size());
+    for (const auto & path : paths) {
+        checksums.push_back(checksum_calculators.submit([&path]() { return compute_rpm_checksum(path); }));
+    }
+
+    make_solv_repo();
+
+    int flags = REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE | RPM_ADD_WITH_HDRID;
+    packages.reserve(paths.size());
+    for (std::size_t idx = 0; idx < paths.size(); ++idx) {
+        auto checksum = checksums[idx].get();
+
+        Id new_id = repo_add_rpm(solv_repo->repo, paths[idx].c_str(), flags);
+        if (new_id == 0) {
+            throw RepoRpmError(M_("Failed to load RPM \"{}\": {}"), paths[idx], pool_errstr(solv_repo->repo->pool));
+        }
+        repodata_set_bin_checksum(
+            repo_last_repodata(solv_repo->repo), new_id, SOLVABLE_CHECKSUM, REPOKEY_TYPE_SHA256, checksum.data());
+
+        solv_repo->set_needs_internalizing();
+        base->get_rpm_package_sack()->p_impl->invalidate_provides();
+
+        packages.emplace_back(base, rpm::PackageId(new_id));
+    }
+
+    return packages;
+}
+
+
 void Repo::internalize() {
     if (solv_repo) {
         solv_repo->internalize();
@@ -117,6 +117,9 @@ RepoCache::RemoveStatistics RepoCache::remove_metadata() {
 
     status.files_removed += remove(cache_dir / CACHE_MIRRORLIST_FILE, status.errors, log);
     status.files_removed += remove(cache_dir / CACHE_METALINK_FILE, status.errors, log);
+    status.files_removed += remove(get_attribute_filepath(cache_dir, ATTRIBUTE_REPOMD_ETAG), status.errors, log);
+    status.files_removed +=
+        remove(get_attribute_filepath(cache_dir, ATTRIBUTE_REPOMD_LAST_MODIFIED), status.errors, log);
     log.debug(
         "Metadata removal from repository cache in path \"{}\" complete. Removed {} files, {} directories. {} errors",
         cache_dir.native(),
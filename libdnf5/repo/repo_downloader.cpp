@@ -19,21 +19,27 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "repo_downloader.hpp"
 
+#include "base/base_impl.hpp"
+#include "utils/fs/file.hpp"
 #include "utils/fs/temp.hpp"
 #include "utils/fs/utils.hpp"
 #include "utils/string.hpp"
 
 #include "libdnf5/base/base.hpp"
 #include "libdnf5/conf/const.hpp"
+#include "libdnf5/repo/repo_cache.hpp"
 #include "libdnf5/repo/repo_errors.hpp"
 #include "libdnf5/utils/bgettext/bgettext-mark-domain.h"
 
+#include <curl/curl.h>
 #include <librepo/librepo.h>
 #include <solv/chksum.h>
 #include <solv/util.h>
 
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <random>
 
 
@@ -47,6 +53,10 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 namespace libdnf5::repo {
 
+// Metadata of several repositories can be downloaded concurrently (see `RepoSack::update_and_load_repos()`).
+// The user-provided download callbacks are not required to be thread-safe, so the calls to them are serialized.
+static std::mutex download_callbacks_mutex;
+
 static void str_vector_to_char_array(const std::vector<std::string> & vec, const char * arr[]) {
     for (size_t i = 0; i < vec.size(); ++i) {
         arr[i] = vec[i].c_str();
@@ -54,6 +64,60 @@ static void str_vector_to_char_array(const std::vector<std::string> & vec, const
     arr[vec.size()] = nullptr;
 }
 
+namespace {
+
+struct CurlEasyDeleter {
+    void operator()(CURL * curl) const noexcept { curl_easy_cleanup(curl); }
+};
+
+struct CurlSlistDeleter {
+    void operator()(curl_slist * list) const noexcept { curl_slist_free_all(list); }
+};
+
+// Validators of the response to the conditional request for repomd.xml
+struct RepomdResponse {
+    std::string etag;
+    std::string last_modified;
+};
+
+// Only the headers of the response are needed, the transfer is aborted when the body starts.
+size_t repomd_abort_body_cb(char *, size_t, size_t, void *) {
+    return 0;
+}
+
+size_t repomd_header_cb(char * data, size_t size, size_t nitems, void * userdata) {
+    auto * response = static_cast<RepomdResponse *>(userdata);
+    std::string header(data, size * nitems);
+
+    // each response (e.g. of a redirect) starts with a status line, only the validators of the last one are used
+    if (libdnf5::utils::string::starts_with(header, "HTTP/")) {
+        response->etag.clear();
+        response->last_modified.clear();
+        return size * nitems;
+    }
+
+    auto colon = header.find(':');
+    if (colon != std::string::npos) {
+        auto name = libdnf5::utils::string::tolower(header.substr(0, colon));
+        auto value = header.substr(colon + 1);
+        libdnf5::utils::string::trim(value);
+        if (name == "etag") {
+            response->etag = std::move(value);
+        } else if (name == "last-modified") {
+            response->last_modified = std::move(value);
+        }
+    }
+    return size * nitems;
+}
+
+}  // namespace
+
+// Returns the base URL of the mirror from the URL of a metadata file.
+static std::string get_metadata_mirror(const std::string & url) {
+    auto pos = url.rfind("/" METADATA_RELATIVE_DIR "/");
+    return pos == std::string::npos ? url : url.substr(0, pos + 1);
+}
+
 static LrYumRepo * get_yum_repo(LibrepoResult & result) {
     LrYumRepo * yum_repo;
     result.get_info(LRR_YUM_REPO, &yum_repo);
@@ -86,6 +150,7 @@ int RepoDownloader::progress_cb(void * data, double total_to_download, double do
         total_to_download += repo_downloader->sum_prev_downloaded;
         downloaded += repo_downloader->sum_prev_downloaded;
 
+        std::lock_guard<std::mutex> lock(download_callbacks_mutex);
         return download_callbacks->progress(repo_downloader->user_cb_data, total_to_download, downloaded);
     }
     return 0;
@@ -116,6 +181,7 @@ void RepoDownloader::fastest_mirror_cb(void * data, LrFastestMirrorStages stage,
         } else {
             msg = nullptr;
         }
+        std::lock_guard<std::mutex> lock(download_callbacks_mutex);
         download_callbacks->fastest_mirror(
             repo_downloader->user_cb_data, static_cast<DownloadCallbacks::FastestMirrorStage>(stage), msg);
     }
@@ -127,7 +193,11 @@ int RepoDownloader::mirror_failure_cb(
         return 0;
     }
     auto repo_downloader = static_cast<RepoDownloader *>(data);
+    if (url) {
+        InternalBaseUser::get_mirror_scoreboard(repo_downloader->base).record_failure(get_metadata_mirror(url));
+    }
     if (auto * download_callbacks = repo_downloader->base->get_download_callbacks()) {
+        std::lock_guard<std::mutex> lock(download_callbacks_mutex);
         return download_callbacks->mirror_failure(repo_downloader->user_cb_data, msg, url, metadata);
     }
     return 0;
@@ -153,7 +223,25 @@ void RepoDownloader::download_metadata(const std::string & destdir) try {
     libdnf5::utils::fs::TempDir tmpdir(destdir, "tmpdir");
 
     LibrepoHandle h(init_remote_handle(tmpdir.get_path().c_str()));
-    perform(h, config.get_repo_gpgcheck_option().get_value());
+    auto start = std::chrono::steady_clock::now();
+    auto result = perform(h, config.get_repo_gpgcheck_option().get_value());
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    auto & scoreboard = InternalBaseUser::get_mirror_scoreboard(base);
+    if (scoreboard.is_enabled()) {
+        std::uintmax_t downloaded{0};
+        for (const auto & entry : std::filesystem::recursive_directory_iterator(tmpdir.get_path())) {
+            if (entry.is_regular_file()) {
+                downloaded += entry.file_size();
+            }
+        }
+        // the latency of the mirror is not known, the transfers of the files are not measured separately
+        scoreboard.record_success(
+            libdnf5::utils::string::c_to_str(get_yum_repo(result)->url),
+            std::nullopt,
+            duration.count() > 0 ? std::optional<double>(static_cast<double>(downloaded) / duration.count())
+                                 : std::nullopt);
+    }
 
     // move all downloaded object from tmpdir to destdir
     for (auto & dir : std::filesystem::directory_iterator(tmpdir.get_path())) {
@@ -164,6 +252,11 @@ void RepoDownloader::download_metadata(const std::string & destdir) try {
 
         utils::fs::move_recursive(tmp_item, target_item);
     }
+
+    // the stored repomd validators belong to the replaced repomd
+    RepoCache cache(base, destdir);
+    cache.remove_attribute(RepoCache::ATTRIBUTE_REPOMD_ETAG);
+    cache.remove_attribute(RepoCache::ATTRIBUTE_REPOMD_LAST_MODIFIED);
 } catch (const std::runtime_error & e) {
     auto src = get_source_info();
     throw_with_nested(RepoDownloadError(
@@ -249,6 +342,12 @@ bool RepoDownloader::is_repomd_in_sync() try {
     auto & logger = *base->get_logger();
     LrYumRepo * yum_repo;
 
+    std::string etag;
+    std::string last_modified;
+    if (auto in_sync = revalidate_repomd(etag, last_modified)) {
+        return *in_sync;
+    }
+
     libdnf5::utils::fs::TempDir tmpdir("tmpdir");
 
     const char * dlist[] = LR_YUM_REPOMDONLY;
@@ -260,10 +359,14 @@ bool RepoDownloader::is_repomd_in_sync() try {
     result.get_info(LRR_YUM_REPO, &yum_repo);
 
     auto same = utils::fs::have_files_same_content_noexcept(repomd_filename.c_str(), yum_repo->repomd);
-    if (same)
+    if (same) {
         logger.debug("Sync check: repo \"{}\" in sync, repomd matches", config.get_id());
-    else
+        if (!etag.empty() || !last_modified.empty()) {
+            store_repomd_validators(etag, last_modified);
+        }
+    } else {
         logger.trace("Sync check: failed for repo \"{}\", repomd mismatch", config.get_id());
+    }
     return same;
 } catch (const std::runtime_error & e) {
     auto src = get_source_info();
@@ -275,6 +378,141 @@ bool RepoDownloader::is_repomd_in_sync() try {
 }
 
 
+std::optional<bool> RepoDownloader::revalidate_repomd(std::string & etag, std::string & last_modified) {
+    auto & logger = *base->get_logger();
+
+    // only the repomd of the baseurl that librepo tries first is revalidated, mirrors may serve different validators
+    if ((!config.get_metalink_option().empty() && !config.get_metalink_option().get_value().empty()) ||
+        (!config.get_mirrorlist_option().empty() && !config.get_mirrorlist_option().get_value().empty()) ||
+        config.get_baseurl_option().get_value().empty() || repomd_filename.empty()) {
+        return std::nullopt;
+    }
+
+    // the baseurls are tried in the order of their scores, the same as in init_remote_handle()
+    auto baseurls = config.get_baseurl_option().get_value();
+    InternalBaseUser::get_mirror_scoreboard(base).sort_mirrors(baseurls);
+
+    std::string url;
+    {
+        LrUrlVars * substs = nullptr;
+        for (const auto & item : substitutions) {
+            substs = lr_urlvars_set(substs, item.first.c_str(), item.second.c_str());
+        }
+        char * substituted = lr_url_substitute(baseurls.front().c_str(), substs);
+        lr_urlvars_free(substs);
+        url = substituted;
+        lr_free(substituted);
+    }
+    if (!utils::string::starts_with(url, "http://") && !utils::string::starts_with(url, "https://")) {
+        return std::nullopt;
+    }
+    if (url.back() != '/') {
+        url.push_back('/');
+    }
+    url += "repodata/repomd.xml";
+
+    // the validators are stored only for the repomd that is in the cache, see store_repomd_validators()
+    RepoCache cache(base, config.get_cachedir());
+    try {
+        if (cache.is_attribute(RepoCache::ATTRIBUTE_REPOMD_ETAG)) {
+            etag = cache.read_attribute(RepoCache::ATTRIBUTE_REPOMD_ETAG);
+        }
+        if (cache.is_attribute(RepoCache::ATTRIBUTE_REPOMD_LAST_MODIFIED)) {
+            last_modified = cache.read_attribute(RepoCache::ATTRIBUTE_REPOMD_LAST_MODIFIED);
+        }
+    } catch (const std::runtime_error & ex) {
+        logger.debug("Sync check: cannot read repomd validators of repo \"{}\": {}", config.get_id(), ex.what());
+    }
+
+    std::unique_ptr<CURL, CurlEasyDeleter> curl(curl_easy_init());
+    if (!curl) {
+        return std::nullopt;
+    }
+
+    std::unique_ptr<curl_slist, CurlSlistDeleter> headers;
+    auto add_header = [&headers](const std::string & header) {
+        auto * list = curl_slist_append(headers.get(), header.c_str());
+        if (list) {
+            headers.release();
+            headers.reset(list);
+        }
+    };
+    for (const auto & header : http_headers) {
+        add_header(header);
+    }
+    if (!etag.empty()) {
+        add_header("If-None-Match: " + etag);
+    }
+    if (!last_modified.empty()) {
+        add_header("If-Modified-Since: " + last_modified);
+    }
+
+    RepomdResponse response;
+    auto * handle = curl.get();
+    init_curl_handle(handle, config);
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers.get());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, repomd_abort_body_cb);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, repomd_header_cb);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, &response);
+
+    auto res = curl_easy_perform(handle);
+    long status{0};
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+
+    // the transfer of a response with a body is aborted by the write callback
+    if (res != CURLE_OK && !(res == CURLE_WRITE_ERROR && status == 200)) {
+        logger.debug(
+            "Sync check: conditional request for repomd of repo \"{}\" failed: {}",
+            config.get_id(),
+            curl_easy_strerror(res));
+        return std::nullopt;
+    }
+
+    if (status == 304) {
+        logger.debug("Sync check: repo \"{}\" in sync, repomd not modified", config.get_id());
+        return true;
+    }
+
+    if (status != 200) {
+        logger.debug(
+            "Sync check: unexpected status {} of conditional request for repomd of repo \"{}\"",
+            status,
+            config.get_id());
+    }
+
+    // The repomd is compared by the librepo download. The validators of the current repomd are stored
+    // if it matches the cached one.
+    etag = status == 200 ? std::move(response.etag) : std::string();
+    last_modified = status == 200 ? std::move(response.last_modified) : std::string();
+    return std::nullopt;
+}
+
+
+void RepoDownloader::store_repomd_validators(const std::string & etag, const std::string & last_modified) {
+    // The validators describe the cached repomd now. They are removed when new metadata are downloaded,
+    // so a stale validator cannot confirm a repomd that is no longer in the cache.
+    RepoCache cache(base, config.get_cachedir());
+    try {
+        if (!etag.empty()) {
+            cache.write_attribute(RepoCache::ATTRIBUTE_REPOMD_ETAG, etag);
+        } else {
+            cache.remove_attribute(RepoCache::ATTRIBUTE_REPOMD_ETAG);
+        }
+        if (!last_modified.empty()) {
+            cache.write_attribute(RepoCache::ATTRIBUTE_REPOMD_LAST_MODIFIED, last_modified);
+        } else {
+            cache.remove_attribute(RepoCache::ATTRIBUTE_REPOMD_LAST_MODIFIED);
+        }
+    } catch (const std::runtime_error & ex) {
+        base->get_logger()->debug(
+            "Sync check: cannot store repomd validators of repo \"{}\": {}", config.get_id(), ex.what());
+    }
+}
+
+
 void RepoDownloader::load_local() try {
     LibrepoHandle h(init_local_handle());
 
@@ -352,7 +590,9 @@ void RepoDownloader::reset_loaded() {
 //              (eg metalink) we won't know about it.
 LibrepoHandle & RepoDownloader::get_cached_handle() {
     if (!handle) {
-        handle = init_remote_handle(nullptr, true, false);
+        // with the mirror scoreboard the mirrors resolved from the cached mirrorlist are passed in its order
+        bool mirror_setup = mirrors.empty() || !InternalBaseUser::get_mirror_scoreboard(base).is_enabled();
+        handle = init_remote_handle(nullptr, mirror_setup, false);
     }
     apply_http_headers(*handle);
     return *handle;
@@ -404,6 +644,7 @@ LibrepoHandle RepoDownloader::init_local_handle() {
 }
 
 LibrepoHandle RepoDownloader::init_remote_handle(const char * destdir, bool mirror_setup, bool set_callbacks) {
+    auto & scoreboard = InternalBaseUser::get_mirror_scoreboard(base);
     LibrepoHandle h;
     h.init_remote(config);
 
@@ -432,7 +673,19 @@ LibrepoHandle RepoDownloader::init_remote_handle(const char * destdir, bool mirr
                     h.set_opt(LRO_METALINKURL, tmp.c_str());
             }
 
-            h.set_opt(LRO_FASTESTMIRROR, config.get_fastestmirror_option().get_value() ? 1L : 0L);
+            // The mirrors of the cached mirrorlist are tried first in the order of their scores. The current
+            // mirrorlist is still downloaded, its other mirrors follow. The fastest mirror detection would
+            // override the order.
+            if (scoreboard.is_enabled() && !mirrors.empty()) {
+                auto sorted_mirrors = mirrors;
+                scoreboard.sort_mirrors(sorted_mirrors);
+                const char * c_mirrors[sorted_mirrors.size() + 1];
+                str_vector_to_char_array(sorted_mirrors, c_mirrors);
+                h.set_opt(LRO_URLS, c_mirrors);
+                h.set_opt(LRO_FASTESTMIRROR, 0L);
+            } else {
+                h.set_opt(LRO_FASTESTMIRROR, config.get_fastestmirror_option().get_value() ? 1L : 0L);
+            }
 
             auto fastest_mirror_cache_dir = config.get_basecachedir_option().get_value();
             if (fastest_mirror_cache_dir.back() != '/') {
@@ -442,13 +695,17 @@ LibrepoHandle RepoDownloader::init_remote_handle(const char * destdir, bool mirr
             h.set_opt(LRO_FASTESTMIRRORCACHE, fastest_mirror_cache_dir.c_str());
         } else {
             // use already resolved mirror list
-            const char * c_mirrors[mirrors.size() + 1];
-            str_vector_to_char_array(mirrors, c_mirrors);
+            auto sorted_mirrors = mirrors;
+            scoreboard.sort_mirrors(sorted_mirrors);
+            const char * c_mirrors[sorted_mirrors.size() + 1];
+            str_vector_to_char_array(sorted_mirrors, c_mirrors);
             h.set_opt(LRO_URLS, c_mirrors);
         }
     } else if (!config.get_baseurl_option().get_value().empty()) {
-        const char * urls[config.get_baseurl_option().get_value().size() + 1];
-        str_vector_to_char_array(config.get_baseurl_option().get_value(), urls);
+        auto baseurls = config.get_baseurl_option().get_value();
+        scoreboard.sort_mirrors(baseurls);
+        const char * urls[baseurls.size() + 1];
+        str_vector_to_char_array(baseurls, urls);
         h.set_opt(LRO_URLS, urls);
     } else {
         throw RepoDownloadError(
@@ -462,6 +719,10 @@ LibrepoHandle RepoDownloader::init_remote_handle(const char * destdir, bool mirr
             h.set_opt(LRO_FASTESTMIRRORCB, static_cast<LrFastestMirrorCb>(fastest_mirror_cb));
             h.set_opt(LRO_FASTESTMIRRORDATA, this);
             h.set_opt(LRO_HMFCB, static_cast<LrHandleMirrorFailureCb>(mirror_failure_cb));
+        } else if (scoreboard.is_enabled()) {
+            // the mirror failures are recorded in the mirror scoreboard
+            h.set_opt(LRO_PROGRESSDATA, this);
+            h.set_opt(LRO_HMFCB, static_cast<LrHandleMirrorFailureCb>(mirror_failure_cb));
         }
     }
 
@@ -477,7 +738,9 @@ void RepoDownloader::common_handle_setup(LibrepoHandle & h) {
 #ifdef MODULEMD
     dlist.push_back(MD_FILENAME_MODULES);
 #endif
-    if (optional_metadata.extract(libdnf5::METADATA_TYPE_FILELISTS)) {
+    // with lazy_filelists the filelists are always downloaded, they are loaded when needed
+    if (optional_metadata.extract(libdnf5::METADATA_TYPE_FILELISTS) ||
+        config.get_main_config().get_lazy_filelists_option().get_value()) {
         dlist.push_back(MD_FILENAME_FILELISTS);
     }
     if (optional_metadata.extract(libdnf5::METADATA_TYPE_OTHER)) {
@@ -505,6 +768,9 @@ void RepoDownloader::common_handle_setup(LibrepoHandle & h) {
     h.set_opt(LRO_GPGCHECK, config.get_repo_gpgcheck_option().get_value());
     h.set_opt(LRO_MAXMIRRORTRIES, static_cast<long>(max_mirror_tries));
     h.set_opt(LRO_MAXPARALLELDOWNLOADS, config.get_max_parallel_downloads_option().get_value());
+    h.set_opt(
+        LRO_MAXDOWNLOADSPERMIRROR,
+        static_cast<long>(config.get_main_config().get_max_downloads_per_mirror_option().get_value()));
 
     LrUrlVars * repomd_substs = nullptr;
     repomd_substs = lr_urlvars_set(repomd_substs, MD_FILENAME_GROUP_GZ, MD_FILENAME_GROUP);
@@ -566,6 +832,7 @@ LibrepoResult RepoDownloader::perform(LibrepoHandle & handle, bool set_gpg_home_
     add_countme_flag(handle);
 
     if (progress_func && download_callbacks) {
+        std::lock_guard<std::mutex> lock(download_callbacks_mutex);
         user_cb_data = download_callbacks->add_new_download(
             user_data,
             !config.get_name_option().get_value().empty()
@@ -580,11 +847,13 @@ LibrepoResult RepoDownloader::perform(LibrepoHandle & handle, bool set_gpg_home_
     try {
         auto result = handle.perform();
         if (progress_func && download_callbacks) {
+            std::lock_guard<std::mutex> lock(download_callbacks_mutex);
             download_callbacks->end(user_cb_data, DownloadCallbacks::TransferStatus::SUCCESSFUL, nullptr);
         }
         return result;
     } catch (const LibrepoError & ex) {
         if (progress_func && download_callbacks) {
+            std::lock_guard<std::mutex> lock(download_callbacks_mutex);
             download_callbacks->end(user_cb_data, DownloadCallbacks::TransferStatus::ERROR, ex.what());
         }
         throw;
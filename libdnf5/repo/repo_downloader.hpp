@@ -90,6 +90,19 @@ private:
 
     void download_url(const char * url, int fd);
 
+    /// Checks whether the cached repomd is in sync using a conditional HTTP request with the ETag
+    /// and Last-Modified validators stored in the repository cache. The "304 Not Modified" response
+    /// confirms the cached repomd without transferring it, the transfer of any other response is aborted
+    /// after the headers.
+    /// @param etag           Set to the stored validator, replaced by the one of the current repomd.
+    /// @param last_modified  Set to the stored validator, replaced by the one of the current repomd.
+    /// @return Whether the cached repomd is in sync, std::nullopt if the check is not possible
+    ///         (e.g. the repository does not use an http(s) baseurl), failed or the repomd was modified.
+    std::optional<bool> revalidate_repomd(std::string & etag, std::string & last_modified);
+
+    /// Stores the validators of the cached repomd into the repository cache.
+    void store_repomd_validators(const std::string & etag, const std::string & last_modified);
+
     std::pair<std::string, std::string> get_source_info() const;
 
     void import_repo_keys();
@@ -27,7 +27,9 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "solv_repo.hpp"
 #include "utils/fs/file.hpp"
 #include "utils/fs/temp.hpp"
+#include "utils/on_scope_exit.hpp"
 #include "utils/string.hpp"
+#include "utils/thread_pool.hpp"
 #include "utils/url.hpp"
 #include "utils/xml.hpp"
 
@@ -44,11 +46,16 @@ extern "C" {
 #include <solv/testcase.h>
 }
 
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
 #include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <thread>
 
@@ -149,8 +156,10 @@ std::map<std::string, libdnf5::rpm::Package> RepoSack::add_cmdline_packages(
         url_to_path.emplace(url, cmd_repo_pkgs_dir / dest_path);
     }
 
-    // map a path from the input paths to a Package object created in the cmdline repo
-    std::map<std::string, libdnf5::rpm::Package> path_to_package;
+    // the inputs (URLs or local paths) and the local files to fill the command line repo with
+    std::vector<std::string> inputs;
+    std::vector<std::string> files;
+    std::set<std::string> added_inputs;
 
     if (!url_to_path.empty()) {
         auto & logger = *base->get_logger();
@@ -165,17 +174,27 @@ std::map<std::string, libdnf5::rpm::Package> RepoSack::add_cmdline_packages(
 
         // fill the command line repo with downloaded URLs
         for (const auto & [url, path] : url_to_path) {
-            path_to_package.emplace(url, cmdline_repo->add_rpm_package(path.string(), calculate_checksum));
+            inputs.emplace_back(url);
+            files.emplace_back(path.string());
+            added_inputs.emplace(url);
         }
     }
 
     // fill the command line repo with local files
     for (const auto & path : rpm_filepaths) {
-        if (!path_to_package.contains(path)) {
-            path_to_package.emplace(path, cmdline_repo->add_rpm_package(path, calculate_checksum));
+        if (added_inputs.emplace(path).second) {
+            inputs.emplace_back(path);
+            files.emplace_back(path);
         }
     }
 
+    // map a path from the input paths to a Package object created in the cmdline repo
+    std::map<std::string, libdnf5::rpm::Package> path_to_package;
+    auto packages = cmdline_repo->add_rpm_packages(files, calculate_checksum);
+    for (std::size_t idx = 0; idx < inputs.size(); ++idx) {
+        path_to_package.emplace(inputs[idx], packages[idx]);
+    }
+
     if (!path_to_package.empty()) {
         base->get_rpm_package_sack()->load_config_excludes_includes();
     }
@@ -187,8 +206,6 @@ std::map<std::string, libdnf5::rpm::Package> RepoSack::add_cmdline_packages(
 RepoWeakPtr RepoSack::get_system_repo() {
     if (!system_repo) {
         std::unique_ptr<Repo> repo(new Repo(base, SYSTEM_REPO_NAME, Repo::Type::SYSTEM));
-        // TODO(mblaha): re-enable caching once we can reliably detect whether system repo is up-to-date
-        repo->get_config().get_build_cache_option().set(libdnf5::Option::Priority::RUNTIME, false);
         system_repo = repo.get();
         add_item(std::move(repo));
     }
@@ -399,42 +416,81 @@ void RepoSack::update_and_load_repos(libdnf5::repo::RepoQuery & repos, bool impo
         }
 
         // Prepares repositories that are expired but match the original.
-        for (std::size_t idx = 0; idx < repos_for_processing.size();) {
-            auto * const repo = repos_for_processing[idx];
-            catch_thread_sack_loader_exceptions();
-            try {
-                if (!repo->downloader->get_metadata_path(RepoDownloader::MD_FILENAME_PRIMARY).empty() &&
-                    repo->is_in_sync()) {
-                    // the expired metadata still reflect the origin
-                    utimes(repo->downloader->get_metadata_path(RepoDownloader::MD_FILENAME_PRIMARY).c_str(), nullptr);
-                    RepoCache(base, repo->config.get_cachedir()).remove_attribute(RepoCache::ATTRIBUTE_EXPIRED);
-                    repo->expired = false;
-                    repos_for_processing.erase(repos_for_processing.begin() + static_cast<ssize_t>(idx));
-
-                    logger->debug(
-                        "Using cache for repo \"{}\". It is expired, but matches the original.", repo->config.get_id());
-                    send_to_sack_loader(repo);
-                } else {
-                    ++idx;
-                }
-
-            } catch (const RepoDownloadError & e) {
-                if (handle_repo_download_error(repo, e, import_keys)) {
-                    repos_with_bad_signature.emplace_back(repo);
+        // The sync checks run in parallel, the results are processed in the order of the repositories.
+        {
+            std::vector<std::future<bool>> sync_checks;
+            std::vector<Repo *> repos_not_in_sync;
+            std::atomic<bool> stop_sync_checks{false};
+            utils::ThreadPool sync_checkers(std::min(
+                repos_for_processing.size(),
+                static_cast<std::size_t>(base->get_config().get_max_parallel_metadata_downloads_option().get_value())));
+            // the checks that did not start yet are skipped if the processing fails, the pool waits for the others
+            utils::OnScopeExit skip_sync_checks([&stop_sync_checks]() noexcept { stop_sync_checks = true; });
+            for (auto * const repo : repos_for_processing) {
+                sync_checks.push_back(sync_checkers.submit([repo, &stop_sync_checks]() {
+                    return !stop_sync_checks &&
+                           !repo->downloader->get_metadata_path(RepoDownloader::MD_FILENAME_PRIMARY).empty() &&
+                           repo->is_in_sync();
+                }));
+            }
+            for (std::size_t idx = 0; idx < repos_for_processing.size(); ++idx) {
+                auto * const repo = repos_for_processing[idx];
+                catch_thread_sack_loader_exceptions();
+                try {
+                    if (sync_checks[idx].get()) {
+                        // the expired metadata still reflect the origin
+                        utimes(
+                            repo->downloader->get_metadata_path(RepoDownloader::MD_FILENAME_PRIMARY).c_str(),
+                            nullptr);
+                        RepoCache(base, repo->config.get_cachedir()).remove_attribute(RepoCache::ATTRIBUTE_EXPIRED);
+                        repo->expired = false;
+
+                        logger->debug(
+                            "Using cache for repo \"{}\". It is expired, but matches the original.",
+                            repo->config.get_id());
+                        send_to_sack_loader(repo);
+                    } else {
+                        repos_not_in_sync.emplace_back(repo);
+                    }
+                } catch (const RepoDownloadError & e) {
+                    if (handle_repo_download_error(repo, e, import_keys)) {
+                        repos_with_bad_signature.emplace_back(repo);
+                    }
+                } catch (const std::runtime_error & e) {
+                    except_in_main_thread = true;
+                    finish_sack_loader();
+                    throw;
                 }
-                repos_for_processing.erase(repos_for_processing.begin() + static_cast<ssize_t>(idx));
-            } catch (const std::runtime_error & e) {
-                except_in_main_thread = true;
-                finish_sack_loader();
-                throw;
             }
+            repos_for_processing = std::move(repos_not_in_sync);
         }
 
         // Prepares (downloads) remaining repositories.
-        for (std::size_t idx = 0; idx < repos_for_processing.size();) {
-            auto * const repo = repos_for_processing[idx];
-            catch_thread_sack_loader_exceptions();
-            try {
+        // Metadata are downloaded in parallel. Each downloaded repository is passed to the thread_sack_loader
+        // as soon as its download is finished. Download errors are handled in the main thread.
+        std::vector<std::future<void>> downloads;
+        std::deque<std::size_t> finished_downloads;  // indexes of the finished downloads in the finishing order
+        std::mutex finished_downloads_mutex;
+        std::condition_variable signal_finished_download;
+        std::atomic<bool> stop_downloads{false};
+        utils::ThreadPool downloaders(std::min(
+            repos_for_processing.size(),
+            static_cast<std::size_t>(base->get_config().get_max_parallel_metadata_downloads_option().get_value())));
+        // the downloads that did not start yet are skipped if the processing fails, the pool waits for the others
+        utils::OnScopeExit skip_downloads([&stop_downloads]() noexcept { stop_downloads = true; });
+        for (std::size_t idx = 0; idx < repos_for_processing.size(); ++idx) {
+            downloads.push_back(downloaders.submit([&, idx]() {
+                utils::OnScopeExit report_finished([&, idx]() noexcept {
+                    {
+                        std::lock_guard<std::mutex> lock(finished_downloads_mutex);
+                        finished_downloads.push_back(idx);
+                    }
+                    signal_finished_download.notify_one();
+                });
+                if (stop_downloads) {
+                    return;
+                }
+                auto * const repo = repos_for_processing[idx];
                 logger->debug("Downloading metadata for repo \"{}\"", repo->config.get_id());
                 auto cache_dir = repo->config.get_cachedir();
                 repo->download_metadata(cache_dir);
@@ -442,14 +498,26 @@ void RepoSack::update_and_load_repos(libdnf5::repo::RepoQuery & repos, bool impo
                 repo->timestamp = -1;
                 repo->read_metadata_cache();
                 repo->expired = false;
-
-                repos_for_processing.erase(repos_for_processing.begin() + static_cast<ssize_t>(idx));
+            }));
+        }
+        for (std::size_t num_processed = 0; num_processed < downloads.size(); ++num_processed) {
+            std::size_t idx;
+            {
+                std::unique_lock<std::mutex> lock(finished_downloads_mutex);
+                signal_finished_download.wait(lock, [&finished_downloads] { return !finished_downloads.empty(); });
+                idx = finished_downloads.front();
+                finished_downloads.pop_front();
+            }
+            auto * const repo = repos_for_processing[idx];
+            catch_thread_sack_loader_exceptions();
+            try {
+                // waits until the pool stores the result, the task reports itself finished just before
+                downloads[idx].get();
                 send_to_sack_loader(repo);
             } catch (const RepoDownloadError & e) {
                 if (handle_repo_download_error(repo, e, import_keys)) {
                     repos_with_bad_signature.emplace_back(repo);
                 }
-                repos_for_processing.erase(repos_for_processing.begin() + static_cast<ssize_t>(idx));
             } catch (const std::runtime_error & e) {
                 except_in_main_thread = true;
                 finish_sack_loader();
@@ -461,6 +529,8 @@ void RepoSack::update_and_load_repos(libdnf5::repo::RepoQuery & repos, bool impo
     finish_sack_loader();
     catch_thread_sack_loader_exceptions();
 
+    base->p_impl->get_mirror_scoreboard().save();
+
     fix_group_missing_xml();
 
     base->get_rpm_package_sack()->load_config_excludes_includes();
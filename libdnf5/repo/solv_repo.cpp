@@ -21,6 +21,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "base/base_impl.hpp"
 #include "repo_cache_private.hpp"
+#include "rpm/transaction.hpp"
 #include "solv/pool.hpp"
 #include "utils/fs/temp.hpp"
 
@@ -41,6 +42,8 @@ extern "C" {
 #include <solv/solv_xfopen.h>
 }
 
+#include <memory>
+
 
 namespace libdnf5::repo {
 
@@ -168,6 +171,21 @@ void checksum_calc(unsigned char * out, fs::File & file) {
 }
 
 
+// Computes checksum identifying the content of the system repo: the rpmdb cookie, the root directory
+// and the flags the rpmdb is loaded with.
+static void system_repo_checksum_calc(
+    unsigned char * out, const std::string & rpmdb_cookie, const std::string & rootdir, int flags) {
+    auto h = solv_chksum_create(CHKSUM_TYPE);
+    auto flags_str = std::to_string(flags);
+
+    solv_chksum_add(h, CHKSUM_IDENT, strlen(CHKSUM_IDENT));
+    solv_chksum_add(h, rpmdb_cookie.c_str(), static_cast<int>(rpmdb_cookie.size()) + 1);
+    solv_chksum_add(h, rootdir.c_str(), static_cast<int>(rootdir.size()) + 1);
+    solv_chksum_add(h, flags_str.c_str(), static_cast<int>(flags_str.size()));
+    solv_chksum_free(h, out);
+}
+
+
 static const char * repodata_type_to_name(RepodataType type) {
     switch (type) {
         case RepodataType::FILELISTS:
@@ -273,7 +291,7 @@ void SolvRepo::load_repo_main(const std::string & repomd_fn, const std::string &
     main_solvables_start = solvables_start;
     main_solvables_end = pool->nsolvables;
 
-    if (config.get_build_cache_option().get_value()) {
+    if (is_cache_enabled()) {
         write_main(true);
     }
 }
@@ -382,7 +400,7 @@ void SolvRepo::load_repo_ext(RepodataType type, const RepoDownloader & downloade
             pool_errstr(*get_rpm_pool(base)));
     }
 
-    if (config.get_build_cache_option().get_value()) {
+    if (is_cache_enabled()) {
         if (type == RepodataType::COMPS) {
             write_ext(comps_repo->nrepodata - 1, type);
         } else {
@@ -406,8 +424,37 @@ void SolvRepo::load_system_repo(const std::string & rootdir) {
 
     int solvables_start = pool->nsolvables;
 
-    // TODO(egoode) investigate performance hit of RPM_ADD_WITH_CHANGELOG, possibly make this configurable
-    int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR | RPM_ADD_WITH_CHANGELOG;
+    // changelogs are not loaded, Package::get_changelogs() reads them from the rpmdb on demand
+    int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR;
+
+    // The solv cache is used only for the rpmdb in the installroot. The solvables of an extra system repo
+    // are appended to the same repo, the cache must not be written afterwards.
+    if (!rootdir.empty()) {
+        cache_enabled = false;
+    }
+
+    bool use_cache = is_cache_enabled();
+    if (use_cache) {
+        // the cookie changes with every change of the rpmdb, it identifies the cached content
+        const auto & installroot = base->get_config().get_installroot_option().get_value();
+        try {
+            const auto rpmdb_cookie = libdnf5::rpm::Transaction(base).get_db_cookie();
+            system_repo_checksum_calc(checksum, rpmdb_cookie, installroot, flagsrpm);
+        } catch (const libdnf5::rpm::TransactionError & ex) {
+            logger.debug("Cannot get rpmdb cookie, not using system repo cache: {}", ex.what());
+            use_cache = false;
+        }
+    }
+
+    if (use_cache && load_solv_cache(pool, nullptr, 0)) {
+        pool_set_installed(*pool, repo);
+
+        main_solvables_start = solvables_start;
+        main_solvables_end = pool->nsolvables;
+
+        return;
+    }
+
     if (repo_add_rpmdb(repo, nullptr, flagsrpm) != 0) {
         throw SolvError(
             M_("Failed to load system repo from root \"{}\": {}"),
@@ -418,12 +465,32 @@ void SolvRepo::load_system_repo(const std::string & rootdir) {
     if (!rootdir.empty()) {
         // if loading an extra repo, reset rootdir back to installroot
         pool_set_rootdir(*pool, base->get_config().get_installroot_option().get_value().c_str());
+        extra_root_solvables.push_back({solvables_start, pool->nsolvables, rootdir});
     }
 
     pool_set_installed(*pool, repo);
 
     main_solvables_start = solvables_start;
     main_solvables_end = pool->nsolvables;
+
+    if (use_cache) {
+        // failing to write the cache (e.g. read-only cachedir) must not prevent using the system repo
+        try {
+            write_main(true);
+        } catch (const std::exception & ex) {
+            logger.warning("Cannot write system repo cache: {}", ex.what());
+        }
+    }
+}
+
+
+std::string SolvRepo::get_rpmdb_rootdir(Id id) const {
+    for (const auto & extra : extra_root_solvables) {
+        if (id >= extra.start && id < extra.end) {
+            return extra.rootdir;
+        }
+    }
+    return base->get_config().get_installroot_option().get_value();
 }
 
 
@@ -455,7 +522,7 @@ void SolvRepo::rewrite_repo(libdnf5::solv::IdQueue & fileprovides) {
 
     logger.debug("Rewriting repo \"{}\" with added file provides", config.get_id());
 
-    if (!config.get_build_cache_option().get_value() || main_solvables_start == 0 || fileprovides.size() == 0) {
+    if (!is_cache_enabled() || main_solvables_start == 0 || fileprovides.size() == 0) {
         return;
     }
 
@@ -504,8 +571,24 @@ bool SolvRepo::load_solv_cache(solv::Pool & pool, const char * type, int flags)
 
         if (can_use_solvfile_cache(pool, cache_file)) {
             logger.debug("Loading solv cache file: \"{}\"", path.native());
-            if (repo_add_solv(type == RepoDownloader::MD_FILENAME_GROUP ? comps_repo : repo, cache_file.get(), flags) !=
-                0) {
+            auto * target_repo = type == RepoDownloader::MD_FILENAME_GROUP ? comps_repo : repo;
+
+            // An extension loaded later (e.g. lazily loaded filelists) must extend only the main solvables,
+            // other solvables (e.g. advisories) may have been appended to the repo in the meantime.
+            Repodata * loading_data = nullptr;
+            if ((flags & REPO_EXTEND_SOLVABLES) && target_repo == repo && main_solvables_end != 0 &&
+                repo->end != main_solvables_end) {
+                loading_data = repo_add_repodata(repo, 0);
+                repodata_extend_block(loading_data, main_solvables_start, main_solvables_end - main_solvables_start);
+                loading_data->state = REPODATA_LOADING;
+                flags |= REPO_USE_LOADING;
+            }
+
+            int ret = repo_add_solv(target_repo, cache_file.get(), flags);
+            if (loading_data) {
+                loading_data->state = ret == 0 ? REPODATA_AVAILABLE : REPODATA_ERROR;
+            }
+            if (ret != 0) {
                 throw SolvError(
                     M_("Failed to load {} cache for repo \"{}\" from \"{}\": {}"),
                     type ? type : "primary",
@@ -572,6 +655,7 @@ void SolvRepo::write_main(bool load_after_write) {
         fs::File file(cache_tmp_file.get_path(), "r");
 
         repo_empty(repo, 1);
+        pool.solvables_freed();
         int ret = repo_add_solv(repo, file.get(), 0);
         if (ret) {
             throw SolvError(
@@ -624,6 +708,9 @@ void SolvRepo::write_ext(Id repodata_id, RepodataType type) {
 
     if (type == RepodataType::UPDATEINFO) {
         repowriter_set_solvablerange(writer, updateinfo_solvables_start, updateinfo_solvables_end);
+    } else if (type != RepodataType::COMPS) {
+        // the other extensions extend the main solvables, the repo may already contain also advisories
+        repowriter_set_solvablerange(writer, main_solvables_start, main_solvables_end);
     }
 
     if (type != RepodataType::COMPS && type != RepodataType::UPDATEINFO) {
@@ -651,7 +738,7 @@ void SolvRepo::write_ext(Id repodata_id, RepodataType type) {
 
         Repodata * data = repo_id2repodata(repo, repodata_id);
 
-        repodata_extend_block(data, repo->start, repo->end - repo->start);
+        repodata_extend_block(data, main_solvables_start, main_solvables_end - main_solvables_start);
         data->state = REPODATA_LOADING;
         res = repo_add_solv(repo, file.get(), repodata_type_to_flags(type) | REPO_USE_LOADING);
         if (res) {
@@ -32,6 +32,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <solv/repo.h>
 
 #include <filesystem>
+#include <vector>
 
 
 static const constexpr size_t CHKSUM_BYTES = 32;
@@ -77,9 +78,11 @@ public:
     /// Loads system repository into the pool.
     ///
     /// @param rootdir If empty, loads the installroot rpmdb, if not loads rpmdb from this root path
-    /// TODO(jrohel): Performance: Implement libsolv cache ("build_cache" argument) of system repo in future.
     void load_system_repo(const std::string & rootdir = "");
 
+    /// @return  The root directory of the rpmdb the system repo solvable `id` was loaded from.
+    std::string get_rpmdb_rootdir(Id id) const;
+
     /// Loads additional system repo metadata (comps, modules)
     void load_system_repo_ext(RepodataType type);
 
@@ -123,6 +126,9 @@ public:
 private:
     bool load_solv_cache(solv::Pool & pool, const char * type, int flags);
 
+    /// @return  True if the solv cache files of the repo are written.
+    bool is_cache_enabled() const { return cache_enabled && config.get_build_cache_option().get_value(); }
+
     /// Writes libsolv's .solv cache file with main libsolv repodata.
     void write_main(bool load_after_write);
 
@@ -137,6 +143,10 @@ private:
 
     bool needs_internalizing{false};
 
+    /// False if the repo contains solvables that must not be stored in its solv cache files
+    /// (the solvables of an extra system repo)
+    bool cache_enabled{true};
+
     /// Ranges of solvables for different types of data, used for writing libsolv cache files
     int main_solvables_start{0};
     int main_solvables_end{0};
@@ -146,6 +156,14 @@ private:
     bool can_use_solvfile_cache(solv::Pool & pool, utils::fs::File & solvfile_cache);
     void userdata_fill(SolvUserdata * userdata);
 
+    /// Ranges of the solvables loaded from the rpmdb of an extra root (see `load_system_repo()`)
+    struct ExtraRootSolvables {
+        int start;
+        int end;
+        std::string rootdir;
+    };
+    std::vector<ExtraRootSolvables> extra_root_solvables;
+
     /// List of system repo groups without valid file with xml definition
     std::vector<std::string> groups_missing_xml;
 
@@ -23,16 +23,22 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "base/base_impl.hpp"
 #include "package_sack_impl.hpp"
 #include "reldep_list_impl.hpp"
+#include "repo/solv_repo.hpp"
 #include "solv/pool.hpp"
 #include "utils/on_scope_exit.hpp"
 #include "utils/string.hpp"
 
 #include "libdnf5/common/exception.hpp"
+#include "libdnf5/repo/package_store.hpp"
 #include "libdnf5/rpm/package_query.hpp"
 #include "libdnf5/utils/bgettext/bgettext-mark-domain.h"
 
 #include <fcntl.h>
 #include <librepo/checksum.h>
+#include <rpm/header.h>
+#include <rpm/rpmdb.h>
+#include <rpm/rpmtd.h>
+#include <rpm/rpmts.h>
 #include <unistd.h>
 
 #include <filesystem>
@@ -173,7 +179,10 @@ std::vector<std::string> Package::get_files() const {
     auto & pool = get_rpm_pool(base);
 
     Solvable * solvable = pool.id2solvable(id.id);
-    libdnf5::solv::get_repo(solvable).internalize();
+    auto & repo = libdnf5::solv::get_repo(solvable);
+    // the complete file list may not be loaded yet (the `lazy_filelists` option)
+    repo.load_filelists();
+    repo.internalize();
 
     std::vector<std::string> ret;
 
@@ -188,6 +197,55 @@ std::vector<std::string> Package::get_files() const {
     return ret;
 }
 
+// Reads the changelog entries of an installed package from its header in the rpm database.
+// rpm::Transaction is not used, its log guard would deadlock when called while a transaction is running.
+static std::vector<libdnf5::rpm::Changelog> read_rpmdb_changelogs(const std::string & rootdir, unsigned int rpmdbid) {
+    std::vector<libdnf5::rpm::Changelog> changelogs;
+
+    auto * ts = rpmtsCreate();
+    libdnf5::utils::OnScopeExit free_ts([ts]() noexcept { rpmtsFree(ts); });
+    if (rpmtsSetRootDir(ts, rootdir.c_str()) != 0) {
+        return changelogs;
+    }
+
+    // rpmdbid must be unsigned int
+    auto * iter = rpmtsInitIterator(ts, RPMDBI_PACKAGES, &rpmdbid, sizeof(rpmdbid));
+    if (!iter) {
+        return changelogs;
+    }
+    libdnf5::utils::OnScopeExit free_iter([iter]() noexcept { rpmdbFreeIterator(iter); });
+    Header hdr = rpmdbNextIterator(iter);
+    if (!hdr) {
+        return changelogs;
+    }
+
+    rpmtd times = rpmtdNew();
+    rpmtd authors = rpmtdNew();
+    rpmtd texts = rpmtdNew();
+    libdnf5::utils::OnScopeExit free_tds([times, authors, texts]() noexcept {
+        rpmtdFree(times);
+        rpmtdFree(authors);
+        rpmtdFree(texts);
+    });
+    if (headerGet(hdr, RPMTAG_CHANGELOGTIME, times, HEADERGET_MINMEM) != 1 ||
+        headerGet(hdr, RPMTAG_CHANGELOGNAME, authors, HEADERGET_MINMEM) != 1 ||
+        headerGet(hdr, RPMTAG_CHANGELOGTEXT, texts, HEADERGET_MINMEM) != 1) {
+        return changelogs;
+    }
+
+    // entries are in the same order as libsolv loads them with RPM_ADD_WITH_CHANGELOG
+    while (rpmtdNext(times) >= 0 && rpmtdNext(authors) >= 0 && rpmtdNext(texts) >= 0) {
+        const auto * timestamp = rpmtdGetUint32(times);
+        const char * author = rpmtdGetString(authors);
+        const char * text = rpmtdGetString(texts);
+        changelogs.emplace_back(
+            timestamp ? static_cast<time_t>(*timestamp) : 0, author ? author : "", text ? text : "");
+    }
+
+    return changelogs;
+}
+
+
 std::vector<libdnf5::rpm::Changelog> Package::get_changelogs() const {
     std::vector<libdnf5::rpm::Changelog> changelogs;
     auto & pool = get_rpm_pool(base);
@@ -205,6 +263,26 @@ std::vector<libdnf5::rpm::Changelog> Package::get_changelogs() const {
     }
     dataiterator_free(&di);
 
+    // changelogs of the installed packages are not loaded into the pool, they are read on demand
+    // from the rpmdb the package was loaded from, the result (also an empty one) is cached in the sack
+    if (changelogs.empty() && is_installed()) {
+        auto & sack_impl = *base->get_rpm_package_sack()->p_impl;
+        auto & cached_changelogs = sack_impl.cached_rpmdb_changelogs;
+        // the ids of freed solvables are reused by other packages
+        if (sack_impl.cached_rpmdb_changelogs_generation != pool.get_solvables_generation()) {
+            cached_changelogs.clear();
+            sack_impl.cached_rpmdb_changelogs_generation = pool.get_solvables_generation();
+        }
+        auto [it, inserted] = cached_changelogs.try_emplace(id.id);
+        if (inserted) {
+            if (auto rpmdbid = static_cast<unsigned int>(get_rpmdbid())) {
+                auto & solv_repo = *libdnf5::solv::get_repo(solvable).solv_repo;
+                it->second = read_rpmdb_changelogs(solv_repo.get_rpmdb_rootdir(id.id), rpmdbid);
+            }
+        }
+        changelogs = it->second;
+    }
+
     return changelogs;
 }
 
@@ -322,6 +400,10 @@ bool Package::is_available_locally() const {
         if (repo->get_type() == repo::Repo::Type::COMMANDLINE || is_cached()) {
             return true;
         }
+        // the package is linked from the package store when downloading
+        if (repo::PackageStore(base).contains(*this)) {
+            return true;
+        }
     }
     return false;
 }
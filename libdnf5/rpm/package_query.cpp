@@ -39,12 +39,71 @@ extern "C" {
 
 #include <fnmatch.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
 
 namespace libdnf5::rpm {
 
 namespace {
 
+// Comparison types supported by the filters, they are checked before a filter is deferred.
+constexpr std::array STRING_CMP_TYPES{
+    sack::QueryCmp::EQ,
+    sack::QueryCmp::IEXACT,
+    sack::QueryCmp::GLOB,
+    sack::QueryCmp::IGLOB,
+    sack::QueryCmp::CONTAINS,
+    sack::QueryCmp::ICONTAINS};
+constexpr std::array GLOB_CMP_TYPES{sack::QueryCmp::EQ, sack::QueryCmp::GLOB};
+constexpr std::array EQ_CMP_TYPES{sack::QueryCmp::EQ};
+constexpr std::array EQ_NEQ_CMP_TYPES{sack::QueryCmp::EQ, sack::QueryCmp::NEQ};
+constexpr std::array EVR_CMP_TYPES{
+    sack::QueryCmp::EQ, sack::QueryCmp::GT, sack::QueryCmp::LT, sack::QueryCmp::GTE, sack::QueryCmp::LTE};
+constexpr std::array EVR_STRING_CMP_TYPES{
+    sack::QueryCmp::EQ,
+    sack::QueryCmp::GLOB,
+    sack::QueryCmp::GT,
+    sack::QueryCmp::LT,
+    sack::QueryCmp::GTE,
+    sack::QueryCmp::LTE};
+constexpr std::array NEVRA_STRING_CMP_TYPES{
+    sack::QueryCmp::EQ,
+    sack::QueryCmp::IEXACT,
+    sack::QueryCmp::GLOB,
+    sack::QueryCmp::IGLOB,
+    sack::QueryCmp::GT,
+    sack::QueryCmp::LT,
+    sack::QueryCmp::GTE,
+    sack::QueryCmp::LTE};
+constexpr std::array NEVRA_PART_CMP_TYPES{
+    sack::QueryCmp::EQ, sack::QueryCmp::IEXACT, sack::QueryCmp::GLOB, sack::QueryCmp::IGLOB};
+
+// Costs of the deferred filters, the filters with a lower cost are run first.
+// The filters on repositories test only the repo of a solvable, the filters on names, architectures and evrs
+// compare pool strings (name filters use the sorted solvables of the sack). The location and sourcerpm are
+// looked up in the repodata. The provides are matched using the whatprovides index, the other dependencies
+// of every candidate are matched one by one, the globs are first expanded to all matching dependencies.
+// The filters on files and texts search the repodata using the dataiterator and may load the filelists.
+constexpr unsigned int FILTER_COST_REPO = 0;
+constexpr unsigned int FILTER_COST_NAME = 1;
+constexpr unsigned int FILTER_COST_EVR = 2;
+constexpr unsigned int FILTER_COST_LOOKUP = 3;
+constexpr unsigned int FILTER_COST_PROVIDES = 4;
+constexpr unsigned int FILTER_COST_RELDEP = 5;
+constexpr unsigned int FILTER_COST_RELDEP_GLOB = 6;
+constexpr unsigned int FILTER_COST_DATAITERATOR = 7;
+
+unsigned int get_reldep_patterns_cost(unsigned int cost, libdnf5::sack::QueryCmp cmp_type) {
+    return (cmp_type & libdnf5::sack::QueryCmp::GLOB) == libdnf5::sack::QueryCmp::GLOB ? FILTER_COST_RELDEP_GLOB
+                                                                                      : cost;
+}
+
 
 inline bool is_valid_candidate(libdnf5::sack::QueryCmp cmp_type, const char * c_pattern, const char * candidate) {
     switch (cmp_type) {
@@ -123,6 +182,49 @@ inline libdnf5::sack::QueryCmp remove_glob_when_unneeded(
     return cmp_type;
 }
 
+inline bool is_cmp_type_supported(
+    libdnf5::sack::QueryCmp cmp_type, std::span<const libdnf5::sack::QueryCmp> supported_cmp_types) {
+    return std::find(supported_cmp_types.begin(), supported_cmp_types.end(), cmp_type) != supported_cmp_types.end();
+}
+
+/// Checks the comparison type of a filter before the filter is deferred, the error is reported by the call.
+void check_cmp_type(libdnf5::sack::QueryCmp cmp_type, std::span<const libdnf5::sack::QueryCmp> supported_cmp_types) {
+    if (!is_cmp_type_supported(cmp_type, supported_cmp_types)) {
+        libdnf_throw_assert_unsupported_query_cmp_type(cmp_type);
+    }
+}
+
+/// Checks the comparison type of a filter that compares the `patterns` one by one, the same way as the filter does:
+/// without the NOT flag and with GLOB replaced by EQ for the patterns that are not globs.
+void check_patterns_cmp_type(
+    libdnf5::sack::QueryCmp cmp_type,
+    const std::vector<std::string> & patterns,
+    std::span<const libdnf5::sack::QueryCmp> supported_cmp_types) {
+    cmp_type = cmp_type - libdnf5::sack::QueryCmp::NOT;
+    bool cmp_glob = (cmp_type & libdnf5::sack::QueryCmp::GLOB) == libdnf5::sack::QueryCmp::GLOB;
+    for (auto & pattern : patterns) {
+        auto tmp_cmp_type = remove_glob_when_unneeded(cmp_type, pattern.c_str(), cmp_glob);
+        if (!is_cmp_type_supported(tmp_cmp_type, supported_cmp_types)) {
+            libdnf_throw_assert_unsupported_query_cmp_type(cmp_type);
+        }
+    }
+}
+
+/// Checks the comparison type of a filter by a `Nevra`, the same way as `PQImpl::filter_nevra()` compares its parts.
+void check_nevra_cmp_type(libdnf5::sack::QueryCmp cmp_type, const libdnf5::rpm::Nevra & pattern) {
+    bool cmp_glob = (cmp_type & libdnf5::sack::QueryCmp::GLOB) == libdnf5::sack::QueryCmp::GLOB;
+    std::vector<std::string> parts;
+    if (!pattern.get_name().empty()) {
+        parts.push_back(pattern.get_name());
+    }
+    for (auto * part : {&pattern.get_epoch(), &pattern.get_version(), &pattern.get_release(), &pattern.get_arch()}) {
+        if (!part->empty() && !(cmp_glob && *part == "*")) {
+            parts.push_back(*part);
+        }
+    }
+    check_patterns_cmp_type(cmp_type, parts, NEVRA_PART_CMP_TYPES);
+}
+
 /**
  * Return id of a package that can be upgraded with pkg.
  *
@@ -211,10 +313,14 @@ Id what_downgrades(libdnf5::solv::RpmPool & spool, const Solvable * solvable) {
     return l;
 }
 
-inline bool name_compare_lower_id(const Solvable * first, Id id_name) {
-    return first->name < id_name;
+/// Return the literal beginning of the glob `pattern` (without the FNM_NOESCAPE flag), all strings matching
+/// the pattern start with it.
+std::string_view get_glob_prefix(const char * pattern) {
+    return std::string_view(pattern, std::strcspn(pattern, "*?[\\"));
 }
 
+using SolvableIterator = std::vector<Solvable *>::const_iterator;
+
 inline bool name_compare_icase_lower_id(const std::pair<Id, Solvable *> first, Id id_name) {
     return first.first < id_name;
 }
@@ -400,6 +506,7 @@ PackageQuery::PackageQuery(const BaseWeakPtr & base, ExcludeFlags flags, bool em
     : PackageSet(base),
       p_pq_impl(new PQImpl) {
     p_pq_impl->flags = flags;
+    p_impl->make_dense();
 
     if (!empty) {
         *p_impl |= base->get_rpm_package_sack()->p_impl->get_solvables();
@@ -453,10 +560,96 @@ PackageQuery & PackageQuery::operator=(const PackageQuery & src) {
     return *this;
 }
 
-PackageQuery & PackageQuery::operator=(PackageQuery && src) noexcept = default;
+// The content is swapped, the deferred filters move with it and are not run in the noexcept assignment.
+PackageQuery & PackageQuery::operator=(PackageQuery && src) noexcept {
+    swap(src);
+    return *this;
+}
 
 PackageQuery::~PackageQuery() = default;
 
+void PackageQuery::set_defer_filters(bool defer) {
+    p_pq_impl->defer_filters = defer;
+}
+
+bool PackageQuery::get_defer_filters() const noexcept {
+    return p_pq_impl->defer_filters;
+}
+
+bool PackageQuery::empty() const {
+    p_impl->run_deferred_filters();
+    return PackageSet::empty();
+}
+
+std::size_t PackageQuery::size() const {
+    p_impl->run_deferred_filters();
+    return PackageSet::size();
+}
+
+bool PackageQuery::contains(const Package & pkg) const {
+    p_impl->run_deferred_filters();
+    return PackageSet::contains(pkg);
+}
+
+bool PackageQuery::PQImpl::should_defer_filter(PackageQuery & query) {
+    if (!query.p_pq_impl->defer_filters) {
+        prepare_filtering(query);
+        return false;
+    }
+    return true;
+}
+
+void PackageQuery::PQImpl::defer_filter(
+    PackageQuery & query, unsigned int cost, std::function<void(PackageQuery & query)> && filter) {
+    query.p_impl->add_deferred_filter(cost, std::move(filter));
+}
+
+std::shared_ptr<const PackageSet> PackageQuery::PQImpl::share_package_set(const PackageSet & package_set) {
+    return std::make_shared<PackageSet>(package_set);
+}
+
+void PackageQuery::PQImpl::prepare_filtering(PackageQuery & query) {
+    query.p_impl->run_deferred_filters();
+    query.p_impl->make_dense();
+}
+
+// Serializes running the deferred filters of the queries, the const readers of a query run them.
+// The lock is recursive, a filter may access other queries.
+static std::recursive_mutex deferred_filters_mutex;
+
+void PackageSet::Impl::run_deferred_filters() {
+    if (!has_deferred_filters()) {
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> guard(deferred_filters_mutex);
+    if (has_deferred_filters()) {
+        apply_deferred_filters();
+    }
+}
+
+void PackageSet::Impl::apply_deferred_filters() {
+    std::stable_sort(
+        deferred_filters.begin(), deferred_filters.end(), [](const DeferredFilter & lhs, const DeferredFilter & rhs) {
+            return lhs.cost < rhs.cost;
+        });
+
+    // The filters are run immediately on a query with a copy of the content of the set, they do not depend
+    // on the exclude flags of the query that recorded them. The set and its filters are replaced only when
+    // all the filters succeed, if one of them throws (e.g. loading the filelists fails), the exception
+    // is propagated to the access and the next access runs them again.
+    PackageQuery query(base, PackageQuery::ExcludeFlags::IGNORE_EXCLUDES, true);
+    auto & query_impl = *query.p_impl;
+    if (sparse) {
+        query_impl = build_dense_map();
+    } else {
+        query_impl = static_cast<const libdnf5::solv::SolvMap &>(*this);
+    }
+    for (auto & filter : deferred_filters) {
+        filter.run(query);
+    }
+    *this = std::move(query_impl);
+}
+
 template <const char * (libdnf5::solv::Pool::*getter)(Id) const>
 inline static void filter_glob_internal(
     libdnf5::solv::Pool & pool,
@@ -473,10 +666,16 @@ inline static void filter_glob_internal(
 }
 
 void PackageQuery::filter_name(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_name(patterns, cmp_type);
+        });
+        return;
+    }
     auto & pool = get_rpm_pool(p_impl->base);
     auto sack = p_impl->base->get_rpm_package_sack();
     libdnf5::solv::SolvMap filter_result(pool.get_nsolvables());
-    auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
 
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
@@ -500,11 +699,9 @@ void PackageQuery::filter_name(const std::vector<std::string> & patterns, libdnf
                 if (name_id == 0) {
                     continue;
                 }
-                auto low =
-                    std::lower_bound(sorted_solvables.begin(), sorted_solvables.end(), name_id, name_compare_lower_id);
-                while (low != sorted_solvables.end() && (*low)->name == name_id) {
-                    filter_result.add_unsafe(pool.solvable2id(*low));
-                    ++low;
+                auto [begin, end] = sack->p_impl->get_sorted_solvables_by_name(name_id);
+                for (auto it = begin; it != end; ++it) {
+                    filter_result.add_unsafe(pool.solvable2id(*it));
                 }
             } break;
             case libdnf5::sack::QueryCmp::IEXACT: {
@@ -544,7 +741,7 @@ void PackageQuery::filter_name(const std::vector<std::string> & patterns, libdnf
                 }
             } break;
             case libdnf5::sack::QueryCmp::GLOB:
-                filter_glob_internal<&libdnf5::solv::RpmPool::get_name>(pool, c_pattern, *p_impl, filter_result, 0);
+                PQImpl::filter_name_glob(*this, c_pattern, filter_result);
                 break;
             default:
                 libdnf_throw_assert_unsupported_query_cmp_type(cmp_type);
@@ -563,21 +760,29 @@ void PackageQuery::filter_name(const PackageSet & package_set, libdnf5::sack::Qu
     if (cmp_type != sack::QueryCmp::EQ && cmp_type != sack::QueryCmp::NEQ) {
         libdnf_throw_assert_unsupported_query_cmp_type(cmp_type);
     }
+    libdnf_assert_same_base(p_impl->base, package_set.get_base());
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_name(*shared_set, cmp_type);
+        });
+        return;
+    }
     auto sack = p_impl->base->get_rpm_package_sack();
     auto & pool = get_rpm_pool(p_impl->base);
     libdnf5::solv::SolvMap filter_result(sack->get_nsolvables());
 
-    libdnf_assert_same_base(p_impl->base, package_set.get_base());
-
-    auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
-
-    for (Id pattern_id : *package_set.p_impl) {
+    PackageSet::Impl::DenseMapView patterns(*package_set.p_impl);
+    Id previous_name_id = 0;
+    for (Id pattern_id : *patterns) {
         Id pattern_name_id = pool.id2solvable(pattern_id)->name;
-        auto low =
-            std::lower_bound(sorted_solvables.begin(), sorted_solvables.end(), pattern_name_id, name_compare_lower_id);
-        while (low != sorted_solvables.end() && (*low)->name == pattern_name_id) {
-            filter_result.add_unsafe(pool.solvable2id(*low));
-            ++low;
+        if (pattern_name_id == previous_name_id) {
+            continue;
+        }
+        previous_name_id = pattern_name_id;
+        auto [begin, end] = sack->p_impl->get_sorted_solvables_by_name(pattern_name_id);
+        for (auto it = begin; it != end; ++it) {
+            filter_result.add_unsafe(pool.solvable2id(*it));
         }
     }
 
@@ -593,20 +798,24 @@ void PackageQuery::filter_name_arch(const PackageSet & package_set, libdnf5::sac
     if (cmp_type != sack::QueryCmp::EQ && cmp_type != sack::QueryCmp::NEQ) {
         libdnf_throw_assert_unsupported_query_cmp_type(cmp_type);
     }
+    libdnf_assert_same_base(p_impl->base, package_set.get_base());
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_name_arch(*shared_set, cmp_type);
+        });
+        return;
+    }
     auto sack = p_impl->base->get_rpm_package_sack();
     auto & pool = get_rpm_pool(p_impl->base);
     libdnf5::solv::SolvMap filter_result(sack->get_nsolvables());
 
-    libdnf_assert_same_base(p_impl->base, package_set.get_base());
-
-    auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
-
-    for (Id pattern_id : *package_set.p_impl) {
+    PackageSet::Impl::DenseMapView patterns(*package_set.p_impl);
+    for (Id pattern_id : *patterns) {
         Solvable * pattern_solvable = pool.id2solvable(pattern_id);
-        auto low = std::lower_bound(
-            sorted_solvables.begin(), sorted_solvables.end(), pattern_solvable, name_arch_compare_lower<Solvable>);
-        while (low != sorted_solvables.end() && (*low)->name == pattern_solvable->name &&
-               (*low)->arch == pattern_solvable->arch) {
+        auto [begin, end] = sack->p_impl->get_sorted_solvables_by_name(pattern_solvable->name);
+        auto low = std::lower_bound(begin, end, pattern_solvable, name_arch_compare_lower<Solvable>);
+        while (low != end && (*low)->arch == pattern_solvable->arch) {
             filter_result.add_unsafe(pool.solvable2id(*low));
             ++low;
         }
@@ -659,6 +868,13 @@ inline static void filter_evr_internal(
 }
 
 void PackageQuery::filter_evr(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EVR_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_EVR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_evr(patterns, cmp_type);
+        });
+        return;
+    }
     auto & pool = get_rpm_pool(p_impl->base);
     switch (cmp_type) {
         case libdnf5::sack::QueryCmp::GT:
@@ -682,6 +898,13 @@ void PackageQuery::filter_evr(const std::vector<std::string> & patterns, libdnf5
 }
 
 void PackageQuery::filter_arch(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_arch(patterns, cmp_type);
+        });
+        return;
+    }
     auto & pool = get_rpm_pool(p_impl->base);
     libdnf5::solv::SolvMap filter_result(pool.get_nsolvables());
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
@@ -820,16 +1043,16 @@ static inline bool nevra_compare_lower_id(const Solvable * first, const NevraID
     return first->evr < nevra_id.evr;
 }
 
+/// @param begin, end  The range of the sorted solvables with the name of the `pattern_solvable`.
 template <bool (*cmp_fnc)(int value_to_cmp)>
 inline static void filter_nevra_internal_solvable(
     libdnf5::solv::RpmPool & pool,
     Solvable * pattern_solvable,
-    const std::vector<Solvable *> & sorted_solvables,
+    SolvableIterator begin,
+    SolvableIterator end,
     libdnf5::solv::SolvMap & filter_result) {
-    auto low = std::lower_bound(
-        sorted_solvables.begin(), sorted_solvables.end(), pattern_solvable, name_arch_compare_lower<Solvable>);
-    while (low != sorted_solvables.end() && (*low)->name == pattern_solvable->name &&
-           (*low)->arch == pattern_solvable->arch) {
+    auto low = std::lower_bound(begin, end, pattern_solvable, name_arch_compare_lower<Solvable>);
+    while (low != end && (*low)->arch == pattern_solvable->arch) {
         int cmp = pool.evrcmp((*low)->evr, pattern_solvable->evr, EVRCMP_COMPARE);
         if (cmp_fnc(cmp)) {
             filter_result.add_unsafe(pool.solvable2id(*low));
@@ -838,19 +1061,16 @@ inline static void filter_nevra_internal_solvable(
     }
 }
 
+/// @param begin, end  The range of the sorted solvables with the name of the `nevra_id`.
 template <bool (*cmp_fnc)(int value_to_cmp)>
 inline static void filter_nevra_internal_str(
     libdnf5::solv::RpmPool & pool,
-    const char * c_pattern,
-    const std::vector<Solvable *> & sorted_solvables,
+    const NevraID & nevra_id,
+    SolvableIterator begin,
+    SolvableIterator end,
     libdnf5::solv::SolvMap & filter_result) {
-    NevraID nevra_id;
-    if (!nevra_id.parse(pool, c_pattern, false)) {
-        return;
-    }
-    auto low =
-        std::lower_bound(sorted_solvables.begin(), sorted_solvables.end(), &nevra_id, name_arch_compare_lower<NevraID>);
-    while (low != sorted_solvables.end() && (*low)->name == nevra_id.name && (*low)->arch == nevra_id.arch) {
+    auto low = std::lower_bound(begin, end, &nevra_id, name_arch_compare_lower<NevraID>);
+    while (low != end && (*low)->arch == nevra_id.arch) {
         int cmp = pool.evrcmp_str(pool.id2str((*low)->evr), nevra_id.evr_str.c_str(), EVRCMP_COMPARE);
         if (cmp_fnc(cmp)) {
             filter_result.add_unsafe(pool.solvable2id(*low));
@@ -862,6 +1082,13 @@ inline static void filter_nevra_internal_str(
 }  // namespace
 
 void PackageQuery::filter_nevra(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, NEVRA_STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_nevra(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -873,10 +1100,8 @@ void PackageQuery::filter_nevra(const std::vector<std::string> & patterns, libdn
     auto sack = p_impl->base->get_rpm_package_sack();
     libdnf5::solv::SolvMap filter_result(sack->p_impl->get_nsolvables());
 
-    auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
-
     for (auto & pattern : patterns) {
-        PQImpl::filter_nevra(*this, sorted_solvables, pattern, cmp_glob, cmp_type, filter_result);
+        PQImpl::filter_nevra(*this, pattern, cmp_glob, cmp_type, filter_result);
     }
 
     // Apply filter results to query
@@ -888,6 +1113,13 @@ void PackageQuery::filter_nevra(const std::vector<std::string> & patterns, libdn
 }
 
 void PackageQuery::filter_nevra(const libdnf5::rpm::Nevra & pattern, libdnf5::sack::QueryCmp cmp_type) {
+    check_nevra_cmp_type(cmp_type, pattern);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [pattern, cmp_type](PackageQuery & query) {
+            query.filter_nevra(pattern, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -910,6 +1142,14 @@ void PackageQuery::filter_nevra(const libdnf5::rpm::Nevra & pattern, libdnf5::sa
 
 void PackageQuery::filter_nevra(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
     libdnf_assert_same_base(p_impl->base, package_set.get_base());
+    check_cmp_type(cmp_type - libdnf5::sack::QueryCmp::NOT, EVR_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_NAME, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_nevra(*shared_set, cmp_type);
+        });
+        return;
+    }
 
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
@@ -920,43 +1160,47 @@ void PackageQuery::filter_nevra(const PackageSet & package_set, libdnf5::sack::Q
     auto & pool = get_rpm_pool(p_impl->base);
     libdnf5::solv::SolvMap filter_result(sack->p_impl->get_nsolvables());
 
-    auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
+    auto & sack_impl = *sack->p_impl;
+    PackageSet::Impl::DenseMapView patterns(*package_set.p_impl);
 
     switch (cmp_type) {
         case libdnf5::sack::QueryCmp::EQ: {
-            for (Id pattern_id : *package_set.p_impl) {
+            for (Id pattern_id : *patterns) {
                 Solvable * pattern_solvable = pool.id2solvable(pattern_id);
-                auto low = std::lower_bound(
-                    sorted_solvables.begin(), sorted_solvables.end(), pattern_solvable, nevra_solvable_cmp_key);
-                while (low != sorted_solvables.end() && (*low)->name == pattern_solvable->name &&
-                       (*low)->arch == pattern_solvable->arch && (*low)->evr == pattern_solvable->evr) {
+                auto [begin, end] = sack_impl.get_sorted_solvables_by_name(pattern_solvable->name);
+                auto low = std::lower_bound(begin, end, pattern_solvable, nevra_solvable_cmp_key);
+                while (low != end && (*low)->arch == pattern_solvable->arch && (*low)->evr == pattern_solvable->evr) {
                     filter_result.add_unsafe(pool.solvable2id(*low));
                     ++low;
                 }
             }
         } break;
         case libdnf5::sack::QueryCmp::GT: {
-            for (Id pattern_id : *package_set.p_impl) {
+            for (Id pattern_id : *patterns) {
                 Solvable * pattern_solvable = pool.id2solvable(pattern_id);
-                filter_nevra_internal_solvable<cmp_gt>(pool, pattern_solvable, sorted_solvables, filter_result);
+                auto [begin, end] = sack_impl.get_sorted_solvables_by_name(pattern_solvable->name);
+                filter_nevra_internal_solvable<cmp_gt>(pool, pattern_solvable, begin, end, filter_result);
             }
         } break;
         case libdnf5::sack::QueryCmp::GTE: {
-            for (Id pattern_id : *package_set.p_impl) {
+            for (Id pattern_id : *patterns) {
                 Solvable * pattern_solvable = pool.id2solvable(pattern_id);
-                filter_nevra_internal_solvable<cmp_gte>(pool, pattern_solvable, sorted_solvables, filter_result);
+                auto [begin, end] = sack_impl.get_sorted_solvables_by_name(pattern_solvable->name);
+                filter_nevra_internal_solvable<cmp_gte>(pool, pattern_solvable, begin, end, filter_result);
             }
         } break;
         case libdnf5::sack::QueryCmp::LT: {
-            for (Id pattern_id : *package_set.p_impl) {
+            for (Id pattern_id : *patterns) {
                 Solvable * pattern_solvable = pool.id2solvable(pattern_id);
-                filter_nevra_internal_solvable<cmp_lt>(pool, pattern_solvable, sorted_solvables, filter_result);
+                auto [begin, end] = sack_impl.get_sorted_solvables_by_name(pattern_solvable->name);
+                filter_nevra_internal_solvable<cmp_lt>(pool, pattern_solvable, begin, end, filter_result);
             }
         } break;
         case libdnf5::sack::QueryCmp::LTE: {
-            for (Id pattern_id : *package_set.p_impl) {
+            for (Id pattern_id : *patterns) {
                 Solvable * pattern_solvable = pool.id2solvable(pattern_id);
-                filter_nevra_internal_solvable<cmp_lte>(pool, pattern_solvable, sorted_solvables, filter_result);
+                auto [begin, end] = sack_impl.get_sorted_solvables_by_name(pattern_solvable->name);
+                filter_nevra_internal_solvable<cmp_lte>(pool, pattern_solvable, begin, end, filter_result);
             }
         } break;
         default:
@@ -990,6 +1234,13 @@ inline static void filter_version_internal(
 }
 
 void PackageQuery::filter_version(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, EVR_STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_EVR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_version(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1058,6 +1309,13 @@ inline static void filter_release_internal(
 }
 
 void PackageQuery::filter_release(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, EVR_STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_EVR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_release(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1108,6 +1366,13 @@ void PackageQuery::filter_release(const std::vector<std::string> & patterns, lib
 }
 
 void PackageQuery::filter_repo_id(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_REPO, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_repo_id(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1168,6 +1433,13 @@ void PackageQuery::filter_repo_id(const std::vector<std::string> & patterns, lib
 }
 
 void PackageQuery::filter_sourcerpm(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_LOOKUP, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_sourcerpm(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1226,6 +1498,13 @@ void PackageQuery::filter_sourcerpm(const std::vector<std::string> & patterns, l
 }
 
 void PackageQuery::filter_epoch(const std::vector<unsigned long> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type - libdnf5::sack::QueryCmp::NOT, EVR_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_EVR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_epoch(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1299,6 +1578,13 @@ void PackageQuery::filter_epoch(const std::vector<unsigned long> & patterns, lib
 }
 
 void PackageQuery::filter_epoch(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_EVR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_epoch(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1426,22 +1712,59 @@ static void filter_dataiterator_internal(
 }
 
 void PackageQuery::filter_file(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        // The filelists are loaded when the filter is run, only for the packages left by the cheaper filters.
+        PQImpl::defer_filter(*this, FILTER_COST_DATAITERATOR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_file(patterns, cmp_type);
+        });
+        return;
+    }
+    p_impl->base->get_rpm_package_sack()->p_impl->load_filelists(p_impl.get());
     filter_dataiterator_internal(*get_rpm_pool(p_impl->base), SOLVABLE_FILELIST, *p_impl, cmp_type, patterns);
 }
 
 void PackageQuery::filter_description(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_DATAITERATOR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_description(patterns, cmp_type);
+        });
+        return;
+    }
     filter_dataiterator_internal(*get_rpm_pool(p_impl->base), SOLVABLE_DESCRIPTION, *p_impl, cmp_type, patterns);
 }
 
 void PackageQuery::filter_summary(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_DATAITERATOR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_summary(patterns, cmp_type);
+        });
+        return;
+    }
     filter_dataiterator_internal(*get_rpm_pool(p_impl->base), SOLVABLE_SUMMARY, *p_impl, cmp_type, patterns);
 }
 
 void PackageQuery::filter_url(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, STRING_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_DATAITERATOR, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_url(patterns, cmp_type);
+        });
+        return;
+    }
     filter_dataiterator_internal(*get_rpm_pool(p_impl->base), SOLVABLE_URL, *p_impl, cmp_type, patterns);
 }
 
 void PackageQuery::filter_location(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type - libdnf5::sack::QueryCmp::NOT, EQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_LOOKUP, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_location(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1477,6 +1800,13 @@ void PackageQuery::filter_location(const std::vector<std::string> & patterns, li
 }
 
 void PackageQuery::filter_provides(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type - libdnf5::sack::QueryCmp::NOT, EQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_PROVIDES, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_provides(reldep_list, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1498,6 +1828,13 @@ void PackageQuery::filter_provides(const ReldepList & reldep_list, libdnf5::sack
 }
 
 void PackageQuery::filter_provides(const Reldep & reldep, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type - libdnf5::sack::QueryCmp::NOT, EQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_PROVIDES, [reldep, cmp_type](PackageQuery & query) {
+            query.filter_provides(reldep, cmp_type);
+        });
+        return;
+    }
     libdnf5::rpm::ReldepList reldep_list{p_impl->base};
     reldep_list.add(reldep.get_id());
     filter_provides(reldep_list, cmp_type);
@@ -1537,6 +1874,14 @@ void PackageQuery::PQImpl::str2reldep_internal(
 }
 
 void PackageQuery::filter_provides(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_PROVIDES, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_provides(patterns, cmp_type);
+        });
+        return;
+    }
     bool cmp_not = (cmp_type & libdnf5::sack::QueryCmp::NOT) == libdnf5::sack::QueryCmp::NOT;
     if (cmp_not) {
         // Removal of NOT CmpType makes following comparisons easier and effective
@@ -1670,7 +2015,8 @@ void PackageQuery::PQImpl::filter_reldep(
 
     libdnf5::solv::IdQueue out;
 
-    for (auto package_id : *package_set.p_impl) {
+    PackageSet::Impl::DenseMapView packages(*package_set.p_impl);
+    for (auto package_id : *packages) {
         out.clear();
 
         // queue_push2 because we are creating a selection, which contains pairs
@@ -1699,6 +2045,37 @@ void PackageQuery::PQImpl::filter_reldep(
     }
 }
 
+void PackageQuery::PQImpl::filter_name_glob(
+    PackageSet & pkg_set, const char * pattern, libdnf5::solv::SolvMap & filter_result) {
+    auto base = pkg_set.get_base();
+    auto & pool = get_rpm_pool(base);
+    auto & sack = *base->get_rpm_package_sack()->p_impl;
+    const auto & candidates = *pkg_set.p_impl;
+
+    auto prefix = get_glob_prefix(pattern);
+    if (!prefix.empty()) {
+        auto [names_begin, names_end] = sack.get_names_with_prefix(prefix);
+        if (static_cast<std::size_t>(names_end - names_begin) < candidates.size()) {
+            for (auto name_it = names_begin; name_it != names_end; ++name_it) {
+                if (fnmatch(pattern, pool.id2str(*name_it), 0) != 0) {
+                    continue;
+                }
+                auto [begin, end] = sack.get_sorted_solvables_by_name(*name_it);
+                for (auto it = begin; it != end; ++it) {
+                    filter_result.add_unsafe(pool.solvable2id(*it));
+                }
+            }
+            return;
+        }
+    }
+
+    for (Id candidate_id : candidates) {
+        if (fnmatch(pattern, pool.get_name(candidate_id), 0) == 0) {
+            filter_result.add_unsafe(candidate_id);
+        }
+    }
+}
+
 void PackageQuery::PQImpl::filter_nevra(
     PackageSet & pkg_set,
     const Nevra & pattern,
@@ -1742,17 +2119,14 @@ void PackageQuery::PQImpl::filter_nevra(
     Id src = with_src ? 0 : pool.str2id("src", false);
 
     if (!name.empty()) {
-        auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
-
         switch (name_cmp_type) {
             case libdnf5::sack::QueryCmp::EQ: {
                 Id name_id = pool.str2id(name_c_pattern, false);
                 if (name_id == 0) {
                     break;
                 }
-                auto low =
-                    std::lower_bound(sorted_solvables.begin(), sorted_solvables.end(), name_id, name_compare_lower_id);
-                while (low != sorted_solvables.end() && (*low)->name == name_id) {
+                auto [low, end] = sack->p_impl->get_sorted_solvables_by_name(name_id);
+                while (low != end) {
                     Id candidate_id = pool.solvable2id(*low);
                     if (!is_valid_candidate(
                             pool,
@@ -1814,12 +2188,14 @@ void PackageQuery::PQImpl::filter_nevra(
                 }
             } break;
             case libdnf5::sack::QueryCmp::GLOB: {
-                for (Id candidate_id : *pkg_set.p_impl) {
-                    const char * candidate_name = pool.get_name(candidate_id);
-                    if (!all_names && fnmatch(name_c_pattern, candidate_name, 0) != 0) {
-                        continue;
-                    }
-
+                // packages whose name matches the glob, they may include packages that are not candidates
+                libdnf5::solv::SolvMap name_matches(pool.get_nsolvables());
+                if (all_names) {
+                    name_matches = *pkg_set.p_impl;
+                } else {
+                    filter_name_glob(pkg_set, name_c_pattern, name_matches);
+                }
+                for (Id candidate_id : name_matches) {
                     if (!is_valid_candidate(
                             pool,
                             candidate_id,
@@ -1902,7 +2278,6 @@ void PackageQuery::PQImpl::filter_nevra(
 
 void PackageQuery::PQImpl::filter_nevra(
     PackageSet & pkg_set,
-    const std::vector<Solvable *> & sorted_solvables,
     const std::string & pattern,
     bool cmp_glob,
     libdnf5::sack::QueryCmp cmp_type,
@@ -1915,6 +2290,7 @@ void PackageQuery::PQImpl::filter_nevra(
     }
 
     libdnf5::solv::RpmPool & pool = get_rpm_pool(pkg_set.get_base());
+    auto & sack = *pkg_set.get_base()->get_rpm_package_sack()->p_impl;
 
     switch (tmp_cmp_type) {
         case libdnf5::sack::QueryCmp::EQ: {
@@ -1922,26 +2298,32 @@ void PackageQuery::PQImpl::filter_nevra(
             if (!nevra_id.parse(pool, c_pattern, true)) {
                 return;
             }
-            auto low =
-                std::lower_bound(sorted_solvables.begin(), sorted_solvables.end(), nevra_id, nevra_compare_lower_id);
-            while (low != sorted_solvables.end() && (*low)->name == nevra_id.name && (*low)->arch == nevra_id.arch &&
-                   (*low)->evr == nevra_id.evr) {
+            auto [begin, end] = sack.get_sorted_solvables_by_name(nevra_id.name);
+            auto low = std::lower_bound(begin, end, nevra_id, nevra_compare_lower_id);
+            while (low != end && (*low)->arch == nevra_id.arch && (*low)->evr == nevra_id.evr) {
                 filter_result.add_unsafe(pool.solvable2id(*low));
                 ++low;
             }
         } break;
         case libdnf5::sack::QueryCmp::GT:
-            filter_nevra_internal_str<cmp_gt>(pool, c_pattern, sorted_solvables, filter_result);
-            break;
         case libdnf5::sack::QueryCmp::LT:
-            filter_nevra_internal_str<cmp_lt>(pool, c_pattern, sorted_solvables, filter_result);
-            break;
         case libdnf5::sack::QueryCmp::GTE:
-            filter_nevra_internal_str<cmp_gte>(pool, c_pattern, sorted_solvables, filter_result);
-            break;
-        case libdnf5::sack::QueryCmp::LTE:
-            filter_nevra_internal_str<cmp_lte>(pool, c_pattern, sorted_solvables, filter_result);
-            break;
+        case libdnf5::sack::QueryCmp::LTE: {
+            NevraID nevra_id;
+            if (!nevra_id.parse(pool, c_pattern, false)) {
+                return;
+            }
+            auto [begin, end] = sack.get_sorted_solvables_by_name(nevra_id.name);
+            if (tmp_cmp_type == libdnf5::sack::QueryCmp::GT) {
+                filter_nevra_internal_str<cmp_gt>(pool, nevra_id, begin, end, filter_result);
+            } else if (tmp_cmp_type == libdnf5::sack::QueryCmp::LT) {
+                filter_nevra_internal_str<cmp_lt>(pool, nevra_id, begin, end, filter_result);
+            } else if (tmp_cmp_type == libdnf5::sack::QueryCmp::GTE) {
+                filter_nevra_internal_str<cmp_gte>(pool, nevra_id, begin, end, filter_result);
+            } else {
+                filter_nevra_internal_str<cmp_lte>(pool, nevra_id, begin, end, filter_result);
+            }
+        } break;
         case libdnf5::sack::QueryCmp::GLOB:
             filter_glob_internal<&libdnf5::solv::RpmPool::get_nevra>(
                 pool, c_pattern, *pkg_set.p_impl, filter_result, 0);
@@ -2030,38 +2412,107 @@ void PackageQuery::PQImpl::filter_sorted_advisory_pkgs(
 }
 
 void PackageQuery::filter_conflicts(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_conflicts(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_CONFLICTS, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_conflicts(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_conflicts(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_CONFLICTS, cmp_type, patterns);
 }
 
 void PackageQuery::filter_conflicts(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_conflicts(*shared_set, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_CONFLICTS, cmp_type, package_set);
 }
 
 void PackageQuery::filter_enhances(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_enhances(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_ENHANCES, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_enhances(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_enhances(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_ENHANCES, cmp_type, patterns);
 }
 
 void PackageQuery::filter_enhances(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_enhances(*shared_set, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_ENHANCES, cmp_type, package_set);
 }
 
 void PackageQuery::filter_obsoletes(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_obsoletes(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_OBSOLETES, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_obsoletes(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_obsoletes(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_OBSOLETES, cmp_type, patterns);
 }
 
 void PackageQuery::filter_obsoletes(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_obsoletes(*shared_set, cmp_type);
+        });
+        return;
+    }
     bool cmp_not;
     switch (cmp_type) {
         case libdnf5::sack::QueryCmp::EQ:
@@ -2083,7 +2534,7 @@ void PackageQuery::filter_obsoletes(const PackageSet & package_set, libdnf5::sac
 
     int obsprovides = pool_get_flag(pool, POOL_FLAG_OBSOLETEUSESPROVIDES);
 
-    auto & target = *package_set.p_impl;
+    PackageSet::Impl::DenseMapView target(*package_set.p_impl);
     for (auto package_id : *p_impl) {
         Solvable * solvable = spool.id2solvable(package_id);
         if (!solvable->repo)
@@ -2093,7 +2544,7 @@ void PackageQuery::filter_obsoletes(const PackageSet & package_set, libdnf5::sac
             Id rr;
 
             FOR_PROVIDES(r, rr, *r_id) {
-                if (!target.contains(r)) {
+                if (!target->contains(r)) {
                     continue;
                 }
                 libdnf_assert(r != SYSTEMSOLVABLE, "Provide is SYSTEMSOLVABLE");
@@ -2116,55 +2567,148 @@ void PackageQuery::filter_obsoletes(const PackageSet & package_set, libdnf5::sac
 }
 
 void PackageQuery::filter_recommends(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_recommends(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_RECOMMENDS, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_recommends(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_recommends(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_RECOMMENDS, cmp_type, patterns);
 }
 
 void PackageQuery::filter_recommends(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_recommends(*shared_set, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_RECOMMENDS, cmp_type, package_set);
 }
 
 void PackageQuery::filter_requires(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_requires(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_REQUIRES, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_requires(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_requires(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_REQUIRES, cmp_type, patterns);
 }
 
 void PackageQuery::filter_requires(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_requires(*shared_set, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_REQUIRES, cmp_type, package_set);
 }
 
 void PackageQuery::filter_suggests(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_suggests(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_SUGGESTS, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_suggests(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_suggests(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_SUGGESTS, cmp_type, patterns);
 }
 
 void PackageQuery::filter_suggests(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_suggests(*shared_set, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_SUGGESTS, cmp_type, package_set);
 }
 
 void PackageQuery::filter_supplements(const ReldepList & reldep_list, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [reldep_list, cmp_type](PackageQuery & query) {
+            query.filter_supplements(reldep_list, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_SUPPLEMENTS, cmp_type, reldep_list);
 }
 
 void PackageQuery::filter_supplements(const std::vector<std::string> & patterns, libdnf5::sack::QueryCmp cmp_type) {
+    check_patterns_cmp_type(cmp_type, patterns, GLOB_CMP_TYPES);
+    auto cost = get_reldep_patterns_cost(FILTER_COST_RELDEP, cmp_type);
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, cost, [patterns, cmp_type](PackageQuery & query) {
+            query.filter_supplements(patterns, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_SUPPLEMENTS, cmp_type, patterns);
 }
 
 void PackageQuery::filter_supplements(const PackageSet & package_set, libdnf5::sack::QueryCmp cmp_type) {
+    check_cmp_type(cmp_type, EQ_NEQ_CMP_TYPES);
+    if (PQImpl::should_defer_filter(*this)) {
+        auto shared_set = PQImpl::share_package_set(package_set);
+        PQImpl::defer_filter(*this, FILTER_COST_RELDEP, [shared_set, cmp_type](PackageQuery & query) {
+            query.filter_supplements(*shared_set, cmp_type);
+        });
+        return;
+    }
     PQImpl::filter_reldep(*this, SOLVABLE_SUPPLEMENTS, cmp_type, package_set);
 }
 
 void PackageQuery::filter_advisories(
     const libdnf5::advisory::AdvisoryQuery & advisory_query, libdnf5::sack::QueryCmp cmp_type) {
+    PQImpl::prepare_filtering(*this);
     std::vector<libdnf5::advisory::AdvisoryPackage> adv_pkgs =
         advisory_query.get_advisory_packages_sorted_by_name_arch_evr();
     PQImpl::filter_sorted_advisory_pkgs(*this, adv_pkgs, cmp_type);
@@ -2174,6 +2718,8 @@ void PackageQuery::filter_latest_unresolved_advisories(
     const libdnf5::advisory::AdvisoryQuery & advisory_query,
     PackageQuery & installed,
     libdnf5::sack::QueryCmp cmp_type) {
+    PQImpl::prepare_filtering(*this);
+    PQImpl::prepare_filtering(installed);
     auto adv_pkgs = advisory_query.get_advisory_packages_sorted_by_name_arch_evr();
     std::vector<libdnf5::advisory::AdvisoryPackage> latest_unresolved_adv_pkgs;
     for (std::vector<libdnf5::advisory::AdvisoryPackage>::iterator i = adv_pkgs.begin(); i != adv_pkgs.end(); ++i) {
@@ -2194,6 +2740,10 @@ void PackageQuery::filter_latest_unresolved_advisories(
 }
 
 void PackageQuery::filter_installed() {
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_REPO, [](PackageQuery & query) { query.filter_installed(); });
+        return;
+    }
     auto & pool = get_rpm_pool(p_impl->base);
     auto * installed_repo = pool->installed;
     if (installed_repo == nullptr) {
@@ -2219,6 +2769,10 @@ void PackageQuery::filter_installed() {
 }
 
 void PackageQuery::filter_available() {
+    if (PQImpl::should_defer_filter(*this)) {
+        PQImpl::defer_filter(*this, FILTER_COST_REPO, [](PackageQuery & query) { query.filter_available(); });
+        return;
+    }
     auto & pool = get_rpm_pool(p_impl->base);
     auto * installed_repo = pool->installed;
     if (installed_repo == nullptr) {
@@ -2239,6 +2793,7 @@ void PackageQuery::filter_available() {
 }
 
 void PackageQuery::filter_upgrades() {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
     auto * installed_repo = pool->installed;
     if (installed_repo == nullptr) {
@@ -2263,6 +2818,7 @@ void PackageQuery::filter_upgrades() {
 }
 
 void PackageQuery::filter_downgrades() {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
     auto * installed_repo = pool->installed;
 
@@ -2286,6 +2842,7 @@ void PackageQuery::filter_downgrades() {
 }
 
 void PackageQuery::filter_upgradable() {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
     auto * installed_repo = pool->installed;
 
@@ -2323,6 +2880,7 @@ void PackageQuery::filter_upgradable() {
 }
 
 void PackageQuery::filter_downgradable() {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
     auto * installed_repo = pool->installed;
 
@@ -2477,10 +3035,12 @@ static void filter_first_sorted_by(
 }
 
 void PackageQuery::filter_latest_evr(int limit) {
+    PQImpl::prepare_filtering(*this);
     filter_first_sorted_by(get_rpm_pool(p_impl->base), limit, latest_cmp, *p_impl);
 }
 
 void PackageQuery::filter_earliest_evr(int limit) {
+    PQImpl::prepare_filtering(*this);
     filter_first_sorted_by(get_rpm_pool(p_impl->base), limit, earliest_cmp, *p_impl);
 }
 
@@ -2495,6 +3055,7 @@ static inline bool priority_solvable_cmp_key(const Solvable * first, const Solva
 }
 
 void PackageQuery::filter_priority() {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
 
     std::vector<Solvable *> sorted_priority;
@@ -2527,6 +3088,7 @@ void PackageQuery::filter_priority() {
 
 std::pair<bool, libdnf5::rpm::Nevra> PackageQuery::resolve_pkg_spec(
     const std::string & pkg_spec, const ResolveSpecSettings & settings, bool with_src) {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
     auto sack = p_impl->base->get_rpm_package_sack();
 
@@ -2556,10 +3118,8 @@ std::pair<bool, libdnf5::rpm::Nevra> PackageQuery::resolve_pkg_spec(
             }
             // When parsed nevra search failed only string with glob can match full nevra
             if (settings.nevra_forms.empty() && glob) {
-                auto & sorted_solvables = sack->p_impl->get_sorted_solvables();
                 PQImpl::filter_nevra(
                     *this,
-                    sorted_solvables,
                     pkg_spec,
                     glob,
                     settings.ignore_case ? (cmp | libdnf5::sack::QueryCmp::ICASE) : cmp,
@@ -2588,6 +3148,7 @@ std::pair<bool, libdnf5::rpm::Nevra> PackageQuery::resolve_pkg_spec(
     }
     auto is_file_pattern = libdnf5::utils::is_file_pattern(pkg_spec);
     if (settings.with_filenames && is_file_pattern) {
+        sack->p_impl->load_filelists(p_impl.get());
         filter_dataiterator(
             *pool,
             SOLVABLE_FILELIST,
@@ -2649,6 +3210,7 @@ void PackageQuery::filter_duplicates() {
     auto & pool = get_rpm_pool(p_impl->base);
 
     filter_installed();
+    PQImpl::prepare_filtering(*this);
 
     libdnf5::solv::IdQueue samename;
     for (Id candidate_id : *p_impl) {
@@ -2683,6 +3245,7 @@ void PackageQuery::filter_duplicates() {
 }
 
 std::vector<std::vector<Package>> PackageQuery::filter_leaves(bool return_grouped_leaves) {
+    PQImpl::prepare_filtering(*this);
     std::vector<std::vector<Package>> grouped_leaves;
     auto & pool = get_rpm_pool(p_impl->base);
 
@@ -2731,6 +3294,7 @@ std::vector<std::vector<Package>> PackageQuery::filter_leaves_groups() {
 }
 
 void PackageQuery::filter_recent(const time_t timestamp) {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
     const unsigned long long time_long = static_cast<unsigned long long>(timestamp);
 
@@ -2747,6 +3311,7 @@ void PackageQuery::filter_userinstalled() {
     auto & pool = get_rpm_pool(p_impl->base);
     libdnf5::solv::SolvMap filter_result(pool.get_nsolvables());
     filter_installed();
+    PQImpl::prepare_filtering(*this);
     for (const auto & pkg : *this) {
         auto reason = pkg.get_reason();
         if (reason != libdnf5::transaction::TransactionItemReason::WEAK_DEPENDENCY &&
@@ -2758,6 +3323,7 @@ void PackageQuery::filter_userinstalled() {
 }
 
 void PackageQuery::filter_unneeded() {
+    PQImpl::prepare_filtering(*this);
     auto & pool = get_rpm_pool(p_impl->base);
 
     auto * installed_repo = pool->installed;
@@ -28,6 +28,8 @@ extern "C" {
 #include <solv/solvable.h>
 }
 
+#include <functional>
+#include <memory>
 #include <optional>
 
 namespace libdnf5::rpm {
@@ -50,6 +52,13 @@ public:
     static void filter_reldep(
         PackageSet & pkg_set, Id libsolv_key, libdnf5::sack::QueryCmp cmp_type, const PackageSet & package_set);
 
+    /// Add all packages whose name matches the glob `pattern` to the `filter_result`, the `filter_result`
+    /// may contain also packages that are not in the `pkg_set`. If the pattern starts with a literal prefix
+    /// and there are less package names with the prefix than packages in the `pkg_set`, only the names
+    /// with the prefix are matched (see `PackageSack::Impl::get_names_with_prefix()`), otherwise the names
+    /// of the packages in the `pkg_set` are matched.
+    static void filter_name_glob(PackageSet & pkg_set, const char * pattern, libdnf5::solv::SolvMap & filter_result);
+
     /// @param cmp_glob performance optimization - it must be in synchronization with cmp_type
     static void filter_nevra(
         PackageSet & pkg_set,
@@ -60,7 +69,6 @@ public:
         bool with_src);
     static void filter_nevra(
         PackageSet & pkg_set,
-        const std::vector<Solvable *> & sorted_solvables,
         const std::string & pattern,
         bool cmp_glob,
         libdnf5::sack::QueryCmp cmp_type,
@@ -78,10 +86,27 @@ public:
         const std::vector<libdnf5::advisory::AdvisoryPackage> & adv_pkgs,
         libdnf5::sack::QueryCmp cmp_type);
 
+    /// @return `true` if the `query` defers filters, otherwise prepares it for a filter that is run immediately.
+    static bool should_defer_filter(PackageQuery & query);
+
+    /// Records the `filter` to be run later. The filter is created only if the query defers filters and its
+    /// arguments are checked before, so an invalid argument is reported by the call that records it.
+    static void defer_filter(
+        PackageQuery & query, unsigned int cost, std::function<void(PackageQuery & query)> && filter);
+
+    /// @return A snapshot of `package_set` for a deferred filter, the copies of the filter share it.
+    /// Copying runs the deferred filters of a query, so the copies of the filter only read the snapshot.
+    static std::shared_ptr<const PackageSet> share_package_set(const PackageSet & package_set);
+
+    /// Prepares the `query` for a filter that is run immediately: runs the deferred filters and converts
+    /// the set to the dense map (a query is sparse only after it was swapped with a sparse `PackageSet`).
+    static void prepare_filtering(PackageQuery & query);
+
 private:
     friend PackageQuery;
     ExcludeFlags flags;
     std::optional<libdnf5::solv::SolvMap> considered_cache;
+    bool defer_filters{false};
 };
 
 
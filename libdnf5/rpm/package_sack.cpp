@@ -42,6 +42,7 @@ extern "C" {
 }
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 
 
@@ -49,11 +50,191 @@ using LibsolvRepo = Repo;
 
 namespace libdnf5::rpm {
 
+namespace {
+
+// Returns true if the file is listed in the primary metadata. The filter is the same
+// that createrepo_c and libsolv use for the file list in primary.
+bool is_primary_file(const char * path) {
+    return std::strncmp(path, "/etc/", 5) == 0 || std::strstr(path, "bin/") != nullptr ||
+           std::strcmp(path, "/usr/lib/sendmail") == 0;
+}
+
+// Returns true if resolving any of the file dependencies needs the complete file lists.
+// Files from the primary metadata are found without them.
+bool needs_filelists(const libdnf5::solv::Pool & pool, const libdnf5::solv::IdQueue & file_deps) {
+    for (Id id : file_deps) {
+        if (!is_primary_file(pool.id2str(id))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+void PackageSack::Impl::load_filelists(const libdnf5::solv::SolvMap * pkgs) {
+    if (!base->get_config().get_lazy_filelists_option().get_value()) {
+        return;
+    }
+
+    auto rq = repo::RepoQuery(base);
+    for (auto & repo : rq.get_data()) {
+        if (!repo->filelists_load_deferred || !repo->solv_repo) {
+            continue;
+        }
+
+        bool involved = pkgs == nullptr;
+        auto * solv_repo = repo->solv_repo->repo;
+        for (Id id = solv_repo->start; !involved && id < solv_repo->end; ++id) {
+            involved = pkgs->contains(id);
+        }
+
+        if (involved) {
+            repo->load_filelists();
+        }
+    }
+}
+
+void PackageSack::Impl::update_name_indexes() {
+    if (is_cache_current(cached_name_indexes_size, cached_name_indexes_generation)) {
+        return;
+    }
+    auto & pool = get_rpm_pool(base);
+    auto nsolvables = get_nsolvables();
+    auto name_cmp = [&pool](Id lhs, Id rhs) {
+        return std::string_view(pool.id2str(lhs)) < std::string_view(pool.id2str(rhs));
+    };
+
+    if (!is_cache_appendable(cached_name_indexes_size, cached_name_indexes_generation)) {
+        // solvables were freed, the indexes are rebuilt
+        auto & sorted_solvables = get_sorted_solvables();
+        cached_name_ranges.clear();
+        cached_sorted_names.clear();
+        // the solvables of each name form a contiguous range of the sorted solvables
+        for (std::size_t idx = 0; idx < sorted_solvables.size(); ++idx) {
+            Id name_id = sorted_solvables[idx]->name;
+            auto [it, inserted] = cached_name_ranges.try_emplace(name_id, idx, idx);
+            if (inserted) {
+                cached_sorted_names.push_back(name_id);
+            }
+            it->second.second = idx + 1;
+        }
+        std::sort(cached_sorted_names.begin(), cached_sorted_names.end(), name_cmp);
+    } else {
+        // names of the appended packages, the sorted solvables are ordered by the name id first
+        std::vector<Id> appended_names;
+        auto & solvables_map = get_solvables();
+        for (Id solvable_id = cached_name_indexes_size; solvable_id < nsolvables; ++solvable_id) {
+            if (solvables_map.contains_unsafe(solvable_id)) {
+                appended_names.push_back(pool.id2solvable(solvable_id)->name);
+            }
+        }
+        std::sort(appended_names.begin(), appended_names.end());
+        auto & sorted_solvables = get_sorted_solvables();
+
+        // the ranges of the known names are shifted by the appended packages merged before or into them
+        for (auto & [name_id, range] : cached_name_ranges) {
+            auto [lower, upper] = std::equal_range(appended_names.begin(), appended_names.end(), name_id);
+            auto shift = static_cast<std::size_t>(lower - appended_names.begin());
+            range.first += shift;
+            range.second += shift + static_cast<std::size_t>(upper - lower);
+        }
+
+        // the ranges of the new names are looked up in the merged sorted solvables
+        auto name_id_cmp = [](const Solvable * solvable, Id name_id) { return solvable->name < name_id; };
+        auto id_name_cmp = [](Id name_id, const Solvable * solvable) { return name_id < solvable->name; };
+        std::vector<Id> added_names;
+        for (auto it = appended_names.begin(); it != appended_names.end(); ++it) {
+            Id name_id = *it;
+            if ((it != appended_names.begin() && *(it - 1) == name_id) || cached_name_ranges.contains(name_id)) {
+                continue;
+            }
+            auto first = std::lower_bound(sorted_solvables.begin(), sorted_solvables.end(), name_id, name_id_cmp);
+            auto last = std::upper_bound(first, sorted_solvables.end(), name_id, id_name_cmp);
+            cached_name_ranges.emplace(
+                name_id,
+                std::make_pair(
+                    static_cast<std::size_t>(first - sorted_solvables.begin()),
+                    static_cast<std::size_t>(last - sorted_solvables.begin())));
+            added_names.push_back(name_id);
+        }
+
+        std::sort(added_names.begin(), added_names.end(), name_cmp);
+        auto middle = cached_sorted_names.insert(cached_sorted_names.end(), added_names.begin(), added_names.end());
+        std::inplace_merge(cached_sorted_names.begin(), middle, cached_sorted_names.end(), name_cmp);
+    }
+    cached_name_indexes_size = nsolvables;
+    cached_name_indexes_generation = pool.get_solvables_generation();
+}
+
+
+PackageSack::Impl::SolvableRange PackageSack::Impl::get_sorted_solvables_by_name(Id name_id) {
+    update_name_indexes();
+    const auto & sorted_solvables = cached_sorted_solvables;
+    auto it = cached_name_ranges.find(name_id);
+    if (it == cached_name_ranges.end()) {
+        return {sorted_solvables.end(), sorted_solvables.end()};
+    }
+    auto begin = sorted_solvables.begin();
+    return {
+        begin + static_cast<std::ptrdiff_t>(it->second.first), begin + static_cast<std::ptrdiff_t>(it->second.second)};
+}
+
+
+PackageSack::Impl::NameIdRange PackageSack::Impl::get_names_with_prefix(std::string_view prefix) {
+    update_name_indexes();
+    auto & pool = get_rpm_pool(base);
+    // the names with the prefix form a contiguous range of the names sorted by strcmp
+    auto low = std::lower_bound(
+        cached_sorted_names.cbegin(), cached_sorted_names.cend(), prefix, [&pool](Id name_id, std::string_view value) {
+            return std::string_view(pool.id2str(name_id)) < value;
+        });
+    auto high = std::find_if(low, cached_sorted_names.cend(), [&pool, prefix](Id name_id) {
+        return !std::string_view(pool.id2str(name_id)).starts_with(prefix);
+    });
+    return {low, high};
+}
+
+
+void PackageSack::Impl::load_filelists_for_file_dependencies() {
+    if (!base->get_config().get_lazy_filelists_option().get_value()) {
+        return;
+    }
+
+    auto rq = repo::RepoQuery(base);
+    if (std::none_of(rq.get_data().begin(), rq.get_data().end(), [](const auto & repo) {
+            return repo->filelists_load_deferred && repo->solv_repo;
+        })) {
+        return;
+    }
+
+    libdnf5::solv::SolvMap original_considered_map(0);
+    get_rpm_pool(base).swap_considered_map(original_considered_map);
+
+    base->get_repo_sack()->internalize_repos();
+
+    auto & pool = get_rpm_pool(base);
+    libdnf5::solv::IdQueue file_deps;
+    libdnf5::solv::IdQueue file_deps_inst;
+    pool_addfileprovides_queue(*pool, &file_deps.get_queue(), &file_deps_inst.get_queue());
+
+    get_rpm_pool(base).swap_considered_map(original_considered_map);
+
+    // file dependencies outside of the primary file lists need the deferred filelists of all the repositories,
+    // any of them can provide the files
+    if (needs_filelists(pool, file_deps) || needs_filelists(pool, file_deps_inst)) {
+        load_filelists();
+    }
+}
+
 void PackageSack::Impl::make_provides_ready() {
     if (provides_ready) {
         return;
     }
 
+    // Loading the filelists invalidates the provides, they must be loaded before the provides are prepared.
+    load_filelists_for_file_dependencies();
+
     // Temporarily replaces the considered map with an empty one. Ignores "excludes" during calculation provides.
     libdnf5::solv::SolvMap original_considered_map(0);
     get_rpm_pool(base).swap_considered_map(original_considered_map);
@@ -178,6 +359,7 @@ void PackageSack::Impl::load_config_excludes_includes(bool only_main) {
     if (includes_used) {
         config_includes.reset(new libdnf5::solv::SolvMap(0));
         if (includes_exist) {
+            includes.p_impl->make_dense();
             *config_includes = *includes.p_impl;
         }
     } else {
@@ -186,6 +368,7 @@ void PackageSack::Impl::load_config_excludes_includes(bool only_main) {
 
     if (excludes_exist) {
         config_excludes.reset(new libdnf5::solv::SolvMap(0));
+        excludes.p_impl->make_dense();
         *config_excludes = *excludes.p_impl;
     }
 }
@@ -200,7 +383,8 @@ const PackageSet PackageSack::Impl::get_user_excludes() {
 
 void PackageSack::Impl::add_user_excludes(const PackageSet & excludes) {
     if (user_excludes) {
-        *user_excludes |= *excludes.p_impl;
+        PackageSet::Impl::DenseMapView excludes_map(*excludes.p_impl);
+        *user_excludes |= *excludes_map;
         considered_uptodate = false;
     } else {
         set_user_excludes(excludes);
@@ -209,13 +393,15 @@ void PackageSack::Impl::add_user_excludes(const PackageSet & excludes) {
 
 void PackageSack::Impl::remove_user_excludes(const PackageSet & excludes) {
     if (user_excludes) {
-        *user_excludes -= *excludes.p_impl;
+        PackageSet::Impl::DenseMapView excludes_map(*excludes.p_impl);
+        *user_excludes -= *excludes_map;
         considered_uptodate = false;
     }
 }
 
 void PackageSack::Impl::set_user_excludes(const PackageSet & excludes) {
-    user_excludes.reset(new libdnf5::solv::SolvMap(*excludes.p_impl));
+    PackageSet::Impl::DenseMapView excludes_map(*excludes.p_impl);
+    user_excludes.reset(new libdnf5::solv::SolvMap(*excludes_map));
     considered_uptodate = false;
 }
 
@@ -234,7 +420,8 @@ const PackageSet PackageSack::Impl::get_user_includes() {
 
 void PackageSack::Impl::add_user_includes(const PackageSet & includes) {
     if (user_includes) {
-        *user_includes |= *includes.p_impl;
+        PackageSet::Impl::DenseMapView includes_map(*includes.p_impl);
+        *user_includes |= *includes_map;
         considered_uptodate = false;
     } else {
         set_user_includes(includes);
@@ -243,13 +430,15 @@ void PackageSack::Impl::add_user_includes(const PackageSet & includes) {
 
 void PackageSack::Impl::remove_user_includes(const PackageSet & includes) {
     if (user_includes) {
-        *user_includes -= *includes.p_impl;
+        PackageSet::Impl::DenseMapView includes_map(*includes.p_impl);
+        *user_includes -= *includes_map;
         considered_uptodate = false;
     }
 }
 
 void PackageSack::Impl::set_user_includes(const PackageSet & includes) {
-    user_includes.reset(new libdnf5::solv::SolvMap(*includes.p_impl));
+    PackageSet::Impl::DenseMapView includes_map(*includes.p_impl);
+    user_includes.reset(new libdnf5::solv::SolvMap(*includes_map));
     // enable the use of includes for all repositories
     for (const auto & repo : base->get_repo_sack()->get_data()) {
         repo->set_use_includes(true);
@@ -272,7 +461,8 @@ const PackageSet PackageSack::Impl::get_module_excludes() {
 
 void PackageSack::Impl::add_module_excludes(const PackageSet & excludes) {
     if (module_excludes) {
-        *module_excludes |= *excludes.p_impl;
+        PackageSet::Impl::DenseMapView excludes_map(*excludes.p_impl);
+        *module_excludes |= *excludes_map;
         considered_uptodate = false;
     } else {
         set_module_excludes(excludes);
@@ -281,13 +471,15 @@ void PackageSack::Impl::add_module_excludes(const PackageSet & excludes) {
 
 void PackageSack::Impl::remove_module_excludes(const PackageSet & excludes) {
     if (module_excludes) {
-        *module_excludes -= *excludes.p_impl;
+        PackageSet::Impl::DenseMapView excludes_map(*excludes.p_impl);
+        *module_excludes -= *excludes_map;
         considered_uptodate = false;
     }
 }
 
 void PackageSack::Impl::set_module_excludes(const PackageSet & excludes) {
-    module_excludes.reset(new libdnf5::solv::SolvMap(*excludes.p_impl));
+    PackageSet::Impl::DenseMapView excludes_map(*excludes.p_impl);
+    module_excludes.reset(new libdnf5::solv::SolvMap(*excludes_map));
     considered_uptodate = false;
 }
 
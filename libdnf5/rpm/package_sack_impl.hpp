@@ -32,7 +32,13 @@ extern "C" {
 #include <solv/pool.h>
 }
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 
@@ -58,10 +64,23 @@ static inline bool nevra_solvable_cmp_icase_key(
     return first.second->evr < second.second->evr;
 }
 
+/// Return the pointer to the solvable in the array of solvables `solvables` that was at the same index
+/// as `solvable` in the previous (possibly already freed) array of solvables `old_solvables`.
+static inline Solvable * rebase_solvable(
+    const Solvable * solvable, const Solvable * old_solvables, Solvable * solvables) {
+    // the addresses are compared as integers, the old array is no longer valid
+    auto offset = (reinterpret_cast<std::uintptr_t>(solvable) - reinterpret_cast<std::uintptr_t>(old_solvables)) /
+                  sizeof(Solvable);
+    return solvables + offset;
+}
+
 namespace libdnf5::rpm {
 
 class PackageSack::Impl {
 public:
+    using SolvableRange = std::pair<std::vector<Solvable *>::const_iterator, std::vector<Solvable *>::const_iterator>;
+    using NameIdRange = std::pair<std::vector<Id>::const_iterator, std::vector<Id>::const_iterator>;
+
     explicit Impl(const BaseWeakPtr & base) : base(base) {}
 
     /// Return number of solvables in pool
@@ -76,8 +95,25 @@ public:
     /// Return sorted list of all package solvables in format pair<id_of_lowercase_name, Solvable *>
     std::vector<std::pair<Id, Solvable *>> & get_sorted_icase_solvables();
 
+    /// Return the range of the sorted list of all package solvables (see `get_sorted_solvables()`)
+    /// with the packages of the name `name_id`. The range is empty if there is no such package.
+    /// The ranges of all names are indexed by a hash map built on the first use.
+    SolvableRange get_sorted_solvables_by_name(Id name_id);
+
+    /// Return the ids of the names of all packages that start with `prefix`, sorted by the names.
+    /// The ids are found in an index of all names sorted by strcmp built on the first use.
+    NameIdRange get_names_with_prefix(std::string_view prefix);
+
     void make_provides_ready();
 
+    /// Loads the filelists of the repositories with deferred filelists loading (the `lazy_filelists` option).
+    /// Only the repositories containing some of the `pkgs` are loaded, all of them if `pkgs` is nullptr.
+    void load_filelists(const libdnf5::solv::SolvMap * pkgs = nullptr);
+
+    /// Loads the deferred filelists of all the repositories if some file dependencies are not in the primary
+    /// file lists. Used before the provides are prepared.
+    void load_filelists_for_file_dependencies();
+
     void invalidate_provides() { provides_ready = false; }
 
     PackageId get_running_kernel_id();
@@ -139,15 +175,49 @@ private:
 
     bool considered_uptodate = true;
 
+    // The caches of the solvables remember the number of solvables and the generation of the solvables
+    // of the pool they were updated for (see `is_cache_appendable()`).
     std::vector<Solvable *> cached_sorted_solvables;
     int cached_sorted_solvables_size{0};
+    unsigned int cached_sorted_solvables_generation{0};
+    /// pool->solvables the pointers in cached_sorted_solvables point to, libsolv reallocates it when the pool grows
+    const Solvable * cached_sorted_solvables_base{nullptr};
     /// pair<id_of_lowercase_name, Solvable *>
     std::vector<std::pair<Id, Solvable *>> cached_sorted_icase_solvables;
     int cached_sorted_icase_solvables_size{0};
+    unsigned int cached_sorted_icase_solvables_generation{0};
+    const Solvable * cached_sorted_icase_solvables_base{nullptr};
     libdnf5::solv::SolvMap cached_solvables{0};
     int cached_solvables_size{0};
+    unsigned int cached_solvables_generation{0};
+    /// name id -> range of indexes in cached_sorted_solvables
+    std::unordered_map<Id, std::pair<std::size_t, std::size_t>> cached_name_ranges;
+    /// ids of the names of all packages sorted by strcmp
+    std::vector<Id> cached_sorted_names;
+    int cached_name_indexes_size{0};
+    unsigned int cached_name_indexes_generation{0};
+    /// solvable id -> changelogs of the installed package read from the rpmdb
+    std::unordered_map<Id, std::vector<Changelog>> cached_rpmdb_changelogs;
+    unsigned int cached_rpmdb_changelogs_generation{0};
     PackageId running_kernel;
 
+    /// @return `true` if a cache updated for `cached_size` solvables of the `cached_generation` is up to date.
+    bool is_cache_current(int cached_size, unsigned int cached_generation) const noexcept {
+        auto & pool = get_rpm_pool(base);
+        return pool.get_nsolvables() == cached_size && pool.get_solvables_generation() == cached_generation;
+    }
+
+    /// @return `true` if only new solvables were appended to the pool since a cache was updated for `cached_size`
+    /// solvables of the `cached_generation`, so the cache can be updated with them. Otherwise solvables were freed
+    /// (the pool shrank or its generation changed) and the cache has to be rebuilt.
+    bool is_cache_appendable(int cached_size, unsigned int cached_generation) const noexcept {
+        auto & pool = get_rpm_pool(base);
+        return pool.get_nsolvables() >= cached_size && pool.get_solvables_generation() == cached_generation;
+    }
+
+    /// Updates the name indexes with the solvables appended to the pool, rebuilds them if solvables were freed.
+    void update_name_indexes();
+
     friend PackageSack;
     friend Package;
     friend PackageSet;
@@ -158,63 +228,103 @@ private:
 };
 
 inline std::vector<Solvable *> & PackageSack::Impl::get_sorted_solvables() {
-    auto nsolvables = get_nsolvables();
-    if (nsolvables == cached_sorted_solvables_size) {
+    if (is_cache_current(cached_sorted_solvables_size, cached_sorted_solvables_generation)) {
         return cached_sorted_solvables;
     }
-    auto & solvables_map = get_solvables();
-    cached_sorted_solvables.clear();
-    cached_sorted_solvables.reserve(static_cast<size_t>(nsolvables));
     auto & pool = get_rpm_pool(base);
-    for (Id id : solvables_map) {
-        cached_sorted_solvables.push_back(pool.id2solvable(id));
+    auto nsolvables = get_nsolvables();
+    auto & solvables_map = get_solvables();
+    if (!is_cache_appendable(cached_sorted_solvables_size, cached_sorted_solvables_generation)) {
+        // solvables were freed, the cache is rebuilt
+        cached_sorted_solvables.clear();
+        cached_sorted_solvables_size = 0;
+    } else if (cached_sorted_solvables_base != pool->solvables) {
+        for (auto & solvable : cached_sorted_solvables) {
+            solvable = rebase_solvable(solvable, cached_sorted_solvables_base, pool->solvables);
+        }
     }
-    std::sort(cached_sorted_solvables.begin(), cached_sorted_solvables.end(), nevra_solvable_cmp_key);
+
+    // only the solvables appended since the last update are sorted and merged into the cache
+    auto old_count = static_cast<std::ptrdiff_t>(cached_sorted_solvables.size());
+    for (Id id = cached_sorted_solvables_size; id < nsolvables; ++id) {
+        if (solvables_map.contains_unsafe(id)) {
+            cached_sorted_solvables.push_back(pool.id2solvable(id));
+        }
+    }
+    auto middle = cached_sorted_solvables.begin() + old_count;
+    std::sort(middle, cached_sorted_solvables.end(), nevra_solvable_cmp_key);
+    std::inplace_merge(cached_sorted_solvables.begin(), middle, cached_sorted_solvables.end(), nevra_solvable_cmp_key);
+
     cached_sorted_solvables_size = nsolvables;
+    cached_sorted_solvables_generation = pool.get_solvables_generation();
+    cached_sorted_solvables_base = pool->solvables;
     return cached_sorted_solvables;
 }
 
 inline std::vector<std::pair<Id, Solvable *>> & PackageSack::Impl::get_sorted_icase_solvables() {
+    if (is_cache_current(cached_sorted_icase_solvables_size, cached_sorted_icase_solvables_generation)) {
+        return cached_sorted_icase_solvables;
+    }
     auto & pool = get_rpm_pool(base);
     auto nsolvables = get_nsolvables();
-    if (nsolvables == cached_sorted_icase_solvables_size) {
-        return cached_sorted_icase_solvables;
+    auto & solvables_map = get_solvables();
+    if (!is_cache_appendable(cached_sorted_icase_solvables_size, cached_sorted_icase_solvables_generation)) {
+        // solvables were freed, the cache is rebuilt
+        cached_sorted_icase_solvables.clear();
+        cached_sorted_icase_solvables_size = 0;
+    } else if (cached_sorted_icase_solvables_base != pool->solvables) {
+        for (auto & item : cached_sorted_icase_solvables) {
+            item.second = rebase_solvable(item.second, cached_sorted_icase_solvables_base, pool->solvables);
+        }
     }
-    Id name = 0;
-    Id icase_name = 0;
-    for (auto * solvable : get_sorted_solvables()) {
-        if (solvable->name != name) {
-            icase_name = pool.id_to_lowercase_id(solvable->name, 1);
+
+    // only the solvables appended since the last update are sorted and merged into the cache
+    auto old_count = static_cast<std::ptrdiff_t>(cached_sorted_icase_solvables.size());
+    for (Id id = cached_sorted_icase_solvables_size; id < nsolvables; ++id) {
+        if (solvables_map.contains_unsafe(id)) {
+            auto * solvable = pool.id2solvable(id);
+            cached_sorted_icase_solvables.emplace_back(pool.id_to_lowercase_id(solvable->name, 1), solvable);
         }
-        cached_sorted_icase_solvables.emplace_back(std::make_pair(icase_name, solvable));
     }
-    std::sort(cached_sorted_icase_solvables.begin(), cached_sorted_icase_solvables.end(), nevra_solvable_cmp_icase_key);
+    auto middle = cached_sorted_icase_solvables.begin() + old_count;
+    std::sort(middle, cached_sorted_icase_solvables.end(), nevra_solvable_cmp_icase_key);
+    std::inplace_merge(
+        cached_sorted_icase_solvables.begin(),
+        middle,
+        cached_sorted_icase_solvables.end(),
+        nevra_solvable_cmp_icase_key);
+
     cached_sorted_icase_solvables_size = nsolvables;
+    cached_sorted_icase_solvables_generation = pool.get_solvables_generation();
+    cached_sorted_icase_solvables_base = pool->solvables;
     return cached_sorted_icase_solvables;
 }
 
 inline libdnf5::solv::SolvMap & PackageSack::Impl::get_solvables() {
-    auto & spool = get_rpm_pool(base);
-    ::Pool * pool = *spool;
+    auto & pool = get_rpm_pool(base);
 
-    auto nsolvables = get_nsolvables();
-    if (nsolvables == cached_solvables_size) {
+    if (is_cache_current(cached_solvables_size, cached_solvables_generation)) {
         return cached_solvables;
     }
-    if (nsolvables > cached_solvables.allocated_size()) {
-        cached_solvables = libdnf5::solv::SolvMap(nsolvables);
-    } else {
+    auto nsolvables = get_nsolvables();
+    if (!is_cache_appendable(cached_solvables_size, cached_solvables_generation)) {
+        // solvables were freed, the cache is rebuilt
         cached_solvables.clear();
+        cached_solvables_size = 0;
+    }
+    if (nsolvables > cached_solvables.allocated_size()) {
+        cached_solvables.grow(nsolvables);
     }
-    Id solvable_id;
 
-    // loop over all package solvables
-    FOR_POOL_SOLVABLES(solvable_id) {
-        if (spool.is_package(solvable_id)) {
+    // only the solvables appended since the last update are added
+    for (Id solvable_id = std::max(cached_solvables_size, 2); solvable_id < nsolvables; ++solvable_id) {
+        // skips the freed solvables like FOR_POOL_SOLVABLES
+        if (pool.id2solvable(solvable_id)->repo && pool.is_package(solvable_id)) {
             cached_solvables.add_unsafe(solvable_id);
         }
     }
     cached_solvables_size = nsolvables;
+    cached_solvables_generation = pool.get_solvables_generation();
     return cached_solvables;
 }
 
@@ -27,17 +27,93 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "libdnf5/rpm/package_sack.hpp"
 #include "libdnf5/rpm/package_set_iterator.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
 
 namespace libdnf5::rpm {
 
+namespace {
+
+// A sparse set takes at most the memory of the dense map: 4 bytes per package id vs. 1 bit per solvable.
+constexpr std::size_t SPARSE_MAX_SIZE_DIVISOR = 32;
+
+// Small sets are kept sparse also in small pools.
+constexpr std::size_t SPARSE_MAX_SIZE_MIN = 32;
+
+}  // namespace
+
+
+libdnf5::solv::SolvMap PackageSet::Impl::build_dense_map() const {
+    libdnf5::solv::SolvMap dense(get_rpm_pool(base).get_nsolvables());
+    for (auto id : sparse_ids) {
+        dense.add_unsafe(id);
+    }
+    return dense;
+}
+
+
+void PackageSet::Impl::convert_to_dense() {
+    libdnf5::solv::SolvMap::operator=(build_dense_map());
+    sparse = false;
+    sparse_ids = std::vector<Id>();
+}
+
+
+void PackageSet::Impl::set_ids(std::vector<Id> && ids) {
+    if (sparse) {
+        sparse_ids = std::move(ids);
+        if (sparse_ids.size() > get_max_sparse_size()) {
+            convert_to_dense();
+        }
+    } else {
+        libdnf5::solv::SolvMap::clear();
+        if (!ids.empty() && ids.back() >= allocated_size()) {
+            grow(ids.back() + 1);
+        }
+        for (auto id : ids) {
+            add_unsafe(id);
+        }
+    }
+}
+
+
+std::size_t PackageSet::Impl::get_max_sparse_size() const {
+    return std::max(
+        static_cast<std::size_t>(get_rpm_pool(base).get_nsolvables()) / SPARSE_MAX_SIZE_DIVISOR, SPARSE_MAX_SIZE_MIN);
+}
+
+
+void PackageSet::Impl::check_id_in_pool_range(Id id) const {
+    if (id < 0 || id >= get_rpm_pool(base).get_nsolvables()) {
+        throw std::out_of_range("Id is out of bitmap range");
+    }
+}
+
+
+PackageSet::Impl::DenseMapView::DenseMapView(Impl & impl) : map(&impl) {
+    impl.run_deferred_filters();
+    if (impl.sparse) {
+        sparse_map = impl.build_dense_map();
+        map = &sparse_map;
+    }
+}
+
 
 PackageSet::PackageSet(const BaseWeakPtr & base) : p_impl(new Impl(base)) {}
 
 PackageSet::PackageSet(libdnf5::Base & base) : PackageSet(base.get_weak_ptr()) {}
 
-PackageSet::PackageSet(const PackageSet & other) : p_impl(new Impl(*other.p_impl)) {}
+// A copy gets the filtered content, the deferred filters of a query are run before it is copied.
+PackageSet::PackageSet(const PackageSet & other) {
+    other.p_impl->run_deferred_filters();
+    p_impl.reset(new Impl(*other.p_impl));
+}
 
 
+// A moved query keeps its deferred filters, they are run on the next access to the content that can fail.
 PackageSet::PackageSet(PackageSet && other) noexcept : p_impl(new Impl(std::move(*other.p_impl))) {}
 
 
@@ -47,53 +123,154 @@ PackageSet::PackageSet(const BaseWeakPtr & base, libdnf5::solv::SolvMap & solv_m
 
 PackageSet::~PackageSet() = default;
 
+// A dense set stays dense, PackageQuery relies on it.
 PackageSet & PackageSet::operator=(const PackageSet & other) {
+    other.p_impl->run_deferred_filters();
+    bool dense = !p_impl->is_sparse();
     *p_impl = *other.p_impl;
+    if (dense) {
+        p_impl->make_dense();
+    }
     return *this;
 }
 
 PackageSet & PackageSet::operator=(PackageSet && other) {
+    other.p_impl->run_deferred_filters();
+    bool dense = !p_impl->is_sparse();
     *p_impl = std::move(*other.p_impl);
+    if (dense) {
+        p_impl->make_dense();
+    }
     return *this;
 }
 
 
 PackageSet & PackageSet::operator|=(const PackageSet & other) {
-    libdnf_assert_same_base(p_impl->base, other.p_impl->base);
-
-    *p_impl |= *other.p_impl;
+    auto & impl = *p_impl;
+    auto & other_impl = *other.p_impl;
+    libdnf_assert_same_base(impl.base, other_impl.base);
+    impl.run_deferred_filters();
+    other_impl.run_deferred_filters();
+
+    if (other_impl.sparse) {
+        if (impl.sparse) {
+            std::vector<Id> ids;
+            ids.reserve(impl.sparse_ids.size() + other_impl.sparse_ids.size());
+            std::set_union(
+                impl.sparse_ids.begin(),
+                impl.sparse_ids.end(),
+                other_impl.sparse_ids.begin(),
+                other_impl.sparse_ids.end(),
+                std::back_inserter(ids));
+            impl.set_ids(std::move(ids));
+        } else {
+            if (!other_impl.sparse_ids.empty() && other_impl.sparse_ids.back() >= impl.allocated_size()) {
+                impl.grow(other_impl.sparse_ids.back() + 1);
+            }
+            for (auto id : other_impl.sparse_ids) {
+                impl.add_unsafe(id);
+            }
+        }
+    } else {
+        impl.make_dense();
+        impl |= other_impl;
+    }
     return *this;
 }
 
 
 PackageSet & PackageSet::operator-=(const PackageSet & other) {
-    libdnf_assert_same_base(p_impl->base, other.p_impl->base);
-
-    *p_impl -= *other.p_impl;
+    auto & impl = *p_impl;
+    auto & other_impl = *other.p_impl;
+    libdnf_assert_same_base(impl.base, other_impl.base);
+    impl.run_deferred_filters();
+    other_impl.run_deferred_filters();
+
+    if (impl.sparse) {
+        std::vector<Id> ids;
+        if (other_impl.sparse) {
+            ids.reserve(impl.sparse_ids.size());
+            std::set_difference(
+                impl.sparse_ids.begin(),
+                impl.sparse_ids.end(),
+                other_impl.sparse_ids.begin(),
+                other_impl.sparse_ids.end(),
+                std::back_inserter(ids));
+        } else {
+            std::copy_if(
+                impl.sparse_ids.begin(), impl.sparse_ids.end(), std::back_inserter(ids), [&other_impl](Id id) {
+                    return !other_impl.contains(id);
+                });
+        }
+        impl.sparse_ids = std::move(ids);
+    } else if (other_impl.sparse) {
+        for (auto id : other_impl.sparse_ids) {
+            if (id < impl.allocated_size()) {
+                impl.remove_unsafe(id);
+            }
+        }
+    } else {
+        impl -= other_impl;
+    }
     return *this;
 }
 
 
 PackageSet & PackageSet::operator&=(const PackageSet & other) {
-    libdnf_assert_same_base(p_impl->base, other.p_impl->base);
-
-    *p_impl &= *other.p_impl;
+    auto & impl = *p_impl;
+    auto & other_impl = *other.p_impl;
+    libdnf_assert_same_base(impl.base, other_impl.base);
+    impl.run_deferred_filters();
+    other_impl.run_deferred_filters();
+
+    if (impl.sparse || other_impl.sparse) {
+        // the result is not bigger than the sparse set, a dense set stays dense
+        const auto & sparse_impl = impl.sparse ? impl : other_impl;
+        const auto & any_impl = impl.sparse ? other_impl : impl;
+        std::vector<Id> ids;
+        if (any_impl.sparse) {
+            ids.reserve(std::min(sparse_impl.sparse_ids.size(), any_impl.sparse_ids.size()));
+            std::set_intersection(
+                sparse_impl.sparse_ids.begin(),
+                sparse_impl.sparse_ids.end(),
+                any_impl.sparse_ids.begin(),
+                any_impl.sparse_ids.end(),
+                std::back_inserter(ids));
+        } else {
+            std::copy_if(
+                sparse_impl.sparse_ids.begin(),
+                sparse_impl.sparse_ids.end(),
+                std::back_inserter(ids),
+                [&any_impl](Id id) { return any_impl.contains(id); });
+        }
+        impl.set_ids(std::move(ids));
+    } else {
+        impl &= other_impl;
+    }
     return *this;
 }
 
 
 void PackageSet::clear() noexcept {
-    p_impl->clear();
+    auto & impl = *p_impl;
+    impl.clear_deferred_filters();
+    if (impl.sparse) {
+        impl.sparse_ids.clear();
+    } else {
+        impl.clear();
+    }
 }
 
 
 bool PackageSet::empty() const noexcept {
-    return p_impl->empty();
+    auto & impl = *p_impl;
+    return impl.sparse ? impl.sparse_ids.empty() : impl.empty();
 }
 
 
 std::size_t PackageSet::size() const noexcept {
-    return p_impl->size();
+    auto & impl = *p_impl;
+    return impl.sparse ? impl.sparse_ids.size() : impl.size();
 }
 
 
@@ -103,17 +280,47 @@ void PackageSet::swap(PackageSet & other) noexcept {
 
 
 void PackageSet::add(const Package & pkg) {
-    p_impl->add(pkg.get_id().id);
+    auto & impl = *p_impl;
+    impl.run_deferred_filters();
+    auto id = pkg.get_id().id;
+    if (impl.sparse) {
+        impl.check_id_in_pool_range(id);
+        auto it = std::lower_bound(impl.sparse_ids.begin(), impl.sparse_ids.end(), id);
+        if (it == impl.sparse_ids.end() || *it != id) {
+            impl.sparse_ids.insert(it, id);
+            if (impl.sparse_ids.size() > impl.get_max_sparse_size()) {
+                impl.convert_to_dense();
+            }
+        }
+    } else {
+        impl.add(id);
+    }
 }
 
 
 bool PackageSet::contains(const Package & pkg) const noexcept {
-    return p_impl->contains(pkg.get_id().id);
+    auto & impl = *p_impl;
+    auto id = pkg.get_id().id;
+    if (impl.sparse) {
+        return std::binary_search(impl.sparse_ids.begin(), impl.sparse_ids.end(), id);
+    }
+    return impl.contains(id);
 }
 
 
 void PackageSet::remove(const Package & pkg) {
-    p_impl->remove(pkg.get_id().id);
+    auto & impl = *p_impl;
+    impl.run_deferred_filters();
+    auto id = pkg.get_id().id;
+    if (impl.sparse) {
+        impl.check_id_in_pool_range(id);
+        auto it = std::lower_bound(impl.sparse_ids.begin(), impl.sparse_ids.end(), id);
+        if (it != impl.sparse_ids.end() && *it == id) {
+            impl.sparse_ids.erase(it);
+        }
+    } else {
+        impl.remove(id);
+    }
 }
 
 
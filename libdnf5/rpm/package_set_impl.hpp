@@ -31,13 +31,34 @@ extern "C" {
 #include <solv/pool.h>
 }
 
+#include <atomic>
+#include <functional>
+#include <vector>
 
-namespace libdnf5::rpm {
 
+namespace libdnf5::rpm {
 
+class PackageQuery;
+
+
+/// The set is stored either as a sorted array of package ids (sparse) or as a bitmap of all solvables
+/// of the pool (dense). A new empty set is sparse, it is converted to the dense map when the number
+/// of packages exceeds the size of the bitmap in bytes divided by 4 (where the array takes the same
+/// memory as the bitmap, but at least 32 packages are kept sparse). A dense set is not converted back.
+/// The operations of `PackageSet` work with both representations, so the copies and the set operations
+/// of small sets are proportional to the number of their packages instead of the size of the pool.
+///
+/// The internal code works with the dense map. A set it modifies is converted using `make_dense()`,
+/// a set it only reads is accessed through `DenseMapView`, which never modifies the set.
+/// `PackageQuery` is always dense.
+///
+/// A `PackageQuery` with deferred filters records its filters in the set instead of running them.
+/// The recorded filters are run, ordered by their cost, on the first access to the content of the query
+/// that can fail and when the query is copied or assigned to a set. The noexcept methods of `PackageSet`
+/// never run them.
 class PackageSet::Impl : public libdnf5::solv::SolvMap {
 public:
-    /// Initialize with an empty map
+    /// Initialize with an empty set
     explicit Impl(const BaseWeakPtr & base);
 
     /// Clone from an existing map
@@ -54,47 +75,156 @@ public:
     Impl & operator=(const libdnf5::solv::SolvMap & map);
     Impl & operator=(libdnf5::solv::SolvMap && map);
 
+    /// @return `true` if the set is stored as the sorted array of package ids.
+    bool is_sparse() const noexcept { return sparse; }
+
+    /// @return The sorted package ids of a sparse set.
+    const std::vector<Id> & get_sparse_ids() const noexcept { return sparse_ids; }
+
+    /// Converts a sparse set to the dense map.
+    void make_dense() {
+        if (sparse) {
+            convert_to_dense();
+        }
+    }
+
+    /// A filter of `PackageQuery` recorded to be run later.
+    struct DeferredFilter {
+        /// Filters with a lower cost are run first. The filters are recorded only if their result does not
+        /// depend on the other packages in the set, so any order gives the same result.
+        unsigned int cost;
+        std::function<void(PackageQuery & query)> run;
+    };
+
+    /// @return `true` if there are filters waiting to be run.
+    bool has_deferred_filters() const noexcept { return deferred_filters_pending.load(std::memory_order_acquire); }
+
+    /// Records a filter, it will be run on the next access to the content of the query.
+    void add_deferred_filter(unsigned int cost, std::function<void(PackageQuery & query)> && filter) {
+        deferred_filters.push_back({cost, std::move(filter)});
+        deferred_filters_pending.store(true, std::memory_order_release);
+    }
+
+    /// Runs the recorded filters. The filters are run under a lock, so the const readers of a query can run
+    /// them concurrently. If a filter throws, the exception is propagated and the filters stay recorded.
+    /// Defined in package_query.cpp.
+    void run_deferred_filters();
+
+    /// Drops the recorded filters, used when the content of the set is replaced.
+    void clear_deferred_filters() noexcept {
+        deferred_filters.clear();
+        deferred_filters_pending.store(false, std::memory_order_release);
+    }
+
+    /// Read access to the dense map of a set that the internal code does not modify.
+    /// The deferred filters of the set are run first. A sparse set is not converted, its dense map
+    /// is built in the view, so concurrent readers and the iterators of the set are not affected.
+    class DenseMapView {
+    public:
+        explicit DenseMapView(Impl & impl);
+        DenseMapView(const DenseMapView &) = delete;
+        DenseMapView & operator=(const DenseMapView &) = delete;
+
+        const libdnf5::solv::SolvMap & operator*() const noexcept { return *map; }
+        const libdnf5::solv::SolvMap * operator->() const noexcept { return map; }
+
+    private:
+        libdnf5::solv::SolvMap sparse_map{0};
+        const libdnf5::solv::SolvMap * map;
+    };
+
 private:
     friend PackageSet;
     friend PackageQuery;
 
+    /// @return The dense map with the packages of a sparse set.
+    libdnf5::solv::SolvMap build_dense_map() const;
+
+    void convert_to_dense();
+
+    /// Runs the recorded filters ordered by their cost on a query with a copy of the content of the set.
+    /// The set and its filters are left unchanged if a filter throws. Defined in package_query.cpp.
+    void apply_deferred_filters();
+
+    /// Replaces the content with the sorted `ids`. A sparse set is converted to the dense map if it is too big,
+    /// a dense set stays dense.
+    void set_ids(std::vector<Id> && ids);
+
+    /// @return The maximum number of packages of a sparse set.
+    std::size_t get_max_sparse_size() const;
+
+    /// Check if `id` can be stored in a sparse set.
+    ///
+    /// @exception std::out_of_range `id` is not an id of a solvable in the pool.
+    void check_id_in_pool_range(Id id) const;
+
     BaseWeakPtr base;
+    bool sparse{false};
+    std::vector<Id> sparse_ids;
+    std::vector<DeferredFilter> deferred_filters;
+    // set when `deferred_filters` is not empty, the readers check it without the lock
+    std::atomic<bool> deferred_filters_pending{false};
 };
 
 
 inline PackageSet::Impl::Impl(const BaseWeakPtr & base)
-    : libdnf5::solv::SolvMap::SolvMap(get_rpm_pool(base).get_nsolvables()),
-      base(base) {}
+    : libdnf5::solv::SolvMap::SolvMap(0),
+      base(base),
+      sparse(true) {}
 
 inline PackageSet::Impl::Impl(const BaseWeakPtr & base, libdnf5::solv::SolvMap & solv_map)
     : libdnf5::solv::SolvMap::SolvMap(solv_map),
       base(base) {}
 
-inline PackageSet::Impl::Impl(const Impl & other) : libdnf5::solv::SolvMap::SolvMap(other), base(other.base) {}
+inline PackageSet::Impl::Impl(const Impl & other)
+    : libdnf5::solv::SolvMap::SolvMap(other),
+      base(other.base),
+      sparse(other.sparse),
+      sparse_ids(other.sparse_ids),
+      deferred_filters(other.deferred_filters),
+      deferred_filters_pending(other.deferred_filters_pending.load()) {}
 
 inline PackageSet::Impl::Impl(Impl && other)
     : libdnf5::solv::SolvMap::SolvMap(std::move(other)),
-      base(std::move(other.base)) {}
+      base(std::move(other.base)),
+      sparse(other.sparse),
+      sparse_ids(std::move(other.sparse_ids)),
+      deferred_filters(std::move(other.deferred_filters)),
+      deferred_filters_pending(other.deferred_filters_pending.exchange(false)) {}
 
 inline PackageSet::Impl & PackageSet::Impl::operator=(const Impl & other) {
     libdnf5::solv::SolvMap::operator=(other);
     base = other.base;
+    sparse = other.sparse;
+    sparse_ids = other.sparse_ids;
+    deferred_filters = other.deferred_filters;
+    deferred_filters_pending.store(other.deferred_filters_pending.load());
     return *this;
 }
 
 inline PackageSet::Impl & PackageSet::Impl::operator=(Impl && other) {
     libdnf5::solv::SolvMap::operator=(std::move(other));
     base = std::move(other.base);
+    sparse = other.sparse;
+    sparse_ids = std::move(other.sparse_ids);
+    deferred_filters = std::move(other.deferred_filters);
+    deferred_filters_pending.store(other.deferred_filters_pending.exchange(false));
     return *this;
 }
 
 inline PackageSet::Impl & PackageSet::Impl::operator=(const libdnf5::solv::SolvMap & map) {
     libdnf5::solv::SolvMap::operator=(map);
+    sparse = false;
+    sparse_ids.clear();
+    clear_deferred_filters();
     return *this;
 }
 
 inline PackageSet::Impl & PackageSet::Impl::operator=(libdnf5::solv::SolvMap && map) {
     libdnf5::solv::SolvMap::operator=(std::move(map));
+    sparse = false;
+    sparse_ids.clear();
+    clear_deferred_filters();
     return *this;
 }
 
@@ -23,22 +23,74 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "package_set_impl.hpp"
 #include "solv/solv_map.hpp"
 
+#include <vector>
+
 
 namespace libdnf5::rpm {
 
+// Iterates the dense map of the set or the package ids of a sparse set. Only the non-const operations
+// of the set change its representation, they invalidate the iterators as usual.
 class PackageSetIterator::Impl : private libdnf5::solv::SolvMap::iterator {
 private:
-    Impl(const PackageSet & package_set)
-        : libdnf5::solv::SolvMap::iterator(package_set.p_impl->get_map()),
-          package_set{&package_set} {}
+    Impl(const PackageSet & package_set) : Impl(package_set, evaluated(package_set)) {}
+
+    Impl(const PackageSet & package_set, const PackageSet::Impl & set_impl)
+        : libdnf5::solv::SolvMap::iterator(set_impl.get_map()),
+          package_set{&package_set},
+          sparse_ids{set_impl.is_sparse() ? &set_impl.get_sparse_ids() : nullptr} {}
+
+    static const PackageSet::Impl & evaluated(const PackageSet & package_set) {
+        package_set.p_impl->run_deferred_filters();
+        return *package_set.p_impl;
+    }
+
+    void begin() {
+        if (sparse_ids) {
+            sparse_it = sparse_ids->begin();
+        } else {
+            libdnf5::solv::SolvMap::iterator::begin();
+        }
+    }
+
+    void end() {
+        if (sparse_ids) {
+            sparse_it = sparse_ids->end();
+        } else {
+            libdnf5::solv::SolvMap::iterator::end();
+        }
+    }
+
+    Id operator*() const {
+        if (sparse_ids) {
+            return *sparse_it;
+        }
+        return libdnf5::solv::SolvMap::iterator::operator*();
+    }
 
     PackageSetIterator::Impl & operator++() {
-        libdnf5::solv::SolvMap::iterator::operator++();
+        if (sparse_ids) {
+            ++sparse_it;
+        } else {
+            libdnf5::solv::SolvMap::iterator::operator++();
+        }
         return *this;
     }
 
+    bool operator==(const Impl & other) const {
+        if (sparse_ids) {
+            return sparse_it == other.sparse_it;
+        }
+        return libdnf5::solv::SolvMap::iterator::operator==(other);
+    }
+
+    bool operator!=(const Impl & other) const { return !(*this == other); }
+
     const PackageSet * package_set;
 
+    // package ids of a sparse set, nullptr for a dense set
+    const std::vector<Id> * sparse_ids;
+    std::vector<Id>::const_iterator sparse_it;
+
     friend PackageSetIterator;
 };
 
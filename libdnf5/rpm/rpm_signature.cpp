@@ -21,6 +21,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "repo/repo_pgp.hpp"
 #include "rpm/rpm_log_guard.hpp"
+#include "rpm_signature_private.hpp"
 #include "utils/fs/temp.hpp"
 #include "utils/url.hpp"
 
@@ -103,19 +104,24 @@ std::string KeyInfo::get_short_key_id() const {
     return short_key_id;
 }
 
+bool is_package_signature_check_required(const BaseWeakPtr & base, const Package & package) {
+    auto repo = package.get_repo();
+    if (repo->get_type() == libdnf5::repo::Repo::Type::COMMANDLINE) {
+        return base->get_config().get_localpkg_gpgcheck_option().get_value();
+    }
+    return repo->get_config().get_gpgcheck_option().get_value();
+}
+
 RpmSignature::CheckResult RpmSignature::check_package_signature(rpm::Package pkg) const {
     // is package gpg check even required?
-    auto repo = pkg.get_repo();
-    if (repo->get_type() == libdnf5::repo::Repo::Type::COMMANDLINE) {
-        if (!base->get_config().get_localpkg_gpgcheck_option().get_value()) {
-            return CheckResult::OK;
-        }
-    } else {
-        auto & repo_config = repo->get_config();
-        if (!repo_config.get_gpgcheck_option().get_value()) {
-            return CheckResult::OK;
-        }
+    if (!is_package_signature_check_required(base, pkg)) {
+        return CheckResult::OK;
     }
+    return check_package_file_signature(base, pkg.get_package_path());
+}
+
+RpmSignature::CheckResult check_package_file_signature(const BaseWeakPtr & base, const std::string & path) {
+    using CheckResult = RpmSignature::CheckResult;
 
     // rpmcliVerifySignatures is the only API rpm provides for signature verification.
     // Unfortunatelly to distinguish key_missing/not_signed/verification_failed cases
@@ -132,8 +138,8 @@ RpmSignature::CheckResult RpmSignature::check_package_signature(rpm::Package pkg
     auto oldmask = rpmlogSetMask(RPMLOG_UPTO(RPMLOG_PRI(RPMLOG_INFO)));
 
     rpmtsSetVfyLevel(ts_ptr.get(), RPMSIG_SIGNATURE_TYPE);
-    std::string path = pkg.get_package_path();
-    char * const path_array[2] = {&path[0], NULL};
+    std::string path_arg = path;
+    char * const path_array[2] = {&path_arg[0], NULL};
     auto rc = rpmcliVerifySignatures(ts_ptr.get(), path_array);
 
     rpmlogSetMask(oldmask);
@@ -0,0 +1,43 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBDNF5_RPM_RPM_SIGNATURE_PRIVATE_HPP
+#define LIBDNF5_RPM_RPM_SIGNATURE_PRIVATE_HPP
+
+#include "libdnf5/base/base_weak.hpp"
+#include "libdnf5/rpm/package.hpp"
+#include "libdnf5/rpm/rpm_signature.hpp"
+
+#include <string>
+
+
+namespace libdnf5::rpm {
+
+/// @return True if the configuration of the `package` repository (or `localpkg_gpgcheck` for command line
+///         packages) requires checking the signature of the package.
+bool is_package_signature_check_required(const BaseWeakPtr & base, const Package & package);
+
+/// Checks the signatures and digests of the package file at `path` using public keys stored in rpm database.
+/// Unlike `RpmSignature::check_package_signature` it does not access the package sack, so it can be run
+/// in a worker thread.
+RpmSignature::CheckResult check_package_file_signature(const BaseWeakPtr & base, const std::string & path);
+
+}  // namespace libdnf5::rpm
+
+#endif  // LIBDNF5_RPM_RPM_SIGNATURE_PRIVATE_HPP
@@ -21,6 +21,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "transaction.hpp"
 
 #include "package_set_impl.hpp"
+#include "utils/thread_pool.hpp"
 
 #include "libdnf5/base/transaction.hpp"
 #include "libdnf5/common/exception.hpp"
@@ -39,8 +40,12 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <map>
+#include <thread>
 #include <type_traits>
 
 
@@ -156,6 +161,9 @@ void Transaction::fill(const base::Transaction & transaction) {
         installonly_versions.insert(std::make_pair(pkg.get_name(), pkg));
     }
 
+    // worker threads read the headers of inbound packages from the disk while the packages are added in order
+    auto header_prefetchers = prefetch_pkg_headers();
+
     for (auto & tspkg : transaction_items) {
         switch (tspkg.get_action()) {
             case libdnf5::transaction::TransactionItemAction::INSTALL:
@@ -289,6 +297,72 @@ Header Transaction::read_pkg_header(const std::string & file_path) const {
     return h;
 }
 
+// Reads the lead, the signature header and the header of the package file, so they are in the page cache when
+// the header is read by librpm. Only the file is read, librpm reports the errors when it reads the header.
+static void prefetch_package_file_header(const std::string & file_path) {
+    constexpr std::streamoff LEAD_SIZE = 96;
+    constexpr std::streamoff HEADER_INTRO_SIZE = 16;
+    constexpr std::streamoff HEADER_INDEX_ENTRY_SIZE = 16;
+    constexpr std::uint32_t HEADER_MAX_SIZE = 256 * 1024 * 1024;
+
+    std::ifstream file(file_path, std::ios::binary);
+    file.seekg(LEAD_SIZE);
+    // the signature header is padded to 8 bytes, the header follows it
+    for (bool signature : {true, false}) {
+        unsigned char intro[HEADER_INTRO_SIZE];
+        if (!file.read(reinterpret_cast<char *>(intro), HEADER_INTRO_SIZE) || intro[0] != 0x8e || intro[1] != 0xad ||
+            intro[2] != 0xe8) {
+            return;
+        }
+        auto read_be32 = [&intro](std::size_t offset) {
+            std::uint32_t value = 0;
+            for (std::size_t idx = offset; idx < offset + 4; ++idx) {
+                value = value << 8 | intro[idx];
+            }
+            return value;
+        };
+        auto index_length = read_be32(8);
+        auto data_length = read_be32(12);
+        if (index_length > HEADER_MAX_SIZE / HEADER_INDEX_ENTRY_SIZE || data_length > HEADER_MAX_SIZE) {
+            return;
+        }
+        std::streamoff size = index_length * HEADER_INDEX_ENTRY_SIZE + data_length;
+        if (signature) {
+            size += (8 - (HEADER_INTRO_SIZE + size) % 8) % 8;
+        }
+        if (!file.ignore(size)) {
+            return;
+        }
+    }
+}
+
+std::unique_ptr<utils::ThreadPool> Transaction::prefetch_pkg_headers() const {
+    std::vector<std::string> file_paths;
+    for (const auto & tspkg : transaction_items) {
+        switch (tspkg.get_action()) {
+            case libdnf5::transaction::TransactionItemAction::INSTALL:
+            case libdnf5::transaction::TransactionItemAction::UPGRADE:
+            case libdnf5::transaction::TransactionItemAction::DOWNGRADE:
+            case libdnf5::transaction::TransactionItemAction::REINSTALL:
+                file_paths.push_back(tspkg.get_package().get_package_path());
+                break;
+            default:
+                break;
+        }
+    }
+    if (file_paths.size() < 2) {
+        return nullptr;
+    }
+
+    // the workers do not use librpm, the headers are parsed and verified by librpm in the calling thread
+    auto prefetchers = std::make_unique<utils::ThreadPool>(
+        std::min<std::size_t>(std::thread::hardware_concurrency(), file_paths.size()));
+    for (auto & file_path : file_paths) {
+        prefetchers->submit([file_path = std::move(file_path)]() { prefetch_package_file_header(file_path); });
+    }
+    return prefetchers;
+}
+
 Header Transaction::get_header(unsigned int rec_offset) {
     Header hdr = nullptr;
 
@@ -496,6 +570,27 @@ const char * TransactionCallbacks::script_type_to_string(ScriptType type) noexce
     return "unknown";
 }
 
+// Keys pairing the start and the stop callbacks of an element or a scriptlet in the timeline
+static std::string timeline_element_key(const TransactionItem * item) {
+    return fmt::format("element {}", static_cast<const void *>(item));
+}
+
+static std::string timeline_script_key(const void * te, TransactionCallbacks::ScriptType script_type) {
+    return fmt::format("script {} {}", te, utils::to_underlying(script_type));
+}
+
+static std::string script_timeline_category(TransactionCallbacks::ScriptType script_type) {
+    switch (script_type) {
+        case TransactionCallbacks::ScriptType::TRIGGER_PRE_INSTALL:
+        case TransactionCallbacks::ScriptType::TRIGGER_INSTALL:
+        case TransactionCallbacks::ScriptType::TRIGGER_UNINSTALL:
+        case TransactionCallbacks::ScriptType::TRIGGER_POST_UNINSTALL:
+            return "trigger";
+        default:
+            return "scriptlet";
+    }
+}
+
 #define libdnf_assert_transaction_item_set() libdnf_assert(item != nullptr, "TransactionItem is not set")
 
 void * Transaction::ts_callback(
@@ -527,6 +622,9 @@ void * Transaction::ts_callback(
                 "RPM callback install start \"{}\" total {}",
                 to_full_nevra_string(trans_element_to_nevra(trans_element)),
                 total);
+            if (transaction.timeline) {
+                transaction.timeline->begin(timeline_element_key(item));
+            }
             if (callbacks) {
                 callbacks->install_start(*item, total);
             }
@@ -556,12 +654,19 @@ void * Transaction::ts_callback(
             break;
         case RPMCALLBACK_TRANS_START:
             logger.info("RPM callback transaction start, total {}", total);
+            if (transaction.timeline) {
+                transaction.timeline->begin("prepare");
+            }
             if (callbacks) {
                 callbacks->transaction_start(total);
             }
             break;
         case RPMCALLBACK_TRANS_STOP:
             logger.info("RPM callback transaction stop, total {}", total);
+            if (transaction.timeline) {
+                transaction.timeline->end(
+                    "prepare", "prepare transaction", "rpm", base::TransactionTimeline::Track::TRANSACTION);
+            }
             if (callbacks) {
                 callbacks->transaction_stop(total);
             }
@@ -578,6 +683,9 @@ void * Transaction::ts_callback(
                 "RPM callback uninstall start \"{}\" total {}",
                 to_full_nevra_string(trans_element_to_nevra(trans_element)),
                 total);
+            if (transaction.timeline) {
+                transaction.timeline->begin(timeline_element_key(item));
+            }
             if (callbacks) {
                 callbacks->uninstall_start(*item, total);
             }
@@ -589,6 +697,14 @@ void * Transaction::ts_callback(
                 to_full_nevra_string(trans_element_to_nevra(trans_element)),
                 amount,
                 total);
+            if (transaction.timeline) {
+                transaction.timeline->end(
+                    timeline_element_key(item),
+                    "erase " + to_full_nevra_string(trans_element_to_nevra(trans_element)),
+                    "package",
+                    base::TransactionTimeline::Track::PACKAGES,
+                    {{"action", libdnf5::transaction::transaction_item_action_to_string(item->get_action())}});
+            }
             if (callbacks) {
                 callbacks->uninstall_stop(*item, amount, total);
             }
@@ -642,6 +758,9 @@ void * Transaction::ts_callback(
                 "RPM callback start {} scriptlet \"{}\"",
                 TransactionCallbacks::script_type_to_string(script_type),
                 to_full_nevra_string(nevra));
+            if (transaction.timeline) {
+                transaction.timeline->begin(timeline_script_key(te, script_type));
+            }
             if (callbacks) {
                 callbacks->script_start(item, nevra, script_type);
             }
@@ -657,6 +776,15 @@ void * Transaction::ts_callback(
                 TransactionCallbacks::script_type_to_string(script_type),
                 to_full_nevra_string(nevra),
                 total);
+            if (transaction.timeline) {
+                transaction.timeline->end(
+                    timeline_script_key(te, script_type),
+                    fmt::format(
+                        "{} {}", TransactionCallbacks::script_type_to_string(script_type), to_full_nevra_string(nevra)),
+                    script_timeline_category(script_type),
+                    base::TransactionTimeline::Track::SCRIPTLETS,
+                    {{"return code", std::to_string(total)}});
+            }
             if (callbacks) {
                 callbacks->script_stop(item, nevra, script_type, total);
             }
@@ -669,6 +797,14 @@ void * Transaction::ts_callback(
                 to_full_nevra_string(trans_element_to_nevra(trans_element)),
                 amount,
                 total);
+            if (transaction.timeline) {
+                transaction.timeline->end(
+                    timeline_element_key(item),
+                    "install " + to_full_nevra_string(trans_element_to_nevra(trans_element)),
+                    "package",
+                    base::TransactionTimeline::Track::PACKAGES,
+                    {{"action", libdnf5::transaction::transaction_item_action_to_string(item->get_action())}});
+            }
             if (callbacks) {
                 callbacks->install_stop(*item, amount, total);
             }
@@ -686,12 +822,19 @@ void * Transaction::ts_callback(
             break;
         case RPMCALLBACK_VERIFY_START:
             logger.info("RPM callback verify start, total {}", total);
+            if (transaction.timeline) {
+                transaction.timeline->begin("verify");
+            }
             if (callbacks) {
                 callbacks->verify_start(total);
             }
             break;
         case RPMCALLBACK_VERIFY_STOP:
             logger.info("RPM callback verify stop, total {}", total);
+            if (transaction.timeline) {
+                transaction.timeline->end(
+                    "verify", "verify packages", "rpm", base::TransactionTimeline::Track::TRANSACTION);
+            }
             if (callbacks) {
                 callbacks->verify_stop(total);
             }
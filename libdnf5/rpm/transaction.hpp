@@ -21,7 +21,9 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #ifndef LIBDNF5_RPM_TRANSACTION_HPP
 #define LIBDNF5_RPM_TRANSACTION_HPP
 
+#include "base/transaction_timeline.hpp"
 #include "rpm_log_guard.hpp"
+#include "utils/thread_pool.hpp"
 
 #include "libdnf5/base/base_weak.hpp"
 #include "libdnf5/base/transaction_package.hpp"
@@ -319,6 +321,10 @@ public:
     /// @param file_path  new file path
     void set_script_out_file(const std::string & file_path);
 
+    /// Set the timeline the packages and scriptlets processed by the transaction are recorded to.
+    /// @param timeline  the timeline or nullptr to not record the events
+    void set_timeline(base::TransactionTimeline * timeline) noexcept { this->timeline = timeline; }
+
     /// @return A `Base` object to which the transaction belongs.
     /// @since 5.0
     BaseWeakPtr get_base() const;
@@ -334,6 +340,7 @@ private:
     FD_t script_fd{nullptr};
     CallbacksHolder callbacks_holder{nullptr, this};
     FD_t fd_in_cb{nullptr};  // file descriptor used by transaction in callback (install/reinstall package)
+    base::TransactionTimeline * timeline{nullptr};
 
     TransactionItem * last_added_item{nullptr};  // item added by last install/reinstall/erase/...
     bool last_item_added_ts_element{false};      // Did the last item add the element ts?
@@ -351,6 +358,11 @@ private:
     /// @return  package header
     Header read_pkg_header(const std::string & file_path) const;
 
+    /// Starts worker threads reading the headers of the inbound packages of the transaction from the disk,
+    /// so `read_pkg_header()` finds them in the page cache. The workers only read the files.
+    /// @return The pool of the workers, its destruction waits for them, or nullptr if there is nothing to read.
+    std::unique_ptr<utils::ThreadPool> prefetch_pkg_headers() const;
+
     /// Get header of package at offset in the rpmdbi database
     Header get_header(unsigned int rec_offset);
 
@@ -93,6 +93,13 @@ public:
 
     int get_nsolvables() const { return pool->nsolvables; }
 
+    /// @return The generation of the solvables in the pool, it changes when solvables are freed.
+    /// The caches of the solvables are updated incrementally only while the generation is unchanged.
+    unsigned int get_solvables_generation() const noexcept { return solvables_generation; }
+
+    /// Has to be called when solvables are freed (e.g. by `repo_empty()`), their ids can be reused by new solvables.
+    void solvables_freed() noexcept { ++solvables_generation; }
+
     Solvable * id2solvable(Id id) const { return pool_id2solvable(pool, id); }
 
     const char * id2str(Id id) const { return pool_id2str(pool, id); }
@@ -246,6 +253,7 @@ public:
 protected:
     SolvMap considered;  // owner of the considered map, `pool->considered` is only a raw pointer
     ::Pool * pool;
+    unsigned int solvables_generation{0};
 };
 
 
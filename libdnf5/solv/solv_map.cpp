@@ -0,0 +1,265 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "solv_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+
+namespace libdnf5::solv {
+
+namespace {
+
+enum class Operation { OR, AND, AND_NOT };
+
+using Word = std::uint64_t;
+
+using BitwiseKernel = void (*)(unsigned char * dest, const unsigned char * src, std::size_t size) noexcept;
+using PopcountKernel = std::size_t (*)(const unsigned char * data, std::size_t size) noexcept;
+
+// The kernels chosen according to the features of the CPU.
+struct Kernels {
+    BitwiseKernel bitwise_or;
+    BitwiseKernel bitwise_and;
+    BitwiseKernel bitwise_and_not;
+    PopcountKernel popcount;
+};
+
+
+template <Operation operation>
+[[gnu::always_inline]] inline Word apply(Word dest, Word src) noexcept {
+    if constexpr (operation == Operation::OR) {
+        return dest | src;
+    } else if constexpr (operation == Operation::AND) {
+        return dest & src;
+    } else {
+        return dest & ~src;
+    }
+}
+
+
+// Applies the operation by 64-bit words, the remaining bytes are processed one by one.
+// The byte order does not matter for the bitwise operations and the bit counting.
+template <Operation operation>
+[[gnu::always_inline]] inline void apply_words(
+    unsigned char * dest, const unsigned char * src, std::size_t size) noexcept {
+    std::size_t idx = 0;
+    for (; idx + sizeof(Word) <= size; idx += sizeof(Word)) {
+        Word dest_word;
+        Word src_word;
+        std::memcpy(&dest_word, dest + idx, sizeof(Word));
+        std::memcpy(&src_word, src + idx, sizeof(Word));
+        dest_word = apply<operation>(dest_word, src_word);
+        std::memcpy(dest + idx, &dest_word, sizeof(Word));
+    }
+    for (; idx < size; ++idx) {
+        dest[idx] = static_cast<unsigned char>(apply<operation>(dest[idx], src[idx]));
+    }
+}
+
+
+[[gnu::always_inline]] inline std::size_t popcount_words(const unsigned char * data, std::size_t size) noexcept {
+    std::size_t result = 0;
+    std::size_t idx = 0;
+    for (; idx + sizeof(Word) <= size; idx += sizeof(Word)) {
+        Word word;
+        std::memcpy(&word, data + idx, sizeof(Word));
+        result += static_cast<std::size_t>(std::popcount(word));
+    }
+    for (; idx < size; ++idx) {
+        result += static_cast<std::size_t>(std::popcount(data[idx]));
+    }
+    return result;
+}
+
+
+// Portable kernels, the compiler vectorizes the word loops with the baseline instruction set.
+template <Operation operation>
+void apply_generic(unsigned char * dest, const unsigned char * src, std::size_t size) noexcept {
+    apply_words<operation>(dest, src, size);
+}
+
+
+std::size_t popcount_generic(const unsigned char * data, std::size_t size) noexcept {
+    return popcount_words(data, size);
+}
+
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+// SSE4.2 level kernel, counts the bits with the POPCNT instruction.
+[[gnu::target("sse4.2,popcnt")]] std::size_t popcount_sse42(const unsigned char * data, std::size_t size) noexcept {
+    return popcount_words(data, size);
+}
+
+
+// AVX2 kernels processing 32 bytes at once.
+template <Operation operation>
+[[gnu::target("avx2")]] void apply_avx2(unsigned char * dest, const unsigned char * src, std::size_t size) noexcept {
+    std::size_t idx = 0;
+    for (; idx + sizeof(__m256i) <= size; idx += sizeof(__m256i)) {
+        auto * dest_address = reinterpret_cast<__m256i *>(dest + idx);
+        auto dest_vector = _mm256_loadu_si256(dest_address);
+        auto src_vector = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + idx));
+        if constexpr (operation == Operation::OR) {
+            dest_vector = _mm256_or_si256(dest_vector, src_vector);
+        } else if constexpr (operation == Operation::AND) {
+            dest_vector = _mm256_and_si256(dest_vector, src_vector);
+        } else {
+            dest_vector = _mm256_andnot_si256(src_vector, dest_vector);
+        }
+        _mm256_storeu_si256(dest_address, dest_vector);
+    }
+    apply_words<operation>(dest + idx, src + idx, size - idx);
+}
+
+
+// Counts the bits of the nibbles using a shuffle lookup table, the byte counts are summed by `vpsadbw`.
+// See Muła, Kurz, Lemire: Faster Population Counts Using AVX2 Instructions.
+[[gnu::target("avx2,popcnt")]] std::size_t popcount_avx2(const unsigned char * data, std::size_t size) noexcept {
+    const auto lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const auto low_mask = _mm256_set1_epi8(0x0f);
+    auto total = _mm256_setzero_si256();
+
+    std::size_t idx = 0;
+    for (; idx + sizeof(__m256i) <= size; idx += sizeof(__m256i)) {
+        auto vector = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + idx));
+        auto low = _mm256_and_si256(vector, low_mask);
+        auto high = _mm256_and_si256(_mm256_srli_epi16(vector, 4), low_mask);
+        auto counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+
+    auto result = static_cast<std::size_t>(_mm256_extract_epi64(total, 0)) +
+                  static_cast<std::size_t>(_mm256_extract_epi64(total, 1)) +
+                  static_cast<std::size_t>(_mm256_extract_epi64(total, 2)) +
+                  static_cast<std::size_t>(_mm256_extract_epi64(total, 3));
+    return result + popcount_words(data + idx, size - idx);
+}
+
+#endif
+
+
+constexpr Kernels generic_kernels{
+    &apply_generic<Operation::OR>,
+    &apply_generic<Operation::AND>,
+    &apply_generic<Operation::AND_NOT>,
+    &popcount_generic};
+
+
+// When set, the kernels are used instead of the ones chosen for the CPU.
+std::atomic<const Kernels *> forced_kernels{nullptr};
+
+
+Kernels select_kernels() noexcept {
+    Kernels kernels = generic_kernels;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+        kernels.popcount = &popcount_sse42;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.bitwise_or = &apply_avx2<Operation::OR>;
+        kernels.bitwise_and = &apply_avx2<Operation::AND>;
+        kernels.bitwise_and_not = &apply_avx2<Operation::AND_NOT>;
+        if (__builtin_cpu_supports("popcnt")) {
+            kernels.popcount = &popcount_avx2;
+        }
+    }
+#endif
+
+    return kernels;
+}
+
+
+const Kernels & get_kernels() noexcept {
+    if (const auto * kernels = forced_kernels.load(std::memory_order_relaxed)) {
+        return *kernels;
+    }
+    static const Kernels kernels = select_kernels();
+    return kernels;
+}
+
+}  // namespace
+
+
+void SolvMap::use_generic_kernels(bool generic) noexcept {
+    forced_kernels.store(generic ? &generic_kernels : nullptr, std::memory_order_relaxed);
+}
+
+
+SolvMap & SolvMap::operator|=(const Map & other) noexcept {
+    if (map.size < other.size) {
+        map_grow(&map, other.size << 3);
+    }
+    get_kernels().bitwise_or(map.map, other.map, static_cast<std::size_t>(other.size));
+    return *this;
+}
+
+
+SolvMap & SolvMap::operator-=(const Map & other) noexcept {
+    get_kernels().bitwise_and_not(map.map, other.map, static_cast<std::size_t>(std::min(map.size, other.size)));
+    return *this;
+}
+
+
+SolvMap & SolvMap::operator&=(const Map & other) noexcept {
+    get_kernels().bitwise_and(map.map, other.map, static_cast<std::size_t>(std::min(map.size, other.size)));
+    if (map.size > other.size) {
+        // the items missing in the other map are removed
+        std::memset(map.map + other.size, 0, static_cast<std::size_t>(map.size - other.size));
+    }
+    return *this;
+}
+
+
+bool SolvMap::empty() const noexcept {
+    const auto size = static_cast<std::size_t>(map.size);
+    std::size_t idx = 0;
+    for (; idx + sizeof(Word) <= size; idx += sizeof(Word)) {
+        Word word;
+        std::memcpy(&word, map.map + idx, sizeof(Word));
+        if (word) {
+            return false;
+        }
+    }
+    for (; idx < size; ++idx) {
+        if (map.map[idx]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+std::size_t SolvMap::size() const noexcept {
+    return get_kernels().popcount(map.map, static_cast<std::size_t>(map.size));
+}
+
+}  // namespace libdnf5::solv
@@ -25,22 +25,14 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <solv/bitmap.h>
 #include <solv/pooltypes.h>
 
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 
 
 namespace libdnf5::solv {
 
-// clang-format off
-// see http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetTable
-static const unsigned char BIT_COUNT_LOOKUP[256] = {
-    #define B2(n) n, n + 1, n + 1, n + 2
-    #define B4(n) B2(n), B2(n + 1), B2(n + 1), B2(n + 2)
-    #define B6(n) B4(n), B4(n + 1), B4(n + 1), B4(n + 2)
-    B6(0), B6(1), B6(1), B6(2)
-};
-// clang-format on
-
-
 class ConstMapIterator {
 public:
     using iterator_category = std::forward_iterator_tag;
@@ -99,6 +91,20 @@ protected:
     explicit ConstMapIterator(const Map & map) noexcept : map{&map}, map_end{map.map + map.size} {}
 
 private:
+    /// Loads up to 8 bytes of the map as a word with the bit `n` of the map at the position `n % 64`.
+    static std::uint64_t load_word(const unsigned char * address, std::size_t available) noexcept {
+        std::uint64_t word = 0;
+        if (available >= sizeof(word)) {
+            std::memcpy(&word, address, sizeof(word));
+        } else {
+            std::memcpy(&word, address, available);
+        }
+        if constexpr (std::endian::native == std::endian::big) {
+            word = __builtin_bswap64(word);
+        }
+        return word;
+    }
+
     constexpr static int BEGIN = -1;
     constexpr static int END = -2;
 
@@ -188,23 +194,17 @@ public:
 
     // SET OPERATIONS - Map
 
+    // The set operations and counting process the maps by whole words using the widest
+    // instructions supported by the CPU (AVX2, POPCNT), the implementation is chosen at runtime.
+
     /// Union operator
-    SolvMap & operator|=(const Map & other) noexcept {
-        map_or(&map, &other);
-        return *this;
-    }
+    SolvMap & operator|=(const Map & other) noexcept;
 
     /// Difference operator
-    SolvMap & operator-=(const Map & other) noexcept {
-        map_subtract(&map, &other);
-        return *this;
-    }
+    SolvMap & operator-=(const Map & other) noexcept;
 
     /// Intersection operator
-    SolvMap & operator&=(const Map & other) noexcept {
-        map_and(&map, &other);
-        return *this;
-    }
+    SolvMap & operator&=(const Map & other) noexcept;
 
     // SET OPERATIONS - SolvMap
 
@@ -236,46 +236,38 @@ protected:
     void check_id_in_bitmap_range(Id id) const;
 
 private:
+    /// Makes the set operations and counting use the portable kernels instead of the ones chosen for the CPU.
+    static void use_generic_kernels(bool generic) noexcept;
+
     Map map;
 };
 
 
 inline ConstMapIterator & ConstMapIterator::operator++() noexcept {
-    if (current_value >= 0) {
-        // make a copy of byte with the previous match to avoid changing the map
-        unsigned char byte = *map_current;
-
-        // reset previously seen bits to 0
-        byte = static_cast<unsigned char>(byte >> ((current_value & 7) + 1));
+    const auto map_size = static_cast<std::size_t>(map_end - map->map);
 
-        auto bit = ffs(byte << ((current_value & 7) + 1));
-        if (bit) {
-            // return (current byte * 8) + bit position - 1
-            current_value = (static_cast<int>(map_current - map->map) << 3) + bit - 1;
-            return *this;
-        }
+    // the position of the first bit to search from, after the current value or at the current address
+    std::size_t bit = current_value >= 0 ? static_cast<std::size_t>(current_value) + 1
+                                         : static_cast<std::size_t>(map_current - map->map) << 3;
 
-        // no following bit was set in the current byte
-        // move to the next byte and start searching in the next bytes
-        map_current++;
-    }
+    // search the map by 64-bit words, the bits of a word are in the order of the map bytes
+    for (std::size_t offset = (bit >> 6) << 3; offset < map_size; offset += sizeof(std::uint64_t)) {
+        auto word = load_word(map->map + offset, map_size - offset);
 
-    while (map_current < map_end) {
-        // skip all empty bytes
-        if (!*map_current) {
-            // move to the next byte
-            map_current++;
-            continue;
+        // reset the already seen bits of the first word to 0
+        if (bit > offset << 3) {
+            word &= ~std::uint64_t{0} << (bit & 63);
         }
 
-        // now we have a byte that has at least one bit set
-        // return (current byte * 8) + bit position - 1
-        current_value = (static_cast<int>(map_current - map->map) << 3) + ffs(*map_current) - 1;
-        return *this;
+        if (word) {
+            map_current = map->map + offset;
+            current_value = static_cast<Id>((offset << 3) + static_cast<std::size_t>(std::countr_zero(word)));
+            return *this;
+        }
     }
 
     // not found
-    current_value = END;
+    end();
     return *this;
 }
 
@@ -306,7 +298,9 @@ inline void ConstMapIterator::jump(Id id) noexcept {
 inline SolvMap & SolvMap::operator=(const SolvMap & other) noexcept {
     if (this != &other) {
         if (map.size == other.map.size) {
-            memcpy(map.map, other.map.map, static_cast<size_t>(map.size));
+            if (map.size > 0) {
+                memcpy(map.map, other.map.map, static_cast<size_t>(map.size));
+            }
         } else {
             map_free(&map);
             map_init_clone(&map, &other.map);
@@ -342,36 +336,6 @@ inline bool SolvMap::contains(Id id) const noexcept {
     return contains_unsafe(id);
 }
 
-
-inline bool SolvMap::empty() const noexcept {
-    const unsigned char * byte = map.map;
-    const unsigned char * end = byte + map.size;
-
-    // iterate through the whole bitmap by moving the address
-    while (byte < end) {
-        if (*byte++) {
-            // return false if a non-zero bit was found
-            return false;
-        }
-    }
-    // all bits were zero, return true
-    return true;
-}
-
-
-inline std::size_t SolvMap::size() const noexcept {
-    unsigned char * byte = map.map;
-    unsigned char * end = byte + map.size;
-    std::size_t result = 0;
-
-    // iterate through the whole bitmap by moving the address
-    while (byte < end) {
-        // add number of bits in each byte
-        result += BIT_COUNT_LOOKUP[*byte++];
-    }
-    return result;
-}
-
 }  // namespace libdnf5::solv
 
 #endif  // LIBDNF5_SOLV_MAP_HPP
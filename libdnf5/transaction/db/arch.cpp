@@ -47,4 +47,28 @@ int64_t arch_insert_if_not_exists(utils::SQLite3::Statement & query, const std::
     return result;
 }
 
+static constexpr const char * SQL_NAME_SELECT_PK = R"**(
+    SELECT
+        "id"
+    FROM
+        "arch"
+    WHERE
+        "name" = ?
+)**";
+
+std::unique_ptr<utils::SQLite3::Statement> arch_select_pk_new_query(utils::SQLite3 & conn) {
+    return std::make_unique<utils::SQLite3::Statement>(conn, SQL_NAME_SELECT_PK);
+}
+
+int64_t arch_select_pk(utils::SQLite3::Statement & query, const std::string & name) {
+    int64_t result = 0;
+
+    query.bindv(name);
+    if (query.step() == utils::SQLite3::Statement::StepResult::ROW) {
+        result = query.get<int64_t>(0);
+    }
+    query.reset();
+    return result;
+}
+
 }  // namespace libdnf5::transaction
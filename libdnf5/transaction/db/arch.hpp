@@ -32,6 +32,12 @@ std::unique_ptr<utils::SQLite3::Statement> arch_insert_if_not_exists_new_query(u
 /// Use a query to insert a new record to the 'arch' table
 int64_t arch_insert_if_not_exists(utils::SQLite3::Statement & query, const std::string & name);
 
+/// Create a query that returns the primary key of a record in the 'arch' table
+std::unique_ptr<utils::SQLite3::Statement> arch_select_pk_new_query(utils::SQLite3 & conn);
+
+/// Use a query to find the primary key of a record in the 'arch' table, return 0 if the record was not found
+int64_t arch_select_pk(utils::SQLite3::Statement & query, const std::string & name);
+
 }  // namespace libdnf5::transaction
 
 #endif  // LIBDNF5_TRANSACTION_DB_ARCH_HPP
@@ -34,6 +34,11 @@ static constexpr const char * SQL_CREATE_TABLES =
     ;
 
 
+static constexpr const char * SQL_MIGRATE_TABLES_1_2 =
+#include "sql/migrate_tables_1_2.sql"
+    ;
+
+
 static constexpr const char * SQL_TABLE_CONFIG_EXISTS = R"**(
     SELECT
         "name"
@@ -55,6 +60,45 @@ static constexpr const char * SQL_GET_SCHEMA_VERSION = R"**(
 )**";
 
 
+static std::string transaction_db_get_schema_version(libdnf5::utils::SQLite3 & conn) {
+    libdnf5::utils::SQLite3::Statement query_get_schema_version(conn, SQL_GET_SCHEMA_VERSION);
+    if (query_get_schema_version.step() != libdnf5::utils::SQLite3::Statement::StepResult::ROW) {
+        throw RuntimeError(M_("Unable to get 'version' from table 'config'"));
+    }
+    return query_get_schema_version.get<std::string>(0);
+}
+
+
+// Migrate the schema from 1.1 to 1.2. The migration adds only indexes, the database works without them.
+// It is skipped if the database is read-only (e.g. opened by a user) or locked by another process.
+static void transaction_db_migrate_1_2(libdnf5::utils::SQLite3 & conn) {
+    if (conn.is_read_only()) {
+        return;
+    }
+
+    try {
+        conn.exec("BEGIN IMMEDIATE");
+    } catch (const libdnf5::utils::SQLite3SQLError & ex) {
+        auto error_code = ex.get_error_code() & 0xff;
+        if (error_code == SQLITE_BUSY || error_code == SQLITE_READONLY) {
+            return;
+        }
+        throw;
+    }
+
+    try {
+        // another process could migrate the schema before the write lock was acquired
+        if (transaction_db_get_schema_version(conn) == "1.1") {
+            conn.exec(SQL_MIGRATE_TABLES_1_2);
+        }
+        conn.exec("COMMIT");
+    } catch (...) {
+        conn.exec("ROLLBACK");
+        throw;
+    }
+}
+
+
 // Create tables and migrate schema if necessary.
 static void transaction_db_create(libdnf5::utils::SQLite3 & conn) {
     // check if table 'config' exists; if not, assume an empty database and create the tables
@@ -63,15 +107,11 @@ static void transaction_db_create(libdnf5::utils::SQLite3 & conn) {
         conn.exec(SQL_CREATE_TABLES);
     }
 
-    std::string schema_version;
-    libdnf5::utils::SQLite3::Statement query_get_schema_version(conn, SQL_GET_SCHEMA_VERSION);
-    if (query_get_schema_version.step() == libdnf5::utils::SQLite3::Statement::StepResult::ROW) {
-        schema_version = query_get_schema_version.get<std::string>(0);
-    } else {
-        throw RuntimeError(M_("Unable to get 'version' from table 'config'"));
+    // migrate the schema step by step to the current version, nothing is written if it is up to date
+    auto schema_version = transaction_db_get_schema_version(conn);
+    if (schema_version == "1.1") {
+        transaction_db_migrate_1_2(conn);
     }
-
-    // TODO(dmach): migrations
 }
 
 
@@ -32,6 +32,12 @@ std::unique_ptr<utils::SQLite3::Statement> pkg_name_insert_if_not_exists_new_que
 /// Use a query to insert a new record to the 'pkg_name' table
 int64_t pkg_name_insert_if_not_exists(utils::SQLite3::Statement & query, const std::string & name);
 
+/// Create a query that returns the primary key of a record in the 'pkg_name' table
+std::unique_ptr<utils::SQLite3::Statement> pkg_name_select_pk_new_query(utils::SQLite3 & conn);
+
+/// Use a query to find the primary key of a record in the 'pkg_name' table, return 0 if the record was not found
+int64_t pkg_name_select_pk(utils::SQLite3::Statement & query, const std::string & name);
+
 }  // namespace libdnf5::transaction
 
 #endif  // LIBDNF5_TRANSACTION_DB_PKG_NAME_HPP
@@ -23,11 +23,14 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "arch.hpp"
 #include "item.hpp"
 #include "pkg_name.hpp"
+#include "repo.hpp"
 #include "trans_item.hpp"
 
 #include "libdnf5/transaction/rpm_package.hpp"
 #include "libdnf5/transaction/transaction.hpp"
 
+#include <unordered_map>
+
 
 namespace libdnf5::transaction {
 
@@ -88,7 +91,7 @@ static constexpr const char * SQL_RPM_INSERT = R"**(
             "arch_id"
         )
     VALUES
-        (?, (SELECT "id" FROM "pkg_name" WHERE "name" = ?), ?, ?, ?, (SELECT "id" FROM "arch" WHERE "name" = ?))
+        (?, ?, ?, ?, ?, ?)
 )**";
 
 
@@ -99,9 +102,9 @@ static std::unique_ptr<libdnf5::utils::SQLite3::Statement> rpm_insert_new_query(
 }
 
 
-int64_t RpmDbUtils::rpm_insert(libdnf5::utils::SQLite3::Statement & query, const Package & rpm) {
-    query.bindv(
-        rpm.get_item_id(), rpm.get_name(), rpm.get_epoch_int(), rpm.get_version(), rpm.get_release(), rpm.get_arch());
+int64_t RpmDbUtils::rpm_insert(
+    libdnf5::utils::SQLite3::Statement & query, const Package & rpm, int64_t name_id, int64_t arch_id) {
+    query.bindv(rpm.get_item_id(), name_id, rpm.get_epoch_int(), rpm.get_version(), rpm.get_release(), arch_id);
     query.step();
     int64_t result = query.last_insert_rowid();
     query.reset();
@@ -114,14 +117,12 @@ static constexpr const char * SQL_RPM_SELECT_PK = R"**(
         "item_id"
     FROM
         "rpm"
-    LEFT JOIN "pkg_name" ON "rpm"."name_id" = "pkg_name"."id"
-    LEFT JOIN "arch" ON "rpm"."arch_id" = "arch"."id"
     WHERE
-        "pkg_name"."name" = ?
+        "name_id" = ?
         AND "epoch" = ?
         AND "version" = ?
         AND "release" = ?
-        AND "arch"."name" = ?
+        AND "arch_id" = ?
 )**";
 
 
@@ -132,8 +133,9 @@ static std::unique_ptr<libdnf5::utils::SQLite3::Statement> rpm_select_pk_new_que
 }
 
 
-int64_t RpmDbUtils::rpm_select_pk(libdnf5::utils::SQLite3::Statement & query, const Package & rpm) {
-    query.bindv(rpm.get_name(), rpm.get_epoch_int(), rpm.get_version(), rpm.get_release(), rpm.get_arch());
+int64_t RpmDbUtils::rpm_select_pk(
+    libdnf5::utils::SQLite3::Statement & query, const Package & rpm, int64_t name_id, int64_t arch_id) {
+    query.bindv(name_id, rpm.get_epoch_int(), rpm.get_version(), rpm.get_release(), arch_id);
 
     int64_t result = 0;
     if (query.step() == libdnf5::utils::SQLite3::Statement::StepResult::ROW) {
@@ -181,23 +183,64 @@ void RpmDbUtils::insert_transaction_packages(libdnf5::utils::SQLite3 & conn, Tra
     auto query_rpm_select_pk = rpm_select_pk_new_query(conn);
     auto query_item_insert = item_insert_new_query(conn);
     auto query_pkg_name_insert_if_not_exists = pkg_name_insert_if_not_exists_new_query(conn);
+    auto query_pkg_name_select_pk = pkg_name_select_pk_new_query(conn);
     auto query_arch_insert_if_not_exists = arch_insert_if_not_exists_new_query(conn);
+    auto query_arch_select_pk = arch_select_pk_new_query(conn);
+    auto query_repo_select_pk = repo_select_pk_new_query(conn);
+    auto query_repo_insert = repo_insert_new_query(conn);
     auto query_rpm_insert = rpm_insert_new_query(conn);
     auto query_trans_item_insert = TransItemDbUtils::trans_item_insert_new_query(conn);
 
+    // The primary keys of the package names, architectures and repos are resolved once for each distinct value.
+    // The names and architectures are inserted into their tables if they do not exist yet.
+    std::unordered_map<std::string, int64_t> name_ids;
+    std::unordered_map<std::string, int64_t> arch_ids;
+    std::unordered_map<std::string, int64_t> repo_ids;
+
+    auto get_name_id = [&](const std::string & name) {
+        auto [it, inserted] = name_ids.try_emplace(name, 0);
+        if (inserted) {
+            it->second = pkg_name_insert_if_not_exists(*query_pkg_name_insert_if_not_exists, name);
+            if (it->second == 0) {
+                it->second = pkg_name_select_pk(*query_pkg_name_select_pk, name);
+            }
+        }
+        return it->second;
+    };
+
+    auto get_arch_id = [&](const std::string & arch) {
+        auto [it, inserted] = arch_ids.try_emplace(arch, 0);
+        if (inserted) {
+            it->second = arch_insert_if_not_exists(*query_arch_insert_if_not_exists, arch);
+            if (it->second == 0) {
+                it->second = arch_select_pk(*query_arch_select_pk, arch);
+            }
+        }
+        return it->second;
+    };
+
+    auto get_repo_id = [&](const std::string & repoid) {
+        auto [it, inserted] = repo_ids.try_emplace(repoid, 0);
+        if (inserted) {
+            it->second = repo_select_pk(*query_repo_select_pk, repoid);
+            if (it->second == 0) {
+                it->second = repo_insert(*query_repo_insert, repoid);
+            }
+        }
+        return it->second;
+    };
+
     for (auto & pkg : trans.get_packages()) {
-        pkg.set_item_id(rpm_select_pk(*query_rpm_select_pk, pkg));
+        auto name_id = get_name_id(pkg.get_name());
+        auto arch_id = get_arch_id(pkg.get_arch());
+        pkg.set_item_id(rpm_select_pk(*query_rpm_select_pk, pkg, name_id, arch_id));
         if (pkg.get_item_id() == 0) {
             // insert into 'item' table, create item_id
             pkg.set_item_id(item_insert(*query_item_insert));
-            // insert package name into 'pkg_name' table if not exists
-            pkg_name_insert_if_not_exists(*query_pkg_name_insert_if_not_exists, pkg.get_name());
-            // insert arch name into 'arch' table if not exists
-            arch_insert_if_not_exists(*query_arch_insert_if_not_exists, pkg.get_arch());
             // insert into 'rpm' table
-            rpm_insert(*query_rpm_insert, pkg);
+            rpm_insert(*query_rpm_insert, pkg, name_id, arch_id);
         }
-        TransItemDbUtils::transaction_item_insert(*query_trans_item_insert, pkg);
+        TransItemDbUtils::transaction_item_insert(*query_trans_item_insert, pkg, get_repo_id(pkg.get_repoid()));
     }
 }
 
@@ -40,13 +40,17 @@ public:
     static int64_t rpm_transaction_item_select(libdnf5::utils::SQLite3::Query & query, Package & pkg);
 
 
-    /// Use a query to insert a new record to the 'rpm' table
-    static int64_t rpm_insert(libdnf5::utils::SQLite3::Statement & query, const Package & rpm);
+    /// Use a query to insert a new record to the 'rpm' table.
+    /// The name and the arch are given by their primary keys in the 'pkg_name' and 'arch' tables.
+    static int64_t rpm_insert(
+        libdnf5::utils::SQLite3::Statement & query, const Package & rpm, int64_t name_id, int64_t arch_id);
 
 
     /// Find a primary key of a recod in table 'rpm' that matches the Package.
+    /// The name and the arch are given by their primary keys in the 'pkg_name' and 'arch' tables.
     /// Return an existing primary key or 0 if the record was not found.
-    static int64_t rpm_select_pk(libdnf5::utils::SQLite3::Statement & query, const Package & rpm);
+    static int64_t rpm_select_pk(
+        libdnf5::utils::SQLite3::Statement & query, const Package & rpm, int64_t name_id, int64_t arch_id);
 
 
     /// Use a query to select a record from 'rpm' table and populate a Package
@@ -154,13 +154,16 @@ R"**(
         "value" TEXT NOT NULL,
         PRIMARY KEY("key")
     );
-    INSERT INTO "config" VALUES ('version', '1.1');
+    INSERT INTO "config" VALUES ('version', '1.2');
 
     DELETE FROM "sqlite_sequence";
 
     CREATE INDEX "pkg_name_name" ON "pkg_name"("name");
     CREATE INDEX "trans_item_trans_id" ON "trans_item"("trans_id");
     CREATE INDEX "trans_item_item_id" ON "trans_item"("item_id");
+    CREATE INDEX "trans_dt_begin" ON "trans"("dt_begin");
+    CREATE INDEX "trans_user_id" ON "trans"("user_id");
+    CREATE INDEX "trans_state_id" ON "trans"("state_id");
 
     COMMIT;
 )**"
@@ -0,0 +1,8 @@
+R"**(
+    /* indexes used by the filters of the transaction listing */
+    CREATE INDEX IF NOT EXISTS "trans_dt_begin" ON "trans"("dt_begin");
+    CREATE INDEX IF NOT EXISTS "trans_user_id" ON "trans"("user_id");
+    CREATE INDEX IF NOT EXISTS "trans_state_id" ON "trans"("state_id");
+
+    UPDATE "config" SET "value" = '1.2' WHERE "key" = 'version';
+)**"
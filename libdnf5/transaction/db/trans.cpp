@@ -23,6 +23,11 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "db.hpp"
 
 #include "libdnf5/transaction/transaction.hpp"
+#include "libdnf5/transaction/transaction_history.hpp"
+
+#include <string>
+#include <variant>
+#include <vector>
 
 
 namespace libdnf5::transaction {
@@ -123,6 +128,106 @@ std::vector<Transaction> TransactionDbUtils::select_transactions_by_range(
 }
 
 
+// Selects ids of transactions containing an rpm with a name, uses the indexes of the unique nevra and item ids
+static constexpr const char * SQL_TRANS_IDS_BY_PACKAGE_NAME = R"**(
+    SELECT
+        "trans_item"."trans_id"
+    FROM
+        "trans_item"
+    JOIN "rpm" ON "rpm"."item_id" = "trans_item"."item_id"
+    JOIN "pkg_name" ON "pkg_name"."id" = "rpm"."name_id"
+    WHERE
+        "pkg_name"."name" IN
+)**";
+
+
+namespace {
+
+// Appends the "(?, ?, ...)" list of `count` placeholders to the `sql`.
+void append_placeholders(std::string & sql, std::size_t count) {
+    sql += "(";
+    for (size_t i = 0; i < count; ++i) {
+        sql += i == 0 ? "?" : ", ?";
+    }
+    sql += ")";
+}
+
+}  // namespace
+
+
+std::vector<Transaction> TransactionDbUtils::select_transactions(
+    const BaseWeakPtr & base, const TransactionListFilter & filter) {
+    auto conn = transaction_db_connect(*base);
+
+    std::vector<std::string> conditions;
+    std::vector<std::variant<int64_t, std::string>> params;
+
+    if (!filter.get_package_names().empty()) {
+        std::string condition = "\"trans\".\"id\" IN (";
+        condition += SQL_TRANS_IDS_BY_PACKAGE_NAME;
+        append_placeholders(condition, filter.get_package_names().size());
+        condition += ")";
+        conditions.push_back(std::move(condition));
+        params.insert(params.end(), filter.get_package_names().begin(), filter.get_package_names().end());
+    }
+
+    if (filter.get_dt_begin_from() > 0) {
+        conditions.emplace_back("\"trans\".\"dt_begin\" >= ?");
+        params.emplace_back(filter.get_dt_begin_from());
+    }
+
+    if (filter.get_dt_begin_to() > 0) {
+        conditions.emplace_back("\"trans\".\"dt_begin\" <= ?");
+        params.emplace_back(filter.get_dt_begin_to());
+    }
+
+    if (!filter.get_user_ids().empty()) {
+        std::string condition = "\"trans\".\"user_id\" IN ";
+        append_placeholders(condition, filter.get_user_ids().size());
+        conditions.push_back(std::move(condition));
+        for (auto user_id : filter.get_user_ids()) {
+            params.emplace_back(static_cast<int64_t>(user_id));
+        }
+    }
+
+    if (!filter.get_states().empty()) {
+        std::string condition = "\"trans_state\".\"name\" IN ";
+        append_placeholders(condition, filter.get_states().size());
+        conditions.push_back(std::move(condition));
+        for (auto state : filter.get_states()) {
+            params.emplace_back(transaction_state_to_string(state));
+        }
+    }
+
+    // keyset pagination, the next page starts after the last listed id
+    if (filter.get_after_id() > 0) {
+        conditions.emplace_back(filter.get_descending() ? "\"trans\".\"id\" < ?" : "\"trans\".\"id\" > ?");
+        params.emplace_back(filter.get_after_id());
+    }
+
+    std::string sql = select_sql;
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        sql += i == 0 ? " WHERE " : " AND ";
+        sql += conditions[i];
+    }
+
+    sql += filter.get_descending() ? " ORDER BY \"trans\".\"id\" DESC" : " ORDER BY \"trans\".\"id\" ASC";
+
+    if (filter.get_limit() > 0) {
+        sql += " LIMIT ?";
+        params.emplace_back(static_cast<int64_t>(filter.get_limit()));
+    }
+
+    auto query = libdnf5::utils::SQLite3::Query(*conn, sql);
+
+    for (size_t i = 0; i < params.size(); ++i) {
+        std::visit([&query, i](const auto & value) { query.bind(static_cast<int>(i + 1), value); }, params[i]);
+    }
+
+    return TransactionDbUtils::load_from_select(base, query);
+}
+
+
 static constexpr const char * SQL_TRANS_INSERT = R"**(
     INSERT INTO
         "trans" (
@@ -218,4 +323,38 @@ void TransactionDbUtils::trans_update(libdnf5::utils::SQLite3::Statement & query
 }
 
 
+static constexpr const char * SQL_TRANS_ITEM_REPLACED_BY_DELETE = R"**(
+    DELETE FROM
+        "item_replaced_by"
+    WHERE
+        "trans_item_id" IN (SELECT "id" FROM "trans_item" WHERE "trans_id" = ?)
+)**";
+
+
+static constexpr const char * SQL_TRANS_ITEM_DELETE = R"**(
+    DELETE FROM
+        "trans_item"
+    WHERE
+        "trans_id" = ?
+)**";
+
+
+static constexpr const char * SQL_TRANS_DELETE = R"**(
+    DELETE FROM
+        "trans"
+    WHERE
+        "id" = ?
+)**";
+
+
+void TransactionDbUtils::trans_delete(libdnf5::utils::SQLite3 & conn, Transaction & trans) {
+    // the records referencing the transaction items are deleted first, the foreign keys are enforced
+    for (const auto * sql : {SQL_TRANS_ITEM_REPLACED_BY_DELETE, SQL_TRANS_ITEM_DELETE, SQL_TRANS_DELETE}) {
+        libdnf5::utils::SQLite3::Statement query(conn, sql);
+        query.bindv(trans.get_id());
+        query.step();
+    }
+}
+
+
 }  // namespace libdnf5::transaction
@@ -33,6 +33,7 @@ namespace libdnf5::transaction {
 
 
 class Transaction;
+class TransactionListFilter;
 
 class TransactionDbUtils {
 public:
@@ -51,6 +52,9 @@ public:
     /// Selects transactions with ids within the [start, end] range (inclusive).
     static std::vector<Transaction> select_transactions_by_range(const BaseWeakPtr & base, int64_t start, int64_t end);
 
+    /// Selects transactions matching the filter, the filter conditions, ordering and limit are evaluated in SQL.
+    static std::vector<Transaction> select_transactions(const BaseWeakPtr & base, const TransactionListFilter & filter);
+
     /// Create a query for inserting records to the 'trans' table
     static std::unique_ptr<libdnf5::utils::SQLite3::Statement> trans_insert_new_query(libdnf5::utils::SQLite3 & conn);
 
@@ -59,6 +63,9 @@ public:
 
     /// Use a query to update a record in the 'trans' table
     static void trans_update(libdnf5::utils::SQLite3::Statement & query, Transaction & trans);
+
+    /// Delete the transaction record from the 'trans' table together with its transaction items
+    static void trans_delete(libdnf5::utils::SQLite3 & conn, Transaction & trans);
 };
 
 }  // namespace libdnf5::transaction
@@ -80,6 +80,12 @@ int64_t TransItemDbUtils::transaction_item_insert(libdnf5::utils::SQLite3::State
         repo_id = repo_insert(*query_repo_insert, ti.get_repoid());
     }
 
+    return transaction_item_insert(query, ti, repo_id);
+}
+
+
+int64_t TransItemDbUtils::transaction_item_insert(
+    libdnf5::utils::SQLite3::Statement & query, TransactionItem & ti, int64_t repo_id) {
     // save the transaction item
     query.bindv(
         ti.get_transaction().get_id(),
@@ -45,6 +45,12 @@ public:
 
     /// Use a query to insert a new record to the 'trans_item' table
     static int64_t transaction_item_insert(libdnf5::utils::SQLite3::Statement & query, TransactionItem & ti);
+
+
+    /// Use a query to insert a new record to the 'trans_item' table, the repo is given by its primary key
+    /// in the 'repo' table
+    static int64_t transaction_item_insert(
+        libdnf5::utils::SQLite3::Statement & query, TransactionItem & ti, int64_t repo_id);
 };
 
 
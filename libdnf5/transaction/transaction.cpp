@@ -149,15 +149,20 @@ Package & Transaction::new_package() {
 
 void Transaction::fill_transaction_packages(
     const std::vector<libdnf5::base::TransactionPackage> & transaction_packages) {
+    if (!packages) {
+        packages.emplace();
+    }
+    packages->reserve(packages->size() + transaction_packages.size());
+
     for (auto & tspkg : transaction_packages) {
         auto & new_pkg = new_package();
-        auto source_pkg = tspkg.get_package();
+        const auto & source_pkg = tspkg.get_package();
         new_pkg.set_name(source_pkg.get_name());
         new_pkg.set_epoch(source_pkg.get_epoch());
         new_pkg.set_version(source_pkg.get_version());
         new_pkg.set_release(source_pkg.get_release());
         new_pkg.set_arch(source_pkg.get_arch());
-        new_pkg.set_repoid(tspkg.get_package().get_repo_id());
+        new_pkg.set_repoid(source_pkg.get_repo_id());
         new_pkg.set_action(tspkg.get_action());
         new_pkg.set_reason(tspkg.get_reason());
     }
@@ -271,4 +276,18 @@ void Transaction::finish(TransactionState state) {
     }
 }
 
+
+void Transaction::discard() {
+    auto conn = transaction_db_connect(*base);
+    conn->exec("BEGIN");
+    try {
+        TransactionDbUtils::trans_delete(*conn, *this);
+        conn->exec("COMMIT");
+    } catch (...) {
+        conn->exec("ROLLBACK");
+        throw;
+    }
+    id = 0;
+}
+
 }  // namespace libdnf5::transaction
@@ -28,6 +28,94 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 namespace libdnf5::transaction {
 
 
+class TransactionListFilter::Impl {
+private:
+    friend TransactionListFilter;
+
+    std::vector<std::string> package_names;
+    int64_t dt_begin_from{0};
+    int64_t dt_begin_to{0};
+    std::vector<uint32_t> user_ids;
+    std::vector<TransactionState> states;
+    int64_t after_id{0};
+    bool descending{false};
+    std::size_t limit{0};
+};
+
+
+TransactionListFilter::TransactionListFilter() : p_impl(new Impl) {}
+TransactionListFilter::~TransactionListFilter() = default;
+
+TransactionListFilter::TransactionListFilter(const TransactionListFilter & src) = default;
+TransactionListFilter::TransactionListFilter(TransactionListFilter && src) noexcept = default;
+TransactionListFilter & TransactionListFilter::operator=(const TransactionListFilter & src) = default;
+TransactionListFilter & TransactionListFilter::operator=(TransactionListFilter && src) noexcept = default;
+
+void TransactionListFilter::set_package_names(const std::vector<std::string> & package_names) {
+    p_impl->package_names = package_names;
+}
+
+const std::vector<std::string> & TransactionListFilter::get_package_names() const noexcept {
+    return p_impl->package_names;
+}
+
+void TransactionListFilter::set_dt_begin_from(int64_t dt_begin_from) noexcept {
+    p_impl->dt_begin_from = dt_begin_from;
+}
+
+int64_t TransactionListFilter::get_dt_begin_from() const noexcept {
+    return p_impl->dt_begin_from;
+}
+
+void TransactionListFilter::set_dt_begin_to(int64_t dt_begin_to) noexcept {
+    p_impl->dt_begin_to = dt_begin_to;
+}
+
+int64_t TransactionListFilter::get_dt_begin_to() const noexcept {
+    return p_impl->dt_begin_to;
+}
+
+void TransactionListFilter::set_user_ids(const std::vector<uint32_t> & user_ids) {
+    p_impl->user_ids = user_ids;
+}
+
+const std::vector<uint32_t> & TransactionListFilter::get_user_ids() const noexcept {
+    return p_impl->user_ids;
+}
+
+void TransactionListFilter::set_states(const std::vector<TransactionState> & states) {
+    p_impl->states = states;
+}
+
+const std::vector<TransactionState> & TransactionListFilter::get_states() const noexcept {
+    return p_impl->states;
+}
+
+void TransactionListFilter::set_after_id(int64_t after_id) noexcept {
+    p_impl->after_id = after_id;
+}
+
+int64_t TransactionListFilter::get_after_id() const noexcept {
+    return p_impl->after_id;
+}
+
+void TransactionListFilter::set_descending(bool descending) noexcept {
+    p_impl->descending = descending;
+}
+
+bool TransactionListFilter::get_descending() const noexcept {
+    return p_impl->descending;
+}
+
+void TransactionListFilter::set_limit(std::size_t limit) noexcept {
+    p_impl->limit = limit;
+}
+
+std::size_t TransactionListFilter::get_limit() const noexcept {
+    return p_impl->limit;
+}
+
+
 TransactionHistory::TransactionHistory(const libdnf5::BaseWeakPtr & base) : base{base} {}
 
 
@@ -54,6 +142,10 @@ std::vector<Transaction> TransactionHistory::list_all_transactions() {
     return TransactionDbUtils::select_transactions_by_ids(base, {});
 }
 
+std::vector<Transaction> TransactionHistory::list_transactions(const TransactionListFilter & filter) {
+    return TransactionDbUtils::select_transactions(base, filter);
+}
+
 BaseWeakPtr TransactionHistory::get_base() const {
     return base;
 }
@@ -52,10 +52,14 @@ bool Locker::lock(short int type) {
     fl.l_pid = 0;
     auto rc = fcntl(lock_fd, F_SETLK, &fl);
     if (rc == -1) {
-        if (errno == EACCES || errno == EAGAIN) {
+        // the lock file of another holder must not be removed by unlock()
+        auto lock_errno = errno;
+        close(lock_fd);
+        lock_fd = -1;
+        if (lock_errno == EACCES || lock_errno == EAGAIN) {
             return false;
         } else {
-            throw SystemError(errno, M_("Failed to obtain lock \"{}\""), path);
+            throw SystemError(lock_errno, M_("Failed to obtain lock \"{}\""), path);
         }
     }
 
@@ -332,6 +332,7 @@ public:
     void open();
     void close();
     bool is_open() { return db != nullptr; };
+    bool is_read_only() { return sqlite3_db_readonly(db, "main") == 1; }
 
     void exec(const char * sql) {
         auto result = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
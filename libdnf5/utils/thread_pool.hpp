@@ -0,0 +1,105 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 2.1 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBDNF5_UTILS_THREAD_POOL_HPP
+#define LIBDNF5_UTILS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace libdnf5::utils {
+
+/// Fixed size pool of worker threads running the submitted tasks in the order of submission.
+/// The destructor waits until all submitted tasks are finished.
+class ThreadPool {
+public:
+    /// @param num_threads  Number of worker threads, at least one thread is always started.
+    explicit ThreadPool(std::size_t num_threads) {
+        num_threads = std::max<std::size_t>(num_threads, 1);
+        workers.reserve(num_threads);
+        for (std::size_t idx = 0; idx < num_threads; ++idx) {
+            workers.emplace_back(&ThreadPool::worker, this);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        signal_task.notify_all();
+        for (auto & thread : workers) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /// Queues the `task` to be run by a worker thread.
+    /// @return The future of the task result, an exception thrown by the task is stored in it.
+    template <typename TTask>
+    std::future<std::invoke_result_t<TTask>> submit(TTask && task) {
+        auto packaged_task =
+            std::make_shared<std::packaged_task<std::invoke_result_t<TTask>()>>(std::forward<TTask>(task));
+        auto future = packaged_task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([packaged_task]() { (*packaged_task)(); });
+        }
+        signal_task.notify_one();
+        return future;
+    }
+
+private:
+    void worker() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                signal_task.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable signal_task;
+    std::deque<std::function<void()>> tasks;
+    bool stopping{false};
+    std::vector<std::thread> workers;
+};
+
+}  // namespace libdnf5::utils
+
+#endif  // LIBDNF5_UTILS_THREAD_POOL_HPP
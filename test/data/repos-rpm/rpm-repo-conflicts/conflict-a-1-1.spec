@@ -0,0 +1,23 @@
+Name:           conflict-a
+Epoch:          0
+Version:        1
+Release:        1
+Vendor:         dnf5-test
+
+License:        Public Domain
+URL:            http://example.com/
+
+Summary:        A package with a file conflicting with the other conflict-* package
+BuildArch:      noarch
+
+%description
+A package with a file conflicting with the other conflict-* package.
+
+%install
+mkdir -p %{buildroot}/usr/share/conflict
+echo "conflicting file of package conflict-a" > %{buildroot}/usr/share/conflict/file
+
+%files
+/usr/share/conflict/file
+
+%changelog
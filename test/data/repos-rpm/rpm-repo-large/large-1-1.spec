@@ -0,0 +1,39 @@
+%global package_count 200
+%global file_count 20
+
+Name:           large
+Epoch:          0
+Version:        1
+Release:        1
+Vendor:         dnf5-test
+
+License:        Public Domain
+URL:            http://example.com/
+
+Summary:        Packages of a large test transaction
+BuildArch:      noarch
+
+%description
+Packages of a large test transaction, each of them contains a directory with files.
+
+%{lua:
+for i = 1, tonumber(rpm.expand("%{package_count}")) do
+    local name = "large-" .. i
+    print("%package -n " .. name .. "\n")
+    print("Summary: Package " .. i .. " of a large test transaction\n")
+    print("%description -n " .. name .. "\n")
+    print("Package " .. i .. " of a large test transaction.\n")
+    print("%files -n " .. name .. "\n")
+    print("/usr/share/large/" .. i .. "\n")
+end
+}
+
+%install
+for i in $(seq 1 %{package_count}); do
+    mkdir -p %{buildroot}/usr/share/large/$i
+    for j in $(seq 1 %{file_count}); do
+        echo "file $j of package $i" > %{buildroot}/usr/share/large/$i/file-$j
+    done
+done
+
+%changelog
@@ -16,3 +16,5 @@ A dummy package.
 %files
 
 %changelog
+* Mon Jan 01 2024 Joe Black <joe@example.com> - 2-1
+- Second version
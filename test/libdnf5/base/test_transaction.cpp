@@ -52,3 +52,25 @@ void BaseTransactionTest::test_check_gpg_signatures_fail() {
     CPPUNIT_ASSERT(!transaction.check_gpg_signatures());
     CPPUNIT_ASSERT(!transaction.get_gpg_signature_problems().empty());
 }
+
+void BaseTransactionTest::test_download_check_gpg_signatures_per_repo() {
+    add_repo_rpm("rpm-repo1");
+    auto repo2 = add_repo_rpm("rpm-repo2");
+
+    base.get_config().get_gpgcheck_option().set(true);
+    repo2->get_config().get_gpgcheck_option().set(false);
+
+    libdnf5::Goal goal(base);
+    goal.add_rpm_install("one");
+    goal.add_rpm_install("two");
+    auto transaction = goal.resolve();
+
+    // the signatures are checked during the download only for the repository with gpgcheck enabled,
+    // the failed check is repeated and reported by check_gpg_signatures()
+    transaction.download();
+    CPPUNIT_ASSERT(!transaction.check_gpg_signatures());
+    auto problems = transaction.get_gpg_signature_problems();
+    CPPUNIT_ASSERT_EQUAL((size_t)1, problems.size());
+    CPPUNIT_ASSERT(problems[0].find("from repo \"rpm-repo1\"") != std::string::npos);
+    CPPUNIT_ASSERT(problems[0].ends_with("The package is not signed."));
+}
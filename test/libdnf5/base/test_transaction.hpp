@@ -33,6 +33,7 @@ class BaseTransactionTest : public BaseTestCase {
 #ifndef WITH_PERFORMANCE_TESTS
     CPPUNIT_TEST(test_check_gpg_signatures_no_gpgcheck);
     CPPUNIT_TEST(test_check_gpg_signatures_fail);
+    CPPUNIT_TEST(test_download_check_gpg_signatures_per_repo);
 #endif
 
 #ifdef WITH_PERFORMANCE_TESTS
@@ -43,6 +44,7 @@ class BaseTransactionTest : public BaseTestCase {
 public:
     void test_check_gpg_signatures_no_gpgcheck();
     void test_check_gpg_signatures_fail();
+    void test_download_check_gpg_signatures_per_repo();
 };
 
 
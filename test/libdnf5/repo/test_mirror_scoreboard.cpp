@@ -0,0 +1,116 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test_mirror_scoreboard.hpp"
+
+#include "../shared/utils.hpp"
+#include "repo/mirror_scoreboard.hpp"
+
+#include <filesystem>
+#include <optional>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MirrorScoreboardTest);
+
+
+void MirrorScoreboardTest::setUp() {
+    BaseTestCase::setUp();
+    base.get_config().get_mirror_scoreboard_option().set(true);
+}
+
+
+void MirrorScoreboardTest::test_sort_mirrors() {
+    libdnf5::repo::MirrorScoreboard scoreboard(base.get_weak_ptr());
+
+    scoreboard.record_success("http://slow.example.com/repo/", 0.5, 1024 * 1024);
+    scoreboard.record_success("http://fast.example.com/repo", 0.01, 10 * 1024 * 1024);
+    scoreboard.record_failure("http://broken.example.com/repo");
+    scoreboard.record_failure("http://broken.example.com/repo");
+
+    // the mirrors with statistics are ordered by the expected download time, the unknown one keeps its position
+    std::vector<std::string> mirrors{
+        "http://broken.example.com/repo/",
+        "http://unknown.example.com/repo/",
+        "http://slow.example.com/repo/",
+        "http://fast.example.com/repo/"};
+    scoreboard.sort_mirrors(mirrors);
+
+    const std::vector<std::string> expected{
+        "http://fast.example.com/repo/",
+        "http://unknown.example.com/repo/",
+        "http://slow.example.com/repo/",
+        "http://broken.example.com/repo/"};
+    CPPUNIT_ASSERT_EQUAL(expected, mirrors);
+}
+
+
+void MirrorScoreboardTest::test_persistence() {
+    {
+        libdnf5::repo::MirrorScoreboard scoreboard(base.get_weak_ptr());
+        scoreboard.record_success("http://slow.example.com/repo", 0.5, 100 * 1024);
+        scoreboard.record_success("http://fast.example.com/repo", 0.01, 10 * 1024 * 1024);
+        scoreboard.save();
+    }
+
+    CPPUNIT_ASSERT(std::filesystem::exists(
+        std::filesystem::path(base.get_config().get_cachedir_option().get_value()) / "mirror-scoreboard.toml"));
+
+    // a new instance reads the statistics written by the previous one
+    libdnf5::repo::MirrorScoreboard scoreboard(base.get_weak_ptr());
+    std::vector<std::string> mirrors{"http://slow.example.com/repo", "http://fast.example.com/repo"};
+    scoreboard.sort_mirrors(mirrors);
+
+    const std::vector<std::string> expected{"http://fast.example.com/repo", "http://slow.example.com/repo"};
+    CPPUNIT_ASSERT_EQUAL(expected, mirrors);
+
+    // with the option disabled the order is kept
+    base.get_config().get_mirror_scoreboard_option().set(false);
+    std::vector<std::string> unsorted{"http://slow.example.com/repo", "http://fast.example.com/repo"};
+    scoreboard.sort_mirrors(unsorted);
+    CPPUNIT_ASSERT_EQUAL(std::string("http://slow.example.com/repo"), unsorted.front());
+}
+
+
+void MirrorScoreboardTest::test_merge_on_save() {
+    // two instances, like two processes, load the statistics before any of them saves
+    libdnf5::repo::MirrorScoreboard first(base.get_weak_ptr());
+    libdnf5::repo::MirrorScoreboard second(base.get_weak_ptr());
+    first.record_failure("http://first.example.com/repo");
+    second.record_failure("http://second.example.com/repo");
+    first.save();
+    second.save();
+
+    // the save of the second instance keeps the failure saved by the first one, both failed mirrors
+    // are known and ordered after a mirror with a success
+    libdnf5::repo::MirrorScoreboard scoreboard(base.get_weak_ptr());
+    scoreboard.record_success("http://good.example.com/repo", std::nullopt, std::nullopt);
+    std::vector<std::string> mirrors{
+        "http://first.example.com/repo", "http://second.example.com/repo", "http://good.example.com/repo"};
+    scoreboard.sort_mirrors(mirrors);
+    CPPUNIT_ASSERT_EQUAL(std::string("http://good.example.com/repo"), mirrors.front());
+}
+
+
+void MirrorScoreboardTest::test_get_mirror() {
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("http://example.com/repo"),
+        libdnf5::repo::MirrorScoreboard::get_mirror(
+            "http://example.com/repo/Packages/p/pkg.rpm", "Packages/p/pkg.rpm"));
+    CPPUNIT_ASSERT_EQUAL(
+        std::string(), libdnf5::repo::MirrorScoreboard::get_mirror("http://example.com/repo/other.rpm", "pkg.rpm"));
+}
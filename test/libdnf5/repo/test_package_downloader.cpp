@@ -28,6 +28,7 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <libdnf5/repo/package_downloader.hpp>
 #include <libdnf5/rpm/package_query.hpp>
 
+#include <algorithm>
 #include <filesystem>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PackageDownloaderTest);
@@ -67,6 +68,24 @@ public:
     int mirror_failure_cnt = 0;
 };
 
+class DownloadOrderCallbacks : public libdnf5::repo::DownloadCallbacks {
+public:
+    void * add_new_download(
+        [[maybe_unused]] void * user_data, const char * description, [[maybe_unused]] double total_to_download)
+        override {
+        descriptions.emplace_back(description);
+        return reinterpret_cast<void *>(descriptions.size());
+    }
+
+    int end(void * user_cb_data, [[maybe_unused]] TransferStatus status, [[maybe_unused]] const char * msg) override {
+        finished.push_back(descriptions[reinterpret_cast<std::size_t>(user_cb_data) - 1]);
+        return 0;
+    }
+
+    std::vector<std::string> descriptions;
+    std::vector<std::string> finished;
+};
+
 void PackageDownloaderTest::test_package_downloader() {
     auto repo = add_repo_rpm("rpm-repo1");
 
@@ -127,3 +146,34 @@ void PackageDownloaderTest::test_package_downloader_temp_files_memory() {
 
     CPPUNIT_ASSERT_EQUAL(expected, memory.get_files());
 }
+
+void PackageDownloaderTest::test_package_downloader_largest_first() {
+    add_repo_rpm("rpm-repo1");
+
+    // with a single connection the packages are downloaded one by one in the order they are started
+    base.get_config().get_max_parallel_downloads_option().set(1);
+
+    libdnf5::rpm::PackageQuery query(base);
+    query.filter_name({"one"});
+    CPPUNIT_ASSERT_EQUAL((size_t)4, query.size());
+
+    std::vector<libdnf5::rpm::Package> packages(query.begin(), query.end());
+
+    auto downloader = libdnf5::repo::PackageDownloader(base);
+    auto cbs_unique_ptr = std::make_unique<DownloadOrderCallbacks>();
+    auto cbs = cbs_unique_ptr.get();
+    base.set_download_callbacks(std::move(cbs_unique_ptr));
+    for (const auto & package : packages) {
+        downloader.add(package);
+    }
+    downloader.download();
+
+    std::stable_sort(packages.begin(), packages.end(), [](const auto & lhs, const auto & rhs) {
+        return lhs.get_download_size() > rhs.get_download_size();
+    });
+    std::vector<std::string> expected;
+    for (const auto & package : packages) {
+        expected.push_back(package.get_full_nevra());
+    }
+    CPPUNIT_ASSERT_EQUAL(expected, cbs->finished);
+}
@@ -29,11 +29,13 @@ class PackageDownloaderTest : public BaseTestCase {
     CPPUNIT_TEST_SUITE(PackageDownloaderTest);
     CPPUNIT_TEST(test_package_downloader);
     CPPUNIT_TEST(test_package_downloader_temp_files_memory);
+    CPPUNIT_TEST(test_package_downloader_largest_first);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void test_package_downloader();
     void test_package_downloader_temp_files_memory();
+    void test_package_downloader_largest_first();
 };
 
 #endif
@@ -0,0 +1,154 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test_package_store.hpp"
+
+#include <libdnf5/base/base.hpp>
+#include <libdnf5/repo/package_downloader.hpp>
+#include <libdnf5/repo/package_store.hpp>
+#include <libdnf5/rpm/package_query.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PackageStoreTest);
+
+
+namespace {
+
+class DownloadCallbacks : public libdnf5::repo::DownloadCallbacks {
+public:
+    int end([[maybe_unused]] void * user_cb_data, TransferStatus status, [[maybe_unused]] const char * msg) override {
+        end_status = status;
+        return 0;
+    }
+
+    TransferStatus end_status = TransferStatus::ERROR;
+};
+
+}  // namespace
+
+
+void PackageStoreTest::setUp() {
+    BaseTestCase::setUp();
+    base.get_config().get_package_store_dir_option().set(temp->get_path() / "package-store");
+}
+
+
+void PackageStoreTest::test_package_store() {
+    auto repo = add_repo_rpm("rpm-repo1");
+
+    libdnf5::rpm::PackageQuery query(base);
+    query.filter_nevra({"one-2-1.noarch"});
+    CPPUNIT_ASSERT_EQUAL((size_t)1, query.size());
+    auto package = *query.begin();
+
+    libdnf5::repo::PackageStore store(base);
+    CPPUNIT_ASSERT(store.is_enabled());
+    CPPUNIT_ASSERT(!store.contains(package));
+
+    auto cbs_unique_ptr = std::make_unique<DownloadCallbacks>();
+    auto cbs = cbs_unique_ptr.get();
+    base.set_download_callbacks(std::move(cbs_unique_ptr));
+
+    libdnf5::repo::PackageDownloader downloader(base);
+    downloader.add(package);
+    downloader.download();
+    CPPUNIT_ASSERT_EQUAL(DownloadCallbacks::TransferStatus::SUCCESSFUL, cbs->end_status);
+    CPPUNIT_ASSERT(store.contains(package));
+
+    // the package removed from the repository cache is still available in the store
+    CPPUNIT_ASSERT(std::filesystem::remove(package.get_package_path()));
+    CPPUNIT_ASSERT(package.is_available_locally());
+
+    // and it is linked back instead of being downloaded again
+    libdnf5::repo::PackageDownloader downloader2(base);
+    downloader2.add(package);
+    downloader2.download();
+    CPPUNIT_ASSERT_EQUAL(DownloadCallbacks::TransferStatus::ALREADYEXISTS, cbs->end_status);
+    CPPUNIT_ASSERT(std::filesystem::exists(package.get_package_path()));
+}
+
+
+void PackageStoreTest::test_package_store_evict() {
+    add_repo_rpm("rpm-repo1");
+
+    libdnf5::rpm::PackageQuery query(base);
+    query.filter_name({"one"});
+    CPPUNIT_ASSERT_EQUAL((size_t)4, query.size());
+
+    libdnf5::repo::PackageStore store(base);
+    libdnf5::repo::PackageDownloader downloader(base);
+    for (const auto & package : query) {
+        downloader.add(package);
+    }
+    downloader.download();
+    for (const auto & package : query) {
+        CPPUNIT_ASSERT(store.contains(package));
+    }
+
+    // a budget smaller than any package evicts all of them, the repository cache is not affected
+    base.get_config().get_package_store_max_size_option().set(1);
+    auto status = store.evict();
+    CPPUNIT_ASSERT_EQUAL((size_t)4, status.files_removed);
+    for (const auto & package : query) {
+        CPPUNIT_ASSERT(!store.contains(package));
+        CPPUNIT_ASSERT(package.is_available_locally());
+    }
+
+    store.remove_packages();
+    CPPUNIT_ASSERT(std::filesystem::is_empty(temp->get_path() / "package-store"));
+}
+
+
+void PackageStoreTest::test_package_store_corrupted() {
+    add_repo_rpm("rpm-repo1");
+
+    libdnf5::rpm::PackageQuery query(base);
+    query.filter_nevra({"one-2-1.noarch"});
+    CPPUNIT_ASSERT_EQUAL((size_t)1, query.size());
+    auto package = *query.begin();
+
+    libdnf5::repo::PackageStore store(base);
+    libdnf5::repo::PackageDownloader downloader(base);
+    downloader.add(package);
+    downloader.download();
+    CPPUNIT_ASSERT(store.contains(package));
+
+    // corrupt the package in place, the file in the repository cache shares the data with the stored one
+    auto package_path = package.get_package_path();
+    {
+        std::fstream file(package_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(0);
+        file.put('x');
+    }
+    // the modification time tells librepo that the cached checksum is no longer valid
+    std::filesystem::last_write_time(
+        package_path, std::filesystem::last_write_time(package_path) + std::chrono::seconds(1));
+    CPPUNIT_ASSERT(!store.contains(package));
+    CPPUNIT_ASSERT(!package.is_available_locally());
+
+    // the package is downloaded again and replaces the corrupted one in the store
+    libdnf5::repo::PackageDownloader downloader2(base);
+    downloader2.add(package);
+    downloader2.download();
+    CPPUNIT_ASSERT(package.is_cached());
+    CPPUNIT_ASSERT(store.contains(package));
+}
@@ -0,0 +1,43 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBDNF5_TEST_REPO_PACKAGE_STORE_HPP
+#define LIBDNF5_TEST_REPO_PACKAGE_STORE_HPP
+
+#include "../shared/base_test_case.hpp"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+
+class PackageStoreTest : public BaseTestCase {
+    CPPUNIT_TEST_SUITE(PackageStoreTest);
+    CPPUNIT_TEST(test_package_store);
+    CPPUNIT_TEST(test_package_store_evict);
+    CPPUNIT_TEST(test_package_store_corrupted);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+
+    void test_package_store();
+    void test_package_store_evict();
+    void test_package_store_corrupted();
+};
+
+#endif  // LIBDNF5_TEST_REPO_PACKAGE_STORE_HPP
@@ -19,11 +19,19 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "test_repo.hpp"
 
+#include "../shared/http_server.hpp"
+#include "../shared/utils.hpp"
 #include "utils/string.hpp"
 
 #include <libdnf5/base/base.hpp>
+#include <libdnf5/conf/const.hpp>
+#include <libdnf5/repo/repo_cache.hpp>
+#include <libdnf5/rpm/package_query.hpp>
 
+#include <chrono>
 #include <filesystem>
+#include <functional>
+#include <set>
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RepoTest);
@@ -138,3 +146,219 @@ void RepoTest::test_load_repo_nonexistent() {
     repos.filter_id(repoid);
     CPPUNIT_ASSERT_THROW(repo_sack->update_and_load_repos(repos), libdnf5::repo::RepoDownloadError);
 }
+
+namespace {
+
+// Loads the repositories `repoids` from the cache of `base` into `base2`, a new Base sharing the installroot
+// and the cachedir. The `configure` function can change the configuration of `base2` before its setup.
+// Returns the number of packages in the new sack.
+std::size_t load_repos_from_shared_cache(
+    libdnf5::Base & base,
+    libdnf5::Base & base2,
+    const std::vector<std::string> & repoids,
+    const std::function<void(libdnf5::ConfigMain & config)> & configure = nullptr) {
+    auto & config = base2.get_config();
+    config.get_installroot_option().set(base.get_config().get_installroot_option().get_value());
+    config.get_cachedir_option().set(base.get_config().get_cachedir_option().get_value());
+    config.get_optional_metadata_types_option().set(libdnf5::OPTIONAL_METADATA_TYPES);
+    if (configure) {
+        configure(config);
+    }
+    base2.get_vars()->set("arch", "x86_64");
+    base2.setup();
+
+    auto repo_sack2 = base2.get_repo_sack();
+    for (const auto & repoid : repoids) {
+        auto repo = repo_sack2->create_repo(repoid);
+        repo->get_config().get_baseurl_option().set("file://" PROJECT_SOURCE_DIR "/test/data/repos-repomd/" + repoid);
+    }
+    libdnf5::repo::RepoQuery repos2(base2);
+    repos2.filter_id(repoids);
+    repo_sack2->update_and_load_repos(repos2);
+
+    return libdnf5::rpm::PackageQuery(base2).size();
+}
+
+// Returns the downloaded metadata and the solv cache files of the repository.
+std::vector<std::filesystem::path> get_repo_cache_files(const libdnf5::repo::RepoWeakPtr & repo) {
+    std::vector<std::filesystem::path> paths;
+    const std::filesystem::path cachedir(repo->get_cachedir());
+    for (const auto * subdir : {"repodata", "solv"}) {
+        for (const auto & entry : std::filesystem::directory_iterator(cachedir / subdir)) {
+            if (entry.is_regular_file()) {
+                paths.push_back(entry.path());
+            }
+        }
+    }
+    return paths;
+}
+
+}  // namespace
+
+
+void RepoTest::test_load_expired_repos() {
+    const std::vector<std::string> repoids{"repomd-repo1", "repomd-comps-core", "repomd-comps-standard"};
+    base.get_config().get_max_parallel_metadata_downloads_option().set(2);
+
+    // download metadata of all the repositories into the cache and mark them expired
+    for (const auto & repoid : repoids) {
+        add_repo_repomd(repoid, false);
+    }
+    libdnf5::repo::RepoQuery repos(base);
+    repos.filter_id(repoids);
+    repo_sack->update_and_load_repos(repos);
+
+    // a re-download or a rewrite of the cache files would change their modification time
+    const auto old_time = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24);
+    std::vector<std::filesystem::path> cache_files;
+    for (const auto & repo : repos) {
+        libdnf5::repo::RepoCache repo_cache(base, repo->get_cachedir());
+        repo_cache.write_attribute(libdnf5::repo::RepoCache::ATTRIBUTE_EXPIRED);
+        for (const auto & path : get_repo_cache_files(repo)) {
+            std::filesystem::last_write_time(path, old_time);
+            cache_files.push_back(path);
+        }
+    }
+    CPPUNIT_ASSERT(!cache_files.empty());
+
+    // a new base sharing the cache has to revalidate the expired repositories
+    libdnf5::Base base2;
+    load_repos_from_shared_cache(base, base2, repoids, [](libdnf5::ConfigMain & config) {
+        config.get_max_parallel_metadata_downloads_option().set(2);
+    });
+
+    libdnf5::repo::RepoQuery repos2(base2);
+    repos2.filter_id(repoids);
+    CPPUNIT_ASSERT_EQUAL(repoids.size(), repos2.size());
+    for (const auto & repo : repos2) {
+        libdnf5::repo::RepoCache repo_cache(base2, repo->get_cachedir());
+        CPPUNIT_ASSERT(!repo_cache.is_attribute(libdnf5::repo::RepoCache::ATTRIBUTE_EXPIRED));
+        CPPUNIT_ASSERT(!repo->is_expired());
+    }
+
+    // the repositories were in sync, neither the metadata nor the solv files were fetched again
+    for (const auto & path : cache_files) {
+        CPPUNIT_ASSERT_MESSAGE(path.native(), std::filesystem::last_write_time(path) == old_time);
+    }
+}
+
+
+void RepoTest::test_load_lazy_filelists() {
+    const auto lazy_cachedir = base.get_config().get_cachedir_option().get_value() + "-lazy";
+    auto configure_lazy = [&](libdnf5::ConfigMain & config) {
+        config.get_cachedir_option().set(lazy_cachedir);
+        config.get_optional_metadata_types_option().set(
+            std::set<std::string>{libdnf5::METADATA_TYPE_OTHER, libdnf5::METADATA_TYPE_UPDATEINFO});
+        config.get_lazy_filelists_option().set(true);
+    };
+
+    // the filelists are not loaded with the repo, the loaded filelists are written to the solv cache
+    libdnf5::Base lazy_base;
+    load_repos_from_shared_cache(base, lazy_base, {"repomd-repo1"}, configure_lazy);
+    libdnf5::repo::RepoQuery lazy_repos(lazy_base);
+    lazy_repos.filter_id("repomd-repo1");
+    const auto filelists_solvx =
+        std::filesystem::path((*lazy_repos.begin())->get_cachedir()) / "solv" / "repomd-repo1-filelists.solvx";
+    CPPUNIT_ASSERT(!std::filesystem::exists(filelists_solvx));
+
+    // preparing the provides does not need the filelists, there are no file dependencies in the repo
+    libdnf5::rpm::PackageQuery provides_query(lazy_base);
+    provides_query.filter_provides({"pkg"});
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1), provides_query.size());
+    CPPUNIT_ASSERT(!std::filesystem::exists(filelists_solvx));
+
+    // the file query loads the filelists from the downloaded xml, the advisories are already in the repo
+    libdnf5::rpm::PackageQuery lazy_query(lazy_base);
+    lazy_query.filter_file({"/etc/pkg.conf"});
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1), lazy_query.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("pkg-1.2-3.x86_64"), (*lazy_query.begin()).get_nevra());
+    CPPUNIT_ASSERT(std::filesystem::exists(filelists_solvx));
+
+    // the file list is loaded from the solv cache written by the previous load
+    libdnf5::Base cached_lazy_base;
+    load_repos_from_shared_cache(base, cached_lazy_base, {"repomd-repo1"}, configure_lazy);
+    libdnf5::rpm::PackageQuery cached_lazy_query(cached_lazy_base);
+    cached_lazy_query.filter_name({"pkg"});
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1), cached_lazy_query.size());
+    const std::vector<std::string> expected_files{"/etc/pkg.conf", "/etc/pkg.conf.d"};
+    CPPUNIT_ASSERT_EQUAL(expected_files, (*cached_lazy_query.begin()).get_files());
+}
+
+
+void RepoTest::test_revalidate_repomd() {
+    HttpServer server(PROJECT_SOURCE_DIR "/test/data/repos-repomd/repomd-repo1");
+    const auto cachedir = base.get_config().get_cachedir_option().get_value() + "-http";
+
+    // loads the repo from the server, with `expire` the cached metadata are marked expired before loading
+    auto load_repo = [&](bool expire) {
+        libdnf5::Base http_base;
+        http_base.get_config().get_installroot_option().set(base.get_config().get_installroot_option().get_value());
+        http_base.get_config().get_cachedir_option().set(cachedir);
+        http_base.get_vars()->set("arch", "x86_64");
+        http_base.setup();
+
+        auto repo = http_base.get_repo_sack()->create_repo("repomd-repo1");
+        repo->get_config().get_baseurl_option().set(server.get_url());
+        libdnf5::repo::RepoCache cache(http_base, repo->get_config().get_cachedir());
+        if (expire) {
+            cache.write_attribute(libdnf5::repo::RepoCache::ATTRIBUTE_EXPIRED);
+        }
+        http_base.get_repo_sack()->update_and_load_enabled_repos(false);
+        CPPUNIT_ASSERT(!repo->is_expired());
+        return cache.is_attribute(libdnf5::repo::RepoCache::ATTRIBUTE_REPOMD_ETAG);
+    };
+
+    auto repomd_statuses = [&]() {
+        std::vector<std::string> statuses;
+        for (const auto & request : server.get_requests()) {
+            if (request.path == "/repodata/repomd.xml") {
+                statuses.push_back((request.conditional ? "conditional " : "") + std::to_string(request.status));
+            }
+        }
+        return statuses;
+    };
+
+    // the first download does not store the validators
+    CPPUNIT_ASSERT(!load_repo(false));
+
+    // the first sync check gets the validators from the aborted request, librepo downloads the repomd
+    // and the validators are stored after comparing it
+    CPPUNIT_ASSERT(load_repo(true));
+
+    // the next sync check is answered by "304 Not Modified"
+    CPPUNIT_ASSERT(load_repo(true));
+
+    // the repomd is downloaded by librepo, the first sync check requests it twice
+    const std::vector<std::string> expected{"200", "200", "200", "conditional 304"};
+    CPPUNIT_ASSERT_EQUAL(expected, repomd_statuses());
+}
+
+
+void RepoTest::test_add_cmdline_packages() {
+    const std::string data_dir = PROJECT_BINARY_DIR "/test/data/";
+    const std::vector<std::string> paths{
+        data_dir + "repos-rpm/rpm-repo1/one-2-1.noarch.rpm",
+        data_dir + "cmdline-rpms/cmdline-1.2-3.noarch.rpm",
+        data_dir + "repos-rpm/rpm-repo1/one-1-1.noarch.rpm",
+        data_dir + "cmdline-rpms/cmdline-1.2-3.noarch.rpm"};
+
+    // the checksums are computed in parallel, each input path still maps to the package read from it
+    auto path_to_package = repo_sack->add_cmdline_packages(paths, true);
+    CPPUNIT_ASSERT_EQUAL(std::size_t{3}, path_to_package.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("one-0:2-1.noarch"), path_to_package.at(paths[0]).get_full_nevra());
+    CPPUNIT_ASSERT_EQUAL(std::string("cmdline-0:1.2-3.noarch"), path_to_package.at(paths[1]).get_full_nevra());
+    CPPUNIT_ASSERT_EQUAL(std::string("one-0:1-1.noarch"), path_to_package.at(paths[2]).get_full_nevra());
+    for (const auto & [path, package] : path_to_package) {
+        CPPUNIT_ASSERT_EQUAL(path, package.get_package_path());
+        CPPUNIT_ASSERT(!package.get_hdr_checksum().get_checksum().empty());
+        CPPUNIT_ASSERT_EQUAL(std::string("sha256"), package.get_checksum().get_type_str());
+    }
+
+    // the packages are appended to the pool in the order of the input paths
+    CPPUNIT_ASSERT(path_to_package.at(paths[0]).get_id().id < path_to_package.at(paths[1]).get_id().id);
+    CPPUNIT_ASSERT(path_to_package.at(paths[1]).get_id().id < path_to_package.at(paths[2]).get_id().id);
+
+    libdnf5::rpm::PackageQuery query(base);
+    query.filter_repo_id({"@commandline"});
+    CPPUNIT_ASSERT_EQUAL(std::size_t{3}, query.size());
+}
@@ -30,12 +30,20 @@ class RepoTest : public BaseTestCase {
     CPPUNIT_TEST(test_load_system_repo);
     CPPUNIT_TEST(test_load_repo);
     CPPUNIT_TEST(test_load_repo_nonexistent);
+    CPPUNIT_TEST(test_load_expired_repos);
+    CPPUNIT_TEST(test_load_lazy_filelists);
+    CPPUNIT_TEST(test_revalidate_repomd);
+    CPPUNIT_TEST(test_add_cmdline_packages);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void test_load_system_repo();
     void test_load_repo();
     void test_load_repo_nonexistent();
+    void test_load_expired_repos();
+    void test_load_lazy_filelists();
+    void test_revalidate_repomd();
+    void test_add_cmdline_packages();
 };
 
 #endif
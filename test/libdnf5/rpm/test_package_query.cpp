@@ -20,12 +20,16 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "test_package_query.hpp"
 
+#include "../shared/private_accessor.hpp"
 #include "../shared/utils.hpp"
+#include "rpm/package_set_impl.hpp"
 
+#include <libdnf5/conf/const.hpp>
 #include <libdnf5/rpm/package_query.hpp>
 #include <libdnf5/rpm/package_set.hpp>
 
 #include <filesystem>
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -42,6 +46,13 @@ public:
     TestPackage(const libdnf5::BaseWeakPtr & base, PackageId id) : libdnf5::rpm::Package(base, id) {}
 };
 
+create_private_getter_template;
+create_getter(p_impl, &libdnf5::rpm::PackageSet::p_impl);
+
+bool has_deferred_filters(const PackageSet & set) {
+    return (set.*get(p_impl{}))->has_deferred_filters();
+}
+
 }  // namespace
 
 
@@ -293,6 +304,85 @@ void RpmPackageQueryTest::test_filter_name_packgset() {
     CPPUNIT_ASSERT_EQUAL(expected2, to_vector(query2));
 }
 
+void RpmPackageQueryTest::test_filter_name_index() {
+    add_repo_solv("solv-repo1");
+
+    PackageQuery query1(base);
+    query1.filter_name({"pkg-libs"});
+    CPPUNIT_ASSERT_EQUAL((size_t)3, query1.size());
+
+    PackageQuery query2(base);
+    query2.filter_name({"pkg-*"}, libdnf5::sack::QueryCmp::GLOB);
+    std::vector<Package> expected = {
+        get_pkg("pkg-libs-0:1.2-3.x86_64"), get_pkg("pkg-libs-1:1.2-4.x86_64"), get_pkg("pkg-libs-1:1.3-4.x86_64")};
+    CPPUNIT_ASSERT_EQUAL(expected, to_vector(query2));
+
+    // the name indexes are rebuilt after new packages were added to the pool
+    add_repo_solv("solv-24pkgs");
+
+    PackageQuery query3(base);
+    query3.filter_name({"pkg"});
+    CPPUNIT_ASSERT_EQUAL((size_t)26, query3.size());
+
+    // only the packages of the query match the glob
+    PackageQuery query4(base);
+    query4.filter_arch({"x86_64"});
+    query4.filter_name({"pk*"}, libdnf5::sack::QueryCmp::GLOB);
+    expected = {
+        get_pkg("pkg-0:1.2-3.x86_64"),
+        get_pkg("pkg-libs-0:1.2-3.x86_64"),
+        get_pkg("pkg-libs-1:1.2-4.x86_64"),
+        get_pkg("pkg-libs-1:1.3-4.x86_64")};
+    CPPUNIT_ASSERT_EQUAL(expected, to_vector(query4));
+
+    PackageQuery query5(base);
+    query5.filter_nevra({"pkg-1-10.noarch"});
+    CPPUNIT_ASSERT_EQUAL((size_t)1, query5.size());
+
+    PackageQuery query6(base);
+    query6.filter_nevra({"pkg-1-20.noarch"}, libdnf5::sack::QueryCmp::GT);
+    CPPUNIT_ASSERT_EQUAL((size_t)4, query6.size());
+}
+
+void RpmPackageQueryTest::test_sorted_solvables_update() {
+    add_repo_solv("solv-repo1");
+
+    // fill the caches of the sorted solvables
+    PackageQuery query1(base);
+    query1.filter_nevra({"pkg-libs-1:1.3-4.x86_64"});
+    CPPUNIT_ASSERT_EQUAL((size_t)1, query1.size());
+    PackageQuery query2(base);
+    query2.filter_name({"PKG"}, libdnf5::sack::QueryCmp::IEXACT);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, query2.size());
+    PackageQuery query_libs(base);
+    query_libs.filter_name({"pkg-libs"});
+    CPPUNIT_ASSERT_EQUAL((size_t)3, query_libs.size());
+
+    // the new solvables are merged into the caches
+    add_repo_solv("solv-24pkgs");
+
+    PackageQuery query3(base);
+    query3.filter_nevra({"pkg-libs-1:1.3-4.x86_64", "pkg-1-24.noarch"});
+    std::vector<Package> expected = {get_pkg("pkg-0:1-24.noarch"), get_pkg("pkg-libs-1:1.3-4.x86_64")};
+    CPPUNIT_ASSERT_EQUAL(expected, to_vector(query3));
+
+    PackageQuery query4(base);
+    query4.filter_name({"PKG"}, libdnf5::sack::QueryCmp::IEXACT);
+    CPPUNIT_ASSERT_EQUAL((size_t)26, query4.size());
+
+    PackageQuery query5(base);
+    query5.filter_nevra({"pkg-0:1.2-3.x86_64"}, libdnf5::sack::QueryCmp::LT);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, query5.size());
+
+    // the ranges of the name index are shifted by the merged solvables
+    PackageQuery query6(base);
+    query6.filter_name({"pkg"});
+    CPPUNIT_ASSERT_EQUAL((size_t)26, query6.size());
+    PackageQuery query7(base);
+    query7.filter_name({"pkg-libs"});
+    CPPUNIT_ASSERT_EQUAL((size_t)3, query7.size());
+}
+
 void RpmPackageQueryTest::test_filter_nevra_packgset() {
     add_repo_solv("solv-repo1");
 
@@ -827,3 +917,168 @@ void RpmPackageQueryTest::test_filter_provides_performance() {
         query.filter_provides({"prv-all"});
     }
 }
+
+
+void RpmPackageQueryTest::test_deferred_filters() {
+    add_repo_solv("solv-repo1");
+    add_repo_solv("solv-24pkgs");
+
+    using libdnf5::sack::QueryCmp;
+    auto pkg_libs = [this]() {
+        PackageQuery query(base);
+        query.filter_name({"pkg-libs"});
+        return query;
+    };
+
+    // each chain of filters must give the same result with the deferred filters as with the immediate ones
+    std::vector<std::function<void(PackageQuery &)>> chains = {
+        [](PackageQuery & query) {
+            query.filter_provides({"foo"}, QueryCmp::NEQ);
+            query.filter_requires({"foo"}, QueryCmp::NEQ);
+            query.filter_name({"pkg"});
+            query.filter_epoch({"0"});
+            query.filter_version({"1.2"});
+            query.filter_release({"3"});
+            query.filter_arch({"x86_64"});
+        },
+        [](PackageQuery & query) {
+            query.filter_provides({"pkg*"}, QueryCmp::GLOB);
+            query.filter_name({"pkg-libs"}, QueryCmp::NEQ);
+        },
+        [](PackageQuery & query) {
+            query.filter_description({"pkg"}, QueryCmp::NOT_CONTAINS);
+            query.filter_summary({"*"}, QueryCmp::GLOB);
+            query.filter_file({"/usr/bin/*"}, QueryCmp::NOT_GLOB);
+            query.filter_repo_id({"solv-repo1"});
+        },
+        [](PackageQuery & query) {
+            query.filter_requires({"pkg-l*"}, QueryCmp::GLOB);
+            query.filter_nevra({"pkg-0:1.2-3.x86_64", "pkg-libs-1:1.3-4.x86_64"});
+        },
+        [](PackageQuery & query) {
+            query.filter_evr({"1:1.2-4"}, QueryCmp::GTE);
+            query.filter_name({"pkg*"}, QueryCmp::GLOB);
+            query.filter_arch({"src"}, QueryCmp::NEQ);
+            query.filter_available();
+        },
+        [](PackageQuery & query) {
+            // filter_latest_evr() depends on the other packages, the deferred filters are run before it
+            query.filter_provides({"pkg-libs"});
+            query.filter_repo_id({"solv-repo1"});
+            query.filter_latest_evr();
+            query.filter_arch({"x86_64"});
+        },
+        [pkg_libs](PackageQuery & query) {
+            query.filter_name(pkg_libs(), QueryCmp::NEQ);
+            query.filter_requires(pkg_libs());
+        },
+        [](PackageQuery & query) {
+            query.filter_installed();
+            query.filter_name({"pkg"});
+        },
+        [pkg_libs](PackageQuery & query) {
+            query.filter_name({"pkg"}, QueryCmp::NEQ);
+            query -= pkg_libs();
+            query.filter_release({"4"}, QueryCmp::NEQ);
+        },
+    };
+
+    for (std::size_t idx = 0; idx < chains.size(); ++idx) {
+        PackageQuery query(base);
+        chains[idx](query);
+
+        PackageQuery deferred_query(base);
+        deferred_query.set_defer_filters(true);
+        chains[idx](deferred_query);
+
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("chain " + std::to_string(idx), to_vector(query), to_vector(deferred_query));
+    }
+}
+
+
+void RpmPackageQueryTest::test_deferred_filters_evaluation() {
+    add_repo_solv("solv-repo1");
+
+    PackageQuery query(base);
+    CPPUNIT_ASSERT(!query.get_defer_filters());
+    query.set_defer_filters(true);
+    CPPUNIT_ASSERT(query.get_defer_filters());
+
+    // the filters are recorded, the first access runs them
+    query.filter_release({"3"});
+    query.filter_name({"pkg-libs"});
+    CPPUNIT_ASSERT(has_deferred_filters(query));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, query.size());
+    CPPUNIT_ASSERT(!has_deferred_filters(query));
+    std::vector<Package> expected = {get_pkg("pkg-libs-0:1.2-3.x86_64")};
+    CPPUNIT_ASSERT_EQUAL(expected, to_vector(query));
+
+    // copying runs them, copies inherit the setting
+    query.filter_arch({"x86_64"});
+    CPPUNIT_ASSERT(has_deferred_filters(query));
+    PackageQuery copy(query);
+    CPPUNIT_ASSERT(copy.get_defer_filters());
+    CPPUNIT_ASSERT(!has_deferred_filters(query));
+    CPPUNIT_ASSERT(!has_deferred_filters(copy));
+    CPPUNIT_ASSERT_EQUAL(expected, to_vector(copy));
+
+    // so does assigning to a package set
+    query.filter_arch({"src"});
+    PackageSet set(base);
+    set = query;
+    CPPUNIT_ASSERT(!has_deferred_filters(query));
+    CPPUNIT_ASSERT(set.empty());
+
+    // clearing drops the recorded filters
+    query.filter_name({"pkg"});
+    query.clear();
+    CPPUNIT_ASSERT(!has_deferred_filters(query));
+    CPPUNIT_ASSERT(query.empty());
+
+    // the arguments are checked when a filter is recorded, the query keeps its other filters
+    PackageQuery invalid(base);
+    invalid.set_defer_filters(true);
+    invalid.filter_name({"pkg"});
+    CPPUNIT_ASSERT_THROW(invalid.filter_location({"*"}, libdnf5::sack::QueryCmp::GLOB), libdnf5::AssertionError);
+    CPPUNIT_ASSERT_THROW(invalid.filter_arch({"x86_64"}, libdnf5::sack::QueryCmp::IEXACT), libdnf5::AssertionError);
+    CPPUNIT_ASSERT(has_deferred_filters(invalid));
+    CPPUNIT_ASSERT_EQUAL((size_t)2, invalid.size());
+
+    // a filter by a package set uses the packages of the set at the time the filter was recorded
+    PackageSet names(base);
+    names.add(get_pkg("pkg-libs-0:1.2-3.x86_64"));
+    PackageQuery by_set(base);
+    by_set.set_defer_filters(true);
+    by_set.filter_name(names);
+    names.clear();
+    CPPUNIT_ASSERT_EQUAL((size_t)3, by_set.size());
+}
+
+
+void RpmPackageQueryTest::test_deferred_filters_failure() {
+    // the filelists are loaded when the deferred file filter is run, the downloaded filelists are removed
+    base.get_config().get_optional_metadata_types_option().set(std::set<std::string>{libdnf5::METADATA_TYPE_OTHER});
+    base.get_config().get_lazy_filelists_option().set(true);
+    auto repo = add_repo_repomd("repomd-repo1");
+    for (const auto & entry :
+         std::filesystem::directory_iterator(std::filesystem::path(repo->get_cachedir()) / "repodata")) {
+        if (entry.path().filename().string().find("filelists") != std::string::npos) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+
+    PackageQuery query(base);
+    query.set_defer_filters(true);
+    query.filter_name({"pkg"});
+    query.filter_file({"/etc/pkg.conf"});
+    CPPUNIT_ASSERT(has_deferred_filters(query));
+
+    // the error is thrown by the access, the query keeps its content and the filters
+    CPPUNIT_ASSERT_THROW(query.size(), std::filesystem::filesystem_error);
+    CPPUNIT_ASSERT(has_deferred_filters(query));
+
+    // the noexcept methods of a package set do not run the filters
+    const PackageSet & set = query;
+    CPPUNIT_ASSERT(!set.empty());
+    CPPUNIT_ASSERT(has_deferred_filters(query));
+}
@@ -36,6 +36,8 @@ class RpmPackageQueryTest : public BaseTestCase {
     CPPUNIT_TEST(test_filter_earliest_evr);
     CPPUNIT_TEST(test_filter_name);
     CPPUNIT_TEST(test_filter_name_packgset);
+    CPPUNIT_TEST(test_filter_name_index);
+    CPPUNIT_TEST(test_sorted_solvables_update);
     CPPUNIT_TEST(test_filter_nevra_packgset);
     CPPUNIT_TEST(test_filter_nevra_packgset_cmp);
     CPPUNIT_TEST(test_filter_name_arch);
@@ -52,6 +54,9 @@ class RpmPackageQueryTest : public BaseTestCase {
     CPPUNIT_TEST(test_update);
     CPPUNIT_TEST(test_intersection);
     CPPUNIT_TEST(test_difference);
+    CPPUNIT_TEST(test_deferred_filters);
+    CPPUNIT_TEST(test_deferred_filters_evaluation);
+    CPPUNIT_TEST(test_deferred_filters_failure);
 #endif
 
 #ifdef WITH_PERFORMANCE_TESTS
@@ -69,6 +74,8 @@ public:
     void test_filter_earliest_evr();
     void test_filter_name();
     void test_filter_name_packgset();
+    void test_filter_name_index();
+    void test_sorted_solvables_update();
     void test_filter_nevra_packgset();
     void test_filter_nevra_packgset_cmp();
     void test_filter_name_arch();
@@ -85,6 +92,9 @@ public:
     void test_update();
     void test_intersection();
     void test_difference();
+    void test_deferred_filters();
+    void test_deferred_filters_evaluation();
+    void test_deferred_filters_failure();
 
     void test_filter_latest_evr_performance();
     void test_filter_provides_performance();
@@ -20,9 +20,16 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "test_package_set.hpp"
 
+#include "../shared/private_accessor.hpp"
+#include "../shared/utils.hpp"
+#include "rpm/package_set_impl.hpp"
+
 #include <libdnf5/rpm/package.hpp>
+#include <libdnf5/rpm/package_query.hpp>
 
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 #include <vector>
 
 
@@ -36,6 +43,22 @@ public:
     TestPackage(libdnf5::Base & base, libdnf5::rpm::PackageId id) : libdnf5::rpm::Package(base.get_weak_ptr(), id) {}
 };
 
+// Allows accessing private members
+create_private_getter_template;
+create_getter(p_impl, &libdnf5::rpm::PackageSet::p_impl);
+
+bool is_sparse(const libdnf5::rpm::PackageSet & set) {
+    return (set.*get(p_impl{}))->is_sparse();
+}
+
+std::vector<int> get_ids(const libdnf5::rpm::PackageSet & set) {
+    std::vector<int> ids;
+    for (const auto & pkg : set) {
+        ids.push_back(pkg.get_id().id);
+    }
+    return ids;
+}
+
 }  // namespace
 
 
@@ -213,3 +236,72 @@ void RpmPackageSetTest::test_iterator() {
         CPPUNIT_ASSERT(result == expected);
     }
 }
+
+
+void RpmPackageSetTest::test_sparse_and_dense() {
+    // small sets are sparse
+    CPPUNIT_ASSERT(is_sparse(*set1));
+    CPPUNIT_ASSERT(is_sparse(*set2));
+    CPPUNIT_ASSERT_EQUAL(std::size_t{16}, set1->size());
+
+    // copies keep the representation
+    libdnf5::rpm::PackageSet copy(*set2);
+    CPPUNIT_ASSERT(is_sparse(copy));
+    CPPUNIT_ASSERT_EQUAL((std::vector<int>{8, 24}), get_ids(copy));
+
+    // queries are dense
+    libdnf5::rpm::PackageQuery query(base);
+    CPPUNIT_ASSERT(!is_sparse(query));
+    auto all_ids = get_ids(query);
+
+    // union of a dense set with a sparse set
+    libdnf5::rpm::PackageQuery empty_query(base, libdnf5::sack::ExcludeFlags::APPLY_EXCLUDES, true);
+    empty_query |= *set2;
+    CPPUNIT_ASSERT(!is_sparse(empty_query));
+    CPPUNIT_ASSERT_EQUAL((std::vector<int>{8, 24}), get_ids(empty_query));
+
+    // union of a sparse set with a dense set
+    copy |= query;
+    CPPUNIT_ASSERT(!is_sparse(copy));
+    CPPUNIT_ASSERT_EQUAL(all_ids, get_ids(copy));
+
+    // difference of a dense set and a sparse set
+    copy -= *set1;
+    std::vector<int> expected;
+    std::copy_if(all_ids.begin(), all_ids.end(), std::back_inserter(expected), [](int id) { return id >= 16; });
+    CPPUNIT_ASSERT_EQUAL(expected, get_ids(copy));
+
+    // difference of a sparse set and a dense set
+    libdnf5::rpm::PackageSet set2_copy(*set2);
+    set2_copy -= copy;
+    CPPUNIT_ASSERT(is_sparse(set2_copy));
+    CPPUNIT_ASSERT_EQUAL((std::vector<int>{8}), get_ids(set2_copy));
+
+    // intersection of a dense set with a sparse set stays dense
+    query &= *set2;
+    CPPUNIT_ASSERT(!is_sparse(query));
+    CPPUNIT_ASSERT_EQUAL((std::vector<int>{8, 24}), get_ids(query));
+
+    // intersection of a sparse set with a dense set is sparse
+    libdnf5::rpm::PackageSet set1_copy(*set1);
+    set1_copy &= copy;
+    CPPUNIT_ASSERT(is_sparse(set1_copy));
+    CPPUNIT_ASSERT(set1_copy.empty());
+
+    // a filter reading a sparse set does not convert it, its iterators stay valid
+    auto it = set2->begin();
+    query.filter_name(*set2);
+    CPPUNIT_ASSERT(is_sparse(*set2));
+    CPPUNIT_ASSERT_EQUAL((std::vector<int>{8, 24}), get_ids(query));
+    CPPUNIT_ASSERT_EQUAL(8, (*it).get_id().id);
+    ++it;
+    CPPUNIT_ASSERT_EQUAL(24, (*it).get_id().id);
+    CPPUNIT_ASSERT(++it == set2->end());
+
+    // clearing and removing keep the sparse set sparse
+    set1->remove(TestPackage(base, libdnf5::rpm::PackageId(0)));
+    CPPUNIT_ASSERT_EQUAL(std::size_t{15}, set1->size());
+    set1->clear();
+    CPPUNIT_ASSERT(is_sparse(*set1));
+    CPPUNIT_ASSERT(set1->empty());
+}
@@ -20,20 +20,36 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "test_transaction.hpp"
 
+#include "../shared/private_accessor.hpp"
 #include "../shared/utils.hpp"
+#include "base/base_impl.hpp"
+#include "system/state.hpp"
 
 #include <libdnf5/base/base.hpp>
 #include <libdnf5/base/goal.hpp>
 #include <libdnf5/base/transaction_package.hpp>
 #include <libdnf5/repo/package_downloader.hpp>
+#include <libdnf5/rpm/package_query.hpp>
 #include <libdnf5/rpm/transaction_callbacks.hpp>
+#include <libdnf5/transaction/transaction_history.hpp>
 
 #include <filesystem>
+#include <fstream>
+#include <iterator>
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RpmTransactionTest);
 
 
+namespace {
+
+// Accessor of private Base::p_impl, see private_accessor.hpp
+create_private_getter_template;
+create_getter(priv_impl, &libdnf5::Base::p_impl);
+
+}  // namespace
+
+
 using namespace libdnf5::rpm;
 using namespace libdnf5::transaction;
 
@@ -142,3 +158,143 @@ void RpmTransactionTest::test_transaction_temp_files_cleanup() {
     transaction.run();
     CPPUNIT_ASSERT(!std::filesystem::exists(package_path));
 }
+
+void RpmTransactionTest::test_installed_package_changelogs() {
+    add_repo_rpm("rpm-repo1");
+
+    libdnf5::Goal goal(base);
+    goal.add_rpm_install("one");
+    auto transaction = goal.resolve();
+    transaction.download();
+    transaction.set_callbacks(std::make_unique<libdnf5::rpm::TransactionCallbacks>());
+    CPPUNIT_ASSERT_EQUAL(libdnf5::base::Transaction::TransactionRunResult::SUCCESS, transaction.run());
+
+    // the installed package is loaded into a new Base, its changelogs are not in the pool
+    libdnf5::Base installed_base;
+    installed_base.get_config().get_installroot_option().set(base.get_config().get_installroot_option().get_value());
+    installed_base.get_config().get_cachedir_option().set(base.get_config().get_cachedir_option().get_value());
+    installed_base.setup();
+    installed_base.get_repo_sack()->get_system_repo()->load();
+
+    libdnf5::rpm::PackageQuery query(installed_base);
+    query.filter_installed();
+    query.filter_name({"one"});
+    CPPUNIT_ASSERT_EQUAL(std::size_t{1}, query.size());
+    const auto package = *query.begin();
+
+    // the changelogs are read from the rpmdb, the second call gets the cached result
+    for (int i = 0; i < 2; ++i) {
+        const auto changelogs = package.get_changelogs();
+        CPPUNIT_ASSERT_EQUAL(std::size_t{1}, changelogs.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Joe Black <joe@example.com> - 2-1"), changelogs[0].author);
+        CPPUNIT_ASSERT_EQUAL(std::string("- Second version"), changelogs[0].text);
+    }
+}
+
+void RpmTransactionTest::test_transaction_without_test_run() {
+    add_repo_rpm("rpm-repo1");
+
+    // the ordering, file conflict and disk space checks are done only by the real rpm transaction
+    base.get_config().get_rpm_test_transaction_option().set(false);
+
+    libdnf5::Goal goal(base);
+    goal.add_rpm_install("one");
+    auto transaction = goal.resolve();
+    transaction.download();
+
+    transaction.set_callbacks(std::make_unique<libdnf5::rpm::TransactionCallbacks>());
+    CPPUNIT_ASSERT_EQUAL(libdnf5::base::Transaction::TransactionRunResult::SUCCESS, transaction.run());
+    CPPUNIT_ASSERT(transaction.get_transaction_problems().empty());
+}
+
+void RpmTransactionTest::test_transaction_without_test_run_file_conflict() {
+    add_repo_rpm("rpm-repo-conflicts");
+
+    // the file conflict is found only by the real rpm transaction
+    base.get_config().get_rpm_test_transaction_option().set(false);
+
+    libdnf5::Goal goal(base);
+    goal.add_rpm_install("conflict-a");
+    goal.add_rpm_install("conflict-b");
+    auto transaction = goal.resolve();
+    CPPUNIT_ASSERT_EQUAL((size_t)2, transaction.get_transaction_packages().size());
+    transaction.download();
+
+    transaction.set_callbacks(std::make_unique<libdnf5::rpm::TransactionCallbacks>());
+    CPPUNIT_ASSERT_EQUAL(libdnf5::base::Transaction::TransactionRunResult::ERROR_RPM_RUN, transaction.run());
+    CPPUNIT_ASSERT(!transaction.get_transaction_problems().empty());
+
+    // neither the system state nor the history record the rejected transaction
+    auto & system_state = (base.*get(priv_impl()))->get_system_state();
+    CPPUNIT_ASSERT_EQUAL(std::string(), system_state.get_rpmdb_cookie());
+    CPPUNIT_ASSERT_THROW(
+        system_state.get_package_from_repo("conflict-a-1-1.noarch"), libdnf5::system::StateNotFoundError);
+    CPPUNIT_ASSERT(libdnf5::transaction::TransactionHistory(base).list_transaction_ids().empty());
+}
+
+
+void RpmTransactionTest::test_transaction_timeline() {
+    add_repo_rpm("rpm-repo1");
+
+    const auto timeline_path = temp->get_path() / "timeline" / "transaction.json";
+    base.get_config().get_transaction_timeline_file_option().set(timeline_path);
+
+    libdnf5::Goal goal(base);
+    goal.add_rpm_install("one");
+    auto transaction = goal.resolve();
+    transaction.download();
+
+    // the test of the transaction does not record the timeline
+    CPPUNIT_ASSERT_EQUAL(libdnf5::base::Transaction::TransactionRunResult::SUCCESS, transaction.test());
+    CPPUNIT_ASSERT(!std::filesystem::exists(timeline_path));
+
+    transaction.set_callbacks(std::make_unique<libdnf5::rpm::TransactionCallbacks>());
+    CPPUNIT_ASSERT_EQUAL(libdnf5::base::Transaction::TransactionRunResult::SUCCESS, transaction.run());
+
+    CPPUNIT_ASSERT(std::filesystem::exists(timeline_path));
+    std::ifstream timeline_file(timeline_path);
+    const std::string timeline((std::istreambuf_iterator<char>(timeline_file)), std::istreambuf_iterator<char>());
+
+    CPPUNIT_ASSERT(timeline.starts_with("{\"traceEvents\":["));
+    for (const auto * event : {
+             "\"name\":\"install one-0:2-1.noarch\"",
+             "\"name\":\"rpm transaction\"",
+             "\"name\":\"start history transaction\"",
+             "\"name\":\"finish history transaction\"",
+             "\"name\":\"pre_transaction plugin hooks\"",
+             "\"name\":\"post_transaction plugin hooks\""}) {
+        CPPUNIT_ASSERT_MESSAGE(event, timeline.find(event) != std::string::npos);
+    }
+
+    // the rpm test transaction is recorded as a whole, the rpm phases only for the real run
+    const std::string prepare_event = "\"name\":\"prepare transaction\"";
+    const auto prepare_pos = timeline.find(prepare_event);
+    CPPUNIT_ASSERT(prepare_pos != std::string::npos);
+    CPPUNIT_ASSERT_EQUAL(std::string::npos, timeline.find(prepare_event, prepare_pos + 1));
+    CPPUNIT_ASSERT(timeline.find("\"name\":\"rpm test transaction\"") != std::string::npos);
+}
+
+
+void RpmTransactionTest::install_large_transaction(bool rpm_test_transaction) {
+    add_repo_rpm("rpm-repo-large");
+    base.get_config().get_rpm_test_transaction_option().set(rpm_test_transaction);
+
+    libdnf5::Goal goal(base);
+    goal.add_rpm_install("large-*");
+    auto transaction = goal.resolve();
+    CPPUNIT_ASSERT_EQUAL((size_t)200, transaction.get_transaction_packages().size());
+    transaction.download();
+
+    transaction.set_callbacks(std::make_unique<libdnf5::rpm::TransactionCallbacks>());
+    CPPUNIT_ASSERT_EQUAL(libdnf5::base::Transaction::TransactionRunResult::SUCCESS, transaction.run());
+}
+
+
+void RpmTransactionTest::test_transaction_with_test_run_performance() {
+    install_large_transaction(true);
+}
+
+
+void RpmTransactionTest::test_transaction_without_test_run_performance() {
+    install_large_transaction(false);
+}
@@ -29,13 +29,37 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 class RpmTransactionTest : public BaseTestCase {
     CPPUNIT_TEST_SUITE(RpmTransactionTest);
+
+#ifndef WITH_PERFORMANCE_TESTS
     CPPUNIT_TEST(test_transaction);
     CPPUNIT_TEST(test_transaction_temp_files_cleanup);
+    CPPUNIT_TEST(test_installed_package_changelogs);
+    CPPUNIT_TEST(test_transaction_without_test_run);
+    CPPUNIT_TEST(test_transaction_without_test_run_file_conflict);
+    CPPUNIT_TEST(test_transaction_timeline);
+#endif
+
+#ifdef WITH_PERFORMANCE_TESTS
+    CPPUNIT_TEST(test_transaction_with_test_run_performance);
+    CPPUNIT_TEST(test_transaction_without_test_run_performance);
+#endif
+
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void test_transaction();
     void test_transaction_temp_files_cleanup();
+    void test_installed_package_changelogs();
+    void test_transaction_without_test_run();
+    void test_transaction_without_test_run_file_conflict();
+    void test_transaction_timeline();
+
+    void test_transaction_with_test_run_performance();
+    void test_transaction_without_test_run_performance();
+
+private:
+    // Installs the packages of the large test repository, with or without the rpm test transaction.
+    void install_large_transaction(bool rpm_test_transaction);
 };
 
 #endif
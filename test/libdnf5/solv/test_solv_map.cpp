@@ -20,12 +20,94 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "test_solv_map.hpp"
 
+#include "../shared/private_accessor.hpp"
+#include "utils/on_scope_exit.hpp"
+
 #include <cstdint>
+#include <random>
+#include <vector>
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SolvMapTest);
 
 
+namespace {
+
+// Accessor of private SolvMap::use_generic_kernels, see private_accessor.hpp
+create_private_getter_template;
+create_getter(use_generic_kernels, &libdnf5::solv::SolvMap::use_generic_kernels);
+
+// Creates a map of `size` items with random items set, `reference` gets the same items
+libdnf5::solv::SolvMap random_map(int size, std::mt19937 & generator, std::vector<bool> & reference) {
+    libdnf5::solv::SolvMap map(size);
+    reference.assign(static_cast<std::size_t>(size), false);
+    for (int id = 0; id < size; ++id) {
+        if (generator() % 3 == 0) {
+            map.add(id);
+            reference[static_cast<std::size_t>(id)] = true;
+        }
+    }
+    return map;
+}
+
+bool reference_contains(const std::vector<bool> & reference, int id) {
+    return static_cast<std::size_t>(id) < reference.size() && reference[static_cast<std::size_t>(id)];
+}
+
+// Compares the results of the set operations and counting on random maps with a reference
+void check_set_operations_random() {
+    // the sizes cover the vectorized loops, the word loops and the remaining bytes of the kernels
+    std::mt19937 generator(42);
+    for (int size : {1, 8, 63, 64, 65, 255, 256, 257, 1000, 4099}) {
+        for (int other_size : {size, size / 2 + 1, size * 2 + 3}) {
+            std::vector<bool> reference;
+            std::vector<bool> other_reference;
+            auto map = random_map(size, generator, reference);
+            auto other = random_map(other_size, generator, other_reference);
+
+            std::vector<Id> items;
+            for (auto id : map) {
+                items.push_back(id);
+            }
+            std::vector<Id> expected_items;
+            for (int id = 0; id < size; ++id) {
+                if (reference_contains(reference, id)) {
+                    expected_items.push_back(id);
+                }
+            }
+            CPPUNIT_ASSERT(items == expected_items);
+            CPPUNIT_ASSERT_EQUAL(expected_items.size(), map.size());
+
+            auto map_union = map;
+            map_union |= other;
+            auto map_intersection = map;
+            map_intersection &= other;
+            auto map_difference = map;
+            map_difference -= other;
+
+            std::size_t union_size = 0;
+            std::size_t intersection_size = 0;
+            std::size_t difference_size = 0;
+            for (int id = 0; id < map_union.allocated_size(); ++id) {
+                bool in_map = reference_contains(reference, id);
+                bool in_other = reference_contains(other_reference, id);
+                CPPUNIT_ASSERT_EQUAL(in_map || in_other, map_union.contains(id));
+                CPPUNIT_ASSERT_EQUAL(in_map && in_other, map_intersection.contains(id));
+                CPPUNIT_ASSERT_EQUAL(in_map && !in_other, map_difference.contains(id));
+                union_size += in_map || in_other;
+                intersection_size += in_map && in_other;
+                difference_size += in_map && !in_other;
+            }
+            CPPUNIT_ASSERT_EQUAL(union_size, map_union.size());
+            CPPUNIT_ASSERT_EQUAL(intersection_size, map_intersection.size());
+            CPPUNIT_ASSERT_EQUAL(difference_size, map_difference.size());
+        }
+    }
+}
+
+}  // namespace
+
+
 void SolvMapTest::setUp() {
     map1 = new libdnf5::solv::SolvMap(32);
     map1->add(0);
@@ -249,6 +331,63 @@ void SolvMapTest::test_iterator_sparse() {
 }
 
 
+void SolvMapTest::test_iterator_word_boundaries() {
+    // the items around the boundaries of the bytes and 64-bit words and in the last partial word
+    std::vector<Id> expected = {0, 7, 8, 63, 64, 65, 127, 128, 191, 200, 201};
+
+    libdnf5::solv::SolvMap map(202);
+    for (auto it : expected) {
+        map.add(it);
+    }
+
+    std::vector<Id> result;
+    for (auto package_id : map) {
+        result.push_back(package_id);
+    }
+    CPPUNIT_ASSERT(result == expected);
+
+    // test jump into an empty word
+    auto it = map.begin();
+    it.jump(129);
+    CPPUNIT_ASSERT_EQUAL(*it, 191);
+
+    // test increment from the last item
+    it.jump(201);
+    ++it;
+    CPPUNIT_ASSERT(it == map.end());
+}
+
+
+void SolvMapTest::test_size_empty() {
+    libdnf5::solv::SolvMap map(1000);
+    CPPUNIT_ASSERT(map.empty());
+    CPPUNIT_ASSERT_EQUAL(std::size_t{0}, map.size());
+
+    map.add(999);
+    CPPUNIT_ASSERT(!map.empty());
+    CPPUNIT_ASSERT_EQUAL(std::size_t{1}, map.size());
+
+    map.set_all();
+    CPPUNIT_ASSERT_EQUAL(std::size_t{1000}, map.size());
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t{4}, map1->size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t{2}, map2->size());
+}
+
+
+void SolvMapTest::test_set_operations_random() {
+    check_set_operations_random();
+}
+
+
+void SolvMapTest::test_set_operations_random_generic() {
+    // the portable kernels are not chosen on CPUs with AVX2, they are tested explicitly
+    get(use_generic_kernels{})(true);
+    libdnf5::utils::OnScopeExit restore_kernels([]() noexcept { get(use_generic_kernels{})(false); });
+    check_set_operations_random();
+}
+
+
 void SolvMapTest::test_iterator_performance_empty() {
     // initialize a map filed with zeros
     constexpr int max = 1000000;
@@ -291,3 +430,48 @@ void SolvMapTest::test_iterator_performance_4bits() {
         }
     }
 }
+
+
+void SolvMapTest::test_iterator_performance_sparse() {
+    // initialize a map with every 100th item set
+    constexpr int max = 1000000;
+    libdnf5::solv::SolvMap map(max);
+    for (int i = 0; i < max; i += 100) {
+        map.add(i);
+    }
+
+    for (int i = 0; i < 500; ++i) {
+        std::vector<Id> result;
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            result.push_back(*it);
+        }
+    }
+}
+
+
+void SolvMapTest::test_set_operations_performance() {
+    constexpr int iterations = 1000;
+    std::mt19937 generator(42);
+    std::vector<bool> reference;
+
+    for (int max : {100000, 1000000}) {
+        auto map = random_map(max, generator, reference);
+        auto other = random_map(max, generator, reference);
+        libdnf5::solv::SolvMap result(max);
+
+        auto repeat = [&](auto operation) {
+            for (int i = 0; i < iterations; ++i) {
+                result = map;
+                operation();
+            }
+        };
+
+        std::size_t count = 0;
+        repeat([] {});
+        repeat([&] { result |= other; });
+        repeat([&] { result &= other; });
+        repeat([&] { result -= other; });
+        repeat([&] { count += result.size(); });
+        CPPUNIT_ASSERT(count > 0);
+    }
+}
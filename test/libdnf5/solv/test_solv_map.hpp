@@ -42,12 +42,18 @@ class SolvMapTest : public CppUnit::TestCase {
     CPPUNIT_TEST(test_iterator_empty);
     CPPUNIT_TEST(test_iterator_full);
     CPPUNIT_TEST(test_iterator_sparse);
+    CPPUNIT_TEST(test_iterator_word_boundaries);
+    CPPUNIT_TEST(test_size_empty);
+    CPPUNIT_TEST(test_set_operations_random);
+    CPPUNIT_TEST(test_set_operations_random_generic);
 #endif
 
 #ifdef WITH_PERFORMANCE_TESTS
     CPPUNIT_TEST(test_iterator_performance_empty);
     CPPUNIT_TEST(test_iterator_performance_full);
     CPPUNIT_TEST(test_iterator_performance_4bits);
+    CPPUNIT_TEST(test_iterator_performance_sparse);
+    CPPUNIT_TEST(test_set_operations_performance);
 #endif
 
     CPPUNIT_TEST_SUITE_END();
@@ -69,10 +75,17 @@ public:
     void test_iterator_empty();
     void test_iterator_full();
     void test_iterator_sparse();
+    void test_iterator_word_boundaries();
+
+    void test_size_empty();
+    void test_set_operations_random();
+    void test_set_operations_random_generic();
 
     void test_iterator_performance_empty();
     void test_iterator_performance_full();
     void test_iterator_performance_4bits();
+    void test_iterator_performance_sparse();
+    void test_set_operations_performance();
 
 private:
     libdnf5::solv::SolvMap * map1;
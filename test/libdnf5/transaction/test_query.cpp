@@ -21,10 +21,15 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include "test_query.hpp"
 
 #include "../shared/private_accessor.hpp"
+#include "../shared/utils.hpp"
+#include "utils/sqlite3/sqlite3.hpp"
 
+#include <libdnf5/transaction/rpm_package.hpp>
 #include <libdnf5/transaction/transaction.hpp>
+#include <libdnf5/transaction/transaction_history.hpp>
 
 #include <string>
+#include <vector>
 
 
 using namespace libdnf5::transaction;
@@ -39,6 +44,54 @@ create_private_getter_template;
 create_getter(start, &libdnf5::transaction::Transaction::start);
 create_getter(finish, &libdnf5::transaction::Transaction::finish);
 create_getter(new_transaction, &libdnf5::transaction::TransactionHistory::new_transaction);
+create_getter(new_package, &libdnf5::transaction::Transaction::new_package);
+create_getter(set_dt_start, &libdnf5::transaction::Transaction::set_dt_start);
+create_getter(set_user_id, &libdnf5::transaction::Transaction::set_user_id);
+
+create_getter(set_name, &libdnf5::transaction::Package::set_name);
+create_getter(set_epoch, &libdnf5::transaction::Package::set_epoch);
+create_getter(set_version, &libdnf5::transaction::Package::set_version);
+create_getter(set_release, &libdnf5::transaction::Package::set_release);
+create_getter(set_arch, &libdnf5::transaction::Package::set_arch);
+create_getter(set_repoid, &libdnf5::transaction::Package::set_repoid);
+create_getter(set_action, &libdnf5::transaction::Package::set_action);
+create_getter(set_reason, &libdnf5::transaction::Package::set_reason);
+create_getter(set_state, &libdnf5::transaction::Package::set_state);
+
+// Saves a transaction with packages of the `package_names` to the history database
+int64_t save_transaction(
+    libdnf5::Base & base,
+    int64_t dt_begin,
+    uint32_t user_id,
+    TransactionState state,
+    const std::vector<std::string> & package_names) {
+    auto trans = (*(base.get_transaction_history()).*get(new_transaction{}))();
+    (trans.*get(set_dt_start{}))(dt_begin);
+    (trans.*get(set_user_id{}))(user_id);
+    for (const auto & name : package_names) {
+        auto & pkg = (trans.*get(new_package{}))();
+        (pkg.*get(set_name{}))(name);
+        (pkg.*get(set_epoch{}))("0");
+        (pkg.*get(set_version{}))("1");
+        (pkg.*get(set_release{}))(std::to_string(dt_begin));
+        (pkg.*get(set_arch{}))("x86_64");
+        (pkg.*get(set_repoid{}))("repoid");
+        (pkg.*get(set_action{}))(TransactionItemAction::INSTALL);
+        (pkg.*get(set_reason{}))(TransactionItemReason::USER);
+        (pkg.*get(set_state{}))(TransactionItemState::OK);
+    }
+    (trans.*get(start{}))();
+    (trans.*get(finish{}))(state);
+    return trans.get_id();
+}
+
+std::vector<int64_t> get_ids(const std::vector<Transaction> & transactions) {
+    std::vector<int64_t> ids;
+    for (const auto & trans : transactions) {
+        ids.push_back(trans.get_id());
+    }
+    return ids;
+}
 
 }  //namespace
 
@@ -59,3 +112,130 @@ void TransactionQueryTest::test_filter_id_eq() {
     auto ts_list = base2->get_transaction_history()->list_transactions({trans.get_id()});
     CPPUNIT_ASSERT_EQUAL((size_t)1, ts_list.size());
 }
+
+
+void TransactionQueryTest::test_filter_package_names() {
+    auto base = new_base();
+    auto id1 = save_transaction(*base, 100, 0, TransactionState::OK, {"foo", "bar"});
+    auto id2 = save_transaction(*base, 200, 0, TransactionState::OK, {"bar"});
+    auto id3 = save_transaction(*base, 300, 0, TransactionState::OK, {"baz"});
+
+    auto base2 = new_base();
+    auto & history = *base2->get_transaction_history();
+
+    TransactionListFilter filter;
+    filter.set_package_names({"bar"});
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id1, id2}), get_ids(history.list_transactions(filter)));
+
+    filter.set_package_names({"foo", "baz"});
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id1, id3}), get_ids(history.list_transactions(filter)));
+
+    filter.set_package_names({"not-in-history"});
+    CPPUNIT_ASSERT(history.list_transactions(filter).empty());
+
+    // the packages of the listed transactions are loaded on demand
+    filter.set_package_names({"baz"});
+    auto transactions = history.list_transactions(filter);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, transactions.size());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, transactions[0].get_packages().size());
+    CPPUNIT_ASSERT_EQUAL(std::string("baz"), transactions[0].get_packages()[0].get_name());
+}
+
+
+void TransactionQueryTest::test_filter_dt_begin_user_state() {
+    auto base = new_base();
+    auto id1 = save_transaction(*base, 100, 0, TransactionState::OK, {"foo"});
+    auto id2 = save_transaction(*base, 200, 1000, TransactionState::ERROR, {"foo"});
+    auto id3 = save_transaction(*base, 300, 1000, TransactionState::OK, {"foo"});
+
+    auto base2 = new_base();
+    auto & history = *base2->get_transaction_history();
+
+    TransactionListFilter filter;
+    filter.set_dt_begin_from(200);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id2, id3}), get_ids(history.list_transactions(filter)));
+
+    filter.set_dt_begin_to(200);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id2}), get_ids(history.list_transactions(filter)));
+
+    filter = TransactionListFilter();
+    filter.set_user_ids({0});
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id1}), get_ids(history.list_transactions(filter)));
+
+    filter = TransactionListFilter();
+    filter.set_states({TransactionState::OK});
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id1, id3}), get_ids(history.list_transactions(filter)));
+
+    // the filters are combined
+    filter.set_user_ids({1000});
+    filter.set_package_names({"foo"});
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id3}), get_ids(history.list_transactions(filter)));
+}
+
+
+void TransactionQueryTest::test_pagination() {
+    auto base = new_base();
+    std::vector<int64_t> ids;
+    for (int64_t i = 1; i <= 5; ++i) {
+        ids.push_back(save_transaction(*base, i * 100, 0, TransactionState::OK, {"foo"}));
+    }
+
+    auto base2 = new_base();
+    auto & history = *base2->get_transaction_history();
+
+    // ascending pages of two transactions
+    TransactionListFilter filter;
+    filter.set_limit(2);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{ids[0], ids[1]}), get_ids(history.list_transactions(filter)));
+    filter.set_after_id(ids[1]);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{ids[2], ids[3]}), get_ids(history.list_transactions(filter)));
+    filter.set_after_id(ids[3]);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{ids[4]}), get_ids(history.list_transactions(filter)));
+    filter.set_after_id(ids[4]);
+    CPPUNIT_ASSERT(history.list_transactions(filter).empty());
+
+    // descending pages of two transactions
+    filter = TransactionListFilter();
+    filter.set_limit(2);
+    filter.set_descending(true);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{ids[4], ids[3]}), get_ids(history.list_transactions(filter)));
+    filter.set_after_id(ids[3]);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{ids[2], ids[1]}), get_ids(history.list_transactions(filter)));
+    filter.set_after_id(ids[1]);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{ids[0]}), get_ids(history.list_transactions(filter)));
+}
+
+
+void TransactionQueryTest::test_migrate_schema() {
+    auto base = new_base();
+    auto id = save_transaction(*base, 100, 0, TransactionState::OK, {"foo"});
+
+    // turn the database back to the schema version 1.1, which had no indexes of the trans table
+    auto db_path = temp_dir->get_path() / "transaction_history.sqlite";
+    {
+        libdnf5::utils::SQLite3 conn(db_path.native());
+        conn.exec(R"**(
+            DROP INDEX "trans_dt_begin";
+            DROP INDEX "trans_user_id";
+            DROP INDEX "trans_state_id";
+            UPDATE "config" SET "value" = '1.1' WHERE "key" = 'version';
+        )**");
+    }
+
+    // connecting to the database migrates it
+    auto base2 = new_base();
+    TransactionListFilter filter;
+    filter.set_dt_begin_from(100);
+    auto transactions = base2->get_transaction_history()->list_transactions(filter);
+    CPPUNIT_ASSERT_EQUAL((std::vector<int64_t>{id}), get_ids(transactions));
+
+    libdnf5::utils::SQLite3 conn(db_path.native());
+    libdnf5::utils::SQLite3::Query version_query(conn, R"**(SELECT "value" FROM "config" WHERE "key" = 'version')**");
+    CPPUNIT_ASSERT(version_query.step() == libdnf5::utils::SQLite3::Statement::StepResult::ROW);
+    CPPUNIT_ASSERT_EQUAL(std::string("1.2"), version_query.get<std::string>("value"));
+
+    libdnf5::utils::SQLite3::Query index_query(
+        conn, R"**(SELECT COUNT(*) AS "count" FROM "sqlite_master" WHERE "type" = 'index' AND "tbl_name" = 'trans')**");
+    CPPUNIT_ASSERT(index_query.step() == libdnf5::utils::SQLite3::Statement::StepResult::ROW);
+    CPPUNIT_ASSERT_EQUAL(3, index_query.get<int>("count"));
+}
@@ -31,10 +31,18 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 class TransactionQueryTest : public TransactionTestBase {
     CPPUNIT_TEST_SUITE(TransactionQueryTest);
     CPPUNIT_TEST(test_filter_id_eq);
+    CPPUNIT_TEST(test_filter_package_names);
+    CPPUNIT_TEST(test_filter_dt_begin_user_state);
+    CPPUNIT_TEST(test_pagination);
+    CPPUNIT_TEST(test_migrate_schema);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void test_filter_id_eq();
+    void test_filter_package_names();
+    void test_filter_dt_begin_user_state();
+    void test_pagination();
+    void test_migrate_schema();
 };
 
 
@@ -26,7 +26,9 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 #include <libdnf5/transaction/rpm_package.hpp>
 #include <libdnf5/transaction/transaction.hpp>
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 
 using namespace libdnf5::transaction;
@@ -52,6 +54,24 @@ create_getter(set_repoid, &libdnf5::transaction::Package::set_repoid);
 create_getter(set_action, &libdnf5::transaction::Package::set_action);
 create_getter(set_reason, &libdnf5::transaction::Package::set_reason);
 create_getter(set_state, &libdnf5::transaction::Package::set_state);
+create_getter(get_item_id, &libdnf5::transaction::Package::get_item_id);
+
+// Fills the transaction with packages, the names, architectures and repos are shared by multiple packages
+void fill_packages(libdnf5::transaction::Transaction & trans, std::size_t num, const std::string & release) {
+    const std::vector<std::string> arches{"x86_64", "noarch", "i686"};
+    for (std::size_t i = 0; i < num; i++) {
+        auto & pkg = (trans.*get(new_package{}))();
+        (pkg.*get(set_name{}))("name_" + std::to_string(i / 2));
+        (pkg.*get(set_epoch{}))("0");
+        (pkg.*get(set_version{}))("1");
+        (pkg.*get(set_release{}))(release);
+        (pkg.*get(set_arch{}))(arches[i % arches.size()]);
+        (pkg.*get(set_repoid{}))("repoid_" + std::to_string(i % 4));
+        (pkg.*get(set_action{}))(TransactionItemAction::UPGRADE);
+        (pkg.*get(set_reason{}))(TransactionItemReason::DEPENDENCY);
+        (pkg.*get(set_state{}))(TransactionItemState::OK);
+    }
+}
 
 }  //namespace
 
@@ -110,3 +130,66 @@ void TransactionRpmPackageTest::test_save_load() {
         pkg2_num++;
     }
 }
+
+
+void TransactionRpmPackageTest::test_save_load_shared_dictionaries() {
+    constexpr std::size_t num = 50;
+
+    auto base = new_base();
+
+    // the second transaction refers to the names, architectures, repos and packages stored by the first one
+    auto trans1 = (*(base->get_transaction_history()).*get(new_transaction{}))();
+    fill_packages(trans1, num, "1");
+    (trans1.*get(start{}))();
+    (trans1.*get(finish{}))(TransactionState::OK);
+
+    auto trans2 = (*(base->get_transaction_history()).*get(new_transaction{}))();
+    fill_packages(trans2, num, "1");
+    fill_packages(trans2, num, "2");
+    (trans2.*get(start{}))();
+    (trans2.*get(finish{}))(TransactionState::OK);
+
+    // the same NEVRA is stored as the same item
+    for (std::size_t i = 0; i < num; i++) {
+        auto item_id = (trans1.get_packages()[i].*get(get_item_id{}))();
+        CPPUNIT_ASSERT_EQUAL(item_id, (trans2.get_packages()[i].*get(get_item_id{}))());
+        CPPUNIT_ASSERT(item_id != (trans2.get_packages()[num + i].*get(get_item_id{}))());
+    }
+
+    // create a new Base to force reading the transaction from disk
+    auto base2 = new_base();
+    auto ts_list = base2->get_transaction_history()->list_transactions({trans2.get_id()});
+    CPPUNIT_ASSERT_EQUAL((size_t)1, ts_list.size());
+
+    auto & packages = ts_list[0].get_packages();
+    CPPUNIT_ASSERT_EQUAL(2 * num, packages.size());
+    for (const auto & expected : trans2.get_packages()) {
+        auto it = std::find_if(packages.begin(), packages.end(), [&expected](const auto & pkg) {
+            return (pkg.*get(get_item_id{}))() == (expected.*get(get_item_id{}))();
+        });
+        CPPUNIT_ASSERT(it != packages.end());
+        CPPUNIT_ASSERT_EQUAL(expected.get_name(), it->get_name());
+        CPPUNIT_ASSERT_EQUAL(expected.get_release(), it->get_release());
+        CPPUNIT_ASSERT_EQUAL(expected.get_arch(), it->get_arch());
+        CPPUNIT_ASSERT_EQUAL(expected.get_repoid(), it->get_repoid());
+        CPPUNIT_ASSERT_EQUAL(TransactionItemAction::UPGRADE, it->get_action());
+        CPPUNIT_ASSERT_EQUAL(TransactionItemReason::DEPENDENCY, it->get_reason());
+    }
+}
+
+
+void TransactionRpmPackageTest::test_save_performance() {
+    // a distro-sync sized transaction, each upgraded package has an inbound and an outbound item
+    constexpr std::size_t num = 4000;
+
+    auto base = new_base();
+
+    for (const auto & release : {"1", "2"}) {
+        auto trans = (*(base->get_transaction_history()).*get(new_transaction{}))();
+        fill_packages(trans, num, release);
+
+        (trans.*get(start{}))();
+        (trans.*get(finish{}))(TransactionState::OK);
+        CPPUNIT_ASSERT(trans.get_id() > 0);
+    }
+}
@@ -30,11 +30,23 @@ along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
 
 class TransactionRpmPackageTest : public TransactionTestBase {
     CPPUNIT_TEST_SUITE(TransactionRpmPackageTest);
+
+#ifndef WITH_PERFORMANCE_TESTS
     CPPUNIT_TEST(test_save_load);
+    CPPUNIT_TEST(test_save_load_shared_dictionaries);
+#endif
+
+#ifdef WITH_PERFORMANCE_TESTS
+    CPPUNIT_TEST(test_save_performance);
+#endif
+
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void test_save_load();
+    void test_save_load_shared_dictionaries();
+
+    void test_save_performance();
 };
 
 
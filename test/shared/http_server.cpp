@@ -0,0 +1,179 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "http_server.hpp"
+
+#include "utils/string.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace {
+
+bool send_all(int fd, const std::string & data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        auto len = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (len <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(len);
+    }
+    return true;
+}
+
+}  // namespace
+
+
+HttpServer::HttpServer(const std::filesystem::path & root) : root(root) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Cannot create the socket of the HTTP server");
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 16) != 0 ||
+        getsockname(listen_fd, reinterpret_cast<sockaddr *>(&addr), &addr_len) != 0) {
+        close(listen_fd);
+        throw std::runtime_error("Cannot start the HTTP server");
+    }
+    port = ntohs(addr.sin_port);
+
+    thread = std::thread(&HttpServer::serve, this);
+}
+
+
+HttpServer::~HttpServer() {
+    stopping = true;
+    // wakes up the blocking accept()
+    shutdown(listen_fd, SHUT_RDWR);
+    thread.join();
+    close(listen_fd);
+}
+
+
+std::string HttpServer::get_url() const {
+    return "http://127.0.0.1:" + std::to_string(port) + "/";
+}
+
+
+std::vector<HttpServer::Request> HttpServer::get_requests() const {
+    std::lock_guard<std::mutex> lock(requests_mutex);
+    return requests;
+}
+
+
+void HttpServer::serve() {
+    while (!stopping) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        handle_connection(fd);
+        close(fd);
+    }
+}
+
+
+void HttpServer::handle_connection(int fd) {
+    // reads the request line and headers, the requests of the clients have no body
+    std::string data;
+    char buffer[4096];
+    while (data.find("\r\n\r\n") == std::string::npos) {
+        auto len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len <= 0) {
+            return;
+        }
+        data.append(buffer, static_cast<std::size_t>(len));
+    }
+
+    std::istringstream stream(data);
+    std::string method;
+    std::string target;
+    stream >> method >> target;
+
+    std::map<std::string, std::string> headers;
+    std::string line;
+    std::getline(stream, line);
+    while (std::getline(stream, line) && line != "\r") {
+        auto colon = line.find(':');
+        if (colon != std::string::npos) {
+            auto value = line.substr(colon + 1);
+            libdnf5::utils::string::trim(value);
+            headers[libdnf5::utils::string::tolower(line.substr(0, colon))] = value;
+        }
+    }
+
+    auto path = target.substr(0, target.find('?'));
+    Request request{path, headers.contains("if-none-match") || headers.contains("if-modified-since"), 404};
+
+    std::string content;
+    bool found = false;
+    if (path.find("..") == std::string::npos) {
+        std::ifstream file(root / std::filesystem::path(path).relative_path(), std::ios::binary);
+        if (file) {
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            found = true;
+        }
+    }
+
+    std::string response;
+    if (!found) {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else {
+        auto etag = "\"" + std::to_string(std::hash<std::string>{}(content)) + "\"";
+        auto if_none_match = headers.find("if-none-match");
+        auto if_modified_since = headers.find("if-modified-since");
+        bool not_modified = if_none_match != headers.end()
+                                ? if_none_match->second == etag
+                                : if_modified_since != headers.end() && if_modified_since->second == LAST_MODIFIED;
+
+        request.status = not_modified ? 304 : 200;
+        response = not_modified ? "HTTP/1.1 304 Not Modified\r\n" : "HTTP/1.1 200 OK\r\n";
+        response += "ETag: " + etag + "\r\n";
+        response += std::string("Last-Modified: ") + LAST_MODIFIED + "\r\n";
+        response += "Connection: close\r\n";
+        if (not_modified || method == "HEAD") {
+            response += "\r\n";
+        } else {
+            response += "Content-Length: " + std::to_string(content.size()) + "\r\n\r\n" + content;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(requests_mutex);
+        requests.push_back(std::move(request));
+    }
+
+    send_all(fd, response);
+}
@@ -0,0 +1,72 @@
+/*
+Copyright Contributors to the libdnf project.
+
+This file is part of libdnf: https://github.com/rpm-software-management/libdnf/
+
+Libdnf is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+Libdnf is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with libdnf.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TEST_LIBDNF5_HTTP_SERVER_HPP
+#define TEST_LIBDNF5_HTTP_SERVER_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/// Minimal HTTP server serving files of a directory on a loopback port, used for tests of remote repositories.
+/// Every response carries the ETag and Last-Modified validators, conditional requests with matching
+/// validators are answered with "304 Not Modified".
+class HttpServer {
+public:
+    struct Request {
+        std::string path;
+        bool conditional;
+        int status;
+    };
+
+    explicit HttpServer(const std::filesystem::path & root);
+    ~HttpServer();
+
+    HttpServer(const HttpServer &) = delete;
+    HttpServer & operator=(const HttpServer &) = delete;
+
+    /// @return The base URL of the server, ending with a slash.
+    std::string get_url() const;
+
+    /// @return The requests handled so far.
+    std::vector<Request> get_requests() const;
+
+    static constexpr const char * LAST_MODIFIED = "Mon, 01 Jan 2024 00:00:00 GMT";
+
+private:
+    void serve();
+    void handle_connection(int fd);
+
+    std::filesystem::path root;
+    int listen_fd{-1};
+    int port{0};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    mutable std::mutex requests_mutex;
+    std::vector<Request> requests;
+};
+
+
+#endif  // TEST_LIBDNF5_HTTP_SERVER_HPP